@@ -78,4 +78,33 @@ namespace Jani
         Max    = _50, 
         Count  = 7
     };
+
+    enum class QueryComparisonOperator
+    {
+        Equal, 
+        NotEqual, 
+        Less, 
+        LessEqual, 
+        Greater, 
+        GreaterEqual
+    };
+
+    enum class WorldGridLayout
+    {
+        RowMajor, // Buckets (and cells inside them) are stored line by line
+        Morton    // Buckets (and cells inside them) are stored along a Z-order curve, neighbour cells stay close in memory
+    };
+
+    enum class SpatialPartitioning
+    {
+        Greedy,      // Cells are given away one by one to the least loaded workers that can take them
+        HilbertCurve // Each worker owns a contiguous range of the Hilbert curve, balance moves the range boundaries
+    };
+
+    enum class AggregateQueryType
+    {
+        Count,           // Number of entities inside the area
+        AttributeBounds, // Minimum and maximum value of a component attribute among the entities inside the area
+        CellHistogram    // Number of entities on each world cell that intersects the area
+    };
 }
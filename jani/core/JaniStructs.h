@@ -168,6 +168,118 @@ namespace Jani
         EntityId            entity_owner = InvalidEntityId;
         ComponentId         component_id = InvalidComponentId;
         std::vector<int8_t> component_data;
+        bool                is_partial   = false; // If set the data contains only the projected attributes (see ComponentPartialView)
+    };
+
+    /*
+    * Read access to a partial (projected) component payload
+    * The data of a partial payload is a sequence of segments { uint16_t offset, uint16_t size, int8_t data[size] }, one
+    * for each projected attribute, where offset is the attribute position inside the full component (only meaningful
+    * for POD components, which are transmitted as their raw memory)
+    */
+    class ComponentPartialView
+    {
+    public:
+
+        ComponentPartialView(const ComponentPayload& _component_payload) : m_component_payload(_component_payload)
+        {
+        }
+
+        /*
+        * Call the given function for each segment (offset, size, data)
+        */
+        template <typename Function>
+        void ForEachSegment(Function&& _function) const
+        {
+            auto&  component_data = m_component_payload.component_data;
+            size_t current_index  = 0;
+            while (current_index + sizeof(uint16_t) * 2 <= component_data.size())
+            {
+                uint16_t segment_offset;
+                uint16_t segment_size;
+                std::memcpy(&segment_offset, component_data.data() + current_index, sizeof(uint16_t));
+                std::memcpy(&segment_size, component_data.data() + current_index + sizeof(uint16_t), sizeof(uint16_t));
+                current_index += sizeof(uint16_t) * 2;
+
+                if (current_index + segment_size > component_data.size())
+                {
+                    return;
+                }
+
+                _function(static_cast<uint32_t>(segment_offset), static_cast<uint32_t>(segment_size), component_data.data() + current_index);
+                current_index += segment_size;
+            }
+        }
+
+        /*
+        * Return the value of the attribute located at the given offset inside the full component (use offsetof()),
+        * if it's part of the projection
+        */
+        template <typename ValueType>
+        std::optional<ValueType> Get(uint32_t _attribute_offset) const
+        {
+            std::optional<ValueType> result;
+            ForEachSegment(
+                [&](uint32_t _segment_offset, uint32_t _segment_size, const int8_t* _segment_data)
+                {
+                    if (_segment_offset == _attribute_offset && _segment_size == sizeof(ValueType))
+                    {
+                        ValueType value;
+                        std::memcpy(&value, _segment_data, sizeof(ValueType));
+                        result = value;
+                    }
+                });
+
+            return result;
+        }
+
+        /*
+        * Copy all projected attributes into the given component, leaving the others untouched
+        */
+        template <typename ComponentClass>
+        bool ApplyTo(ComponentClass& _component) const
+        {
+            static_assert(std::is_trivially_copyable<ComponentClass>::value, "Partial payloads can only be applied to POD components");
+
+            bool succeed = true;
+            ForEachSegment(
+                [&](uint32_t _segment_offset, uint32_t _segment_size, const int8_t* _segment_data)
+                {
+                    if (_segment_offset + _segment_size > sizeof(ComponentClass))
+                    {
+                        succeed = false;
+                        return;
+                    }
+
+                    std::memcpy(reinterpret_cast<int8_t*>(&_component) + _segment_offset, _segment_data, _segment_size);
+                });
+
+            return succeed;
+        }
+
+    private:
+
+        const ComponentPayload& m_component_payload;
+    };
+
+    /*
+    * A list of component payloads that were already encoded, it serializes exactly like a
+    * std::vector<ComponentPayload> so the receiving side can load it as one
+    * The encoded buffers are referenced, they must outlive the serialization
+    */
+    struct EncodedComponentPayloads
+    {
+        template <class Archive>
+        void save(Archive& ar) const
+        {
+            ar(cereal::make_size_tag(static_cast<cereal::size_type>(encoded_payloads.size())));
+            for (auto& encoded_payload : encoded_payloads)
+            {
+                ar(cereal::binary_data(encoded_payload->data(), encoded_payload->size()));
+            }
+        }
+
+        std::vector<const std::vector<char>*> encoded_payloads;
     };
 
     struct EntityPayload
@@ -571,18 +683,52 @@ namespace Jani
         std::vector<int8_t> payload;
     };
 
+    /*
+    * Compares one attribute of an entity component (as described by the LayerConfig component schema) with
+    * a constant value, the integer value is used for boolean/integer attributes and the real one for floats
+    * Attributes are read from the raw payload, so only POD components are supported
+    */
+    struct ComponentAttributeConstraint
+    {
+        JaniSerializable();
+
+        ComponentId             component_id  = InvalidComponentId;
+        std::string             attribute_name;
+        QueryComparisonOperator comparison    = QueryComparisonOperator::Equal;
+        int64_t                 integer_value = 0;
+        double                  real_value    = 0.0;
+    };
+
+    /*
+    * A segment that begins at the query center and ends at the given offset from it, entities closer than
+    * thickness to the segment are selected
+    * If max_hits is set only the first entities along the segment (ordered by their projection on it) are
+    * selected, this makes the constraint behave like a thick ray cast that stops on the first N hits
+    */
+    struct ComponentSegmentConstraint
+    {
+        JaniSerializable();
+
+        WorldPosition end_offset;
+        uint32_t      thickness = 0;
+        uint32_t      max_hits  = 0; // 0 means all entities along the segment
+    };
+
     struct ComponentQueryInstruction
     {
         JaniSerializable();
 
-        std::optional<ComponentMask> component_constraints;
-        std::optional<WorldArea>     area_constraint;
-        std::optional<WorldRect>     box_constraint;
-        std::optional<uint32_t>      radius_constraint;
+        std::optional<ComponentMask>                component_constraints;
+        std::optional<WorldArea>                    area_constraint;
+        std::optional<WorldRect>                    box_constraint;
+        std::optional<uint32_t>                     radius_constraint;
+        std::optional<ComponentAttributeConstraint> attribute_constraint;
+        std::optional<ComponentSegmentConstraint>   segment_constraint;
 
         // Only one is allowed
         std::optional<std::pair<std::unique_ptr<ComponentQueryInstruction>, std::unique_ptr<ComponentQueryInstruction>>> and_constraint;
         std::optional<std::pair<std::unique_ptr<ComponentQueryInstruction>, std::unique_ptr<ComponentQueryInstruction>>> or_constraint;
+        std::optional<std::unique_ptr<ComponentQueryInstruction>>                                                        not_constraint;
 
         void RequireComponent(ComponentId _component_id)
         {
@@ -610,6 +756,31 @@ namespace Jani
             radius_constraint = _radius;
         }
 
+        void EntitiesOnSegment(WorldPosition _end_offset, uint32_t _thickness, uint32_t _max_hits = 0)
+        {
+            segment_constraint = ComponentSegmentConstraint({ _end_offset, _thickness, _max_hits });
+        }
+
+        /*
+        * Select entities whose component attribute compares true with the given value, the attribute is read
+        * straight from the component memory so this only works with POD components, it never matches attributes
+        * of serializable components or ones declared after a string attribute
+        */
+        template <typename ValueType>
+        void EntitiesWithAttribute(ComponentId _component_id, std::string _attribute_name, QueryComparisonOperator _comparison, ValueType _value)
+        {
+            static_assert(std::is_arithmetic<ValueType>::value, "Attribute constraints only support arithmetic values");
+
+            ComponentAttributeConstraint constraint;
+            constraint.component_id   = _component_id;
+            constraint.attribute_name = std::move(_attribute_name);
+            constraint.comparison     = _comparison;
+            constraint.integer_value  = static_cast<int64_t>(_value);
+            constraint.real_value     = static_cast<double>(_value);
+
+            attribute_constraint = std::move(constraint);
+        }
+
         std::pair<ComponentQueryInstruction*, ComponentQueryInstruction*> And()
         {
             and_constraint = std::pair<std::unique_ptr<ComponentQueryInstruction>, std::unique_ptr<ComponentQueryInstruction>>();
@@ -629,6 +800,36 @@ namespace Jani
 
             return { or_constraint.value().first.get(), or_constraint.value().second.get() };
         }
+
+        ComponentQueryInstruction* Not()
+        {
+            not_constraint = std::make_unique<ComponentQueryInstruction>();
+
+            return not_constraint.value().get();
+        }
+    };
+
+    /*
+    * A distance band inside a component query, entities farther than the previous band and up to max_distance
+    * from the query center are refreshed at the band frequency
+    */
+    struct ComponentQueryDistanceBand
+    {
+        JaniSerializable();
+
+        float                max_distance = 0.0f;
+        QueryUpdateFrequency frequency    = QueryUpdateFrequency::Min;
+    };
+
+    /*
+    * The attributes (from the LayerConfig component schema) that a query wants for a given component
+    */
+    struct ComponentQueryProjection
+    {
+        JaniSerializable();
+
+        ComponentId              component_id = InvalidComponentId;
+        std::vector<std::string> attribute_names;
     };
 
     struct ComponentQuery
@@ -637,6 +838,12 @@ namespace Jani
 
         friend Runtime;
 
+        /*
+        * The last band bit (index equal to the number of bands) is used by entities beyond all bands, which
+        * are refreshed at the query frequency
+        */
+        static const uint32_t MaximumDistanceBands = 8;
+
         ComponentQueryInstruction* Begin()
         {
             root_query = std::make_shared<ComponentQueryInstruction>();
@@ -662,8 +869,115 @@ namespace Jani
             return *this;
         }
 
+        /*
+        * Limit the number of entities returned by each evaluation, only the nearest ones from the query center
+        * are selected, 0 means unlimited
+        */
+        ComponentQuery& WithMaxResults(uint32_t _max_results)
+        {
+            max_results = _max_results;
+            return *this;
+        }
+
+        /*
+        * Only send the given attributes for the component, the receiver gets a partial payload that can be read
+        * with a ComponentPartialView
+        * If any of the attributes doesn't have a fixed offset on the component schema the full component is sent
+        */
+        ComponentQuery& WithProjection(ComponentId _component_id, std::vector<std::string> _attribute_names)
+        {
+            projections.push_back({ _component_id, std::move(_attribute_names) });
+            return *this;
+        }
+
+        ComponentQuery& WithDistanceBand(float _max_distance, QueryUpdateFrequency _frequency)
+        {
+            distance_bands.push_back({ _max_distance, _frequency });
+            std::sort(distance_bands.begin(), distance_bands.end(), 
+                [](const ComponentQueryDistanceBand& _first, const ComponentQueryDistanceBand& _second)
+                {
+                    return _first.max_distance < _second.max_distance;
+                });
+
+            return *this;
+        }
+
+        /*
+        * Return the highest frequency used by this query, considering all distance bands
+        */
+        QueryUpdateFrequency GetHighestFrequency() const
+        {
+            uint32_t highest_frequency = static_cast<uint32_t>(frequency);
+            for (auto& distance_band : distance_bands)
+            {
+                highest_frequency = std::max(highest_frequency, static_cast<uint32_t>(distance_band.frequency));
+            }
+
+            return static_cast<QueryUpdateFrequency>(highest_frequency);
+        }
+
+        /*
+        * Return the band index for an entity at the given distance from the query center
+        */
+        uint32_t GetDistanceBandIndex(float _distance) const
+        {
+            for (uint32_t i = 0; i < distance_bands.size(); i++)
+            {
+                if (_distance <= distance_bands[i].max_distance)
+                {
+                    return i;
+                }
+            }
+
+            return static_cast<uint32_t>(distance_bands.size());
+        }
+
+        /*
+        * Return a mask with one bit per band indicating which ones must be refreshed by an evaluation at
+        * _current_time_ms, given that the previous one happened at _previous_time_ms
+        * A band is due when its period boundary was crossed between both evaluations, if there is no previous
+        * evaluation (max value) all bands are due
+        */
+        uint32_t GetDueDistanceBandsMask(uint64_t _previous_time_ms, uint64_t _current_time_ms) const
+        {
+            auto IsFrequencyDue = [&](QueryUpdateFrequency _frequency) -> bool
+            {
+                uint64_t period = 1000 / std::max(1u, static_cast<uint32_t>(_frequency));
+                return _previous_time_ms == std::numeric_limits<uint64_t>::max() || _current_time_ms / period != _previous_time_ms / period;
+            };
+
+            uint32_t due_mask = 0;
+            for (uint32_t i = 0; i < distance_bands.size(); i++)
+            {
+                if (IsFrequencyDue(distance_bands[i].frequency))
+                {
+                    due_mask |= 1u << i;
+                }
+            }
+
+            if (IsFrequencyDue(frequency))
+            {
+                due_mask |= 1u << static_cast<uint32_t>(distance_bands.size());
+            }
+
+            return due_mask;
+        }
+
         bool IsValid() const
         {
+            if (distance_bands.size() > MaximumDistanceBands)
+            {
+                return false;
+            }
+
+            for (auto& distance_band : distance_bands)
+            {
+                if (distance_band.max_distance < 0.0f)
+                {
+                    return false;
+                }
+            }
+
             std::function<bool(const ComponentQueryInstruction&)> ValidateQueryInstruction = [&](const ComponentQueryInstruction& _query_instruction) -> bool
             {
                 if (_query_instruction.box_constraint && _query_instruction.box_constraint->width >= 0 && _query_instruction.box_constraint->height >= 0)
@@ -682,6 +996,14 @@ namespace Jani
                 {
                     return true;
                 }
+                else if (_query_instruction.segment_constraint)
+                {
+                    return _query_instruction.segment_constraint->thickness < 10000000;
+                }
+                else if (_query_instruction.attribute_constraint)
+                {
+                    return _query_instruction.attribute_constraint->component_id < MaximumEntityComponents && !_query_instruction.attribute_constraint->attribute_name.empty();
+                }
                 else if (_query_instruction.and_constraint && _query_instruction.and_constraint->first && _query_instruction.and_constraint->second)
                 {
                     if (!ValidateQueryInstruction(*_query_instruction.and_constraint->first))
@@ -698,7 +1020,6 @@ namespace Jani
                 }
                 else if (_query_instruction.or_constraint && _query_instruction.or_constraint->first && _query_instruction.or_constraint->second)
                 {
-                    return false; // Not supported for now
                     if (!ValidateQueryInstruction(*_query_instruction.or_constraint->first))
                     {
                         return false;
@@ -711,6 +1032,10 @@ namespace Jani
 
                     return true;
                 }
+                else if (_query_instruction.not_constraint && _query_instruction.not_constraint.value())
+                {
+                    return ValidateQueryInstruction(*_query_instruction.not_constraint.value());
+                }
 
                 return false;
             };
@@ -728,6 +1053,197 @@ namespace Jani
         ComponentMask                              component_mask;
         std::shared_ptr<ComponentQueryInstruction> root_query;
         QueryUpdateFrequency                       frequency = QueryUpdateFrequency::Min;
+        std::vector<ComponentQueryDistanceBand>    distance_bands;
+        uint32_t                                   max_results = 0;
+        std::vector<ComponentQueryProjection>      projections;
+    };
+
+    /*
+    * Interest of a whole worker, described as a union of regions plus component filters
+    * Unlike component queries (which are attached to each entity) it's evaluated once per worker, so a
+    * worker with thousands of entities can express their common interest with a single entry
+    */
+    struct WorkerInterest
+    {
+        JaniSerializable();
+
+        WorkerInterest& QueryComponents(ComponentMask _component_mask)
+        {
+            component_mask = _component_mask;
+            return *this;
+        }
+
+        WorkerInterest& RequireComponents(ComponentMask _component_mask)
+        {
+            required_component_mask = _component_mask;
+            return *this;
+        }
+
+        WorkerInterest& WithOwnedCells(uint32_t _cells_margin = 0)
+        {
+            include_owned_cells = true;
+            owned_cells_margin  = _cells_margin;
+            return *this;
+        }
+
+        WorkerInterest& WithRect(WorldRect _world_rect)
+        {
+            world_rects.push_back(_world_rect);
+            return *this;
+        }
+
+        WorkerInterest& WithFrequency(QueryUpdateFrequency _frequency)
+        {
+            frequency = _frequency;
+            return *this;
+        }
+
+        bool IsValid() const
+        {
+            if (component_mask.none() || (!include_owned_cells && world_rects.size() == 0))
+            {
+                return false;
+            }
+
+            for (auto& world_rect : world_rects)
+            {
+                if (world_rect.width < 0 || world_rect.height < 0)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        ComponentMask          component_mask;                               // The components that will be sent for each selected entity
+        ComponentMask          required_component_mask;                      // Entities must have all these components to be selected
+        std::vector<WorldRect> world_rects;                                  // Explicit world regions
+        bool                   include_owned_cells = false;                  // If the cells owned by the worker (on its layer) are part of the region
+        uint32_t               owned_cells_margin  = 0;                      // How many cells around each owned cell are included
+        QueryUpdateFrequency   frequency           = QueryUpdateFrequency::Min;
+    };
+
+    /*
+    * A query that is reduced on the runtime, only the aggregated values are sent back instead of the entities
+    * The area is either a world rect or a circle, optionally only entities with all the required components
+    * are accounted
+    */
+    struct AggregateQuery
+    {
+        JaniSerializable();
+
+        AggregateQuery& Count()
+        {
+            type = AggregateQueryType::Count;
+            return *this;
+        }
+
+        // Only attributes of POD components can be aggregated, see ComponentQueryInstruction::EntitiesWithAttribute()
+        AggregateQuery& AttributeBounds(ComponentId _component_id, std::string _attribute_name)
+        {
+            type                   = AggregateQueryType::AttributeBounds;
+            attribute_component_id = _component_id;
+            attribute_name         = std::move(_attribute_name);
+            return *this;
+        }
+
+        AggregateQuery& CellHistogram()
+        {
+            type = AggregateQueryType::CellHistogram;
+            return *this;
+        }
+
+        AggregateQuery& OnRect(WorldRect _world_rect)
+        {
+            world_rect = _world_rect;
+            return *this;
+        }
+
+        AggregateQuery& OnRadius(WorldPosition _center, uint32_t _radius)
+        {
+            center = _center;
+            radius = _radius;
+            return *this;
+        }
+
+        AggregateQuery& RequireComponents(ComponentMask _component_mask)
+        {
+            required_component_mask = _component_mask;
+            return *this;
+        }
+
+        bool IsValid() const
+        {
+            if (world_rect.has_value() == center.has_value())
+            {
+                return false;
+            }
+
+            if (world_rect && (world_rect->width < 0 || world_rect->height < 0))
+            {
+                return false;
+            }
+
+            if (type == AggregateQueryType::AttributeBounds && (attribute_component_id >= MaximumEntityComponents || attribute_name.empty()))
+            {
+                return false;
+            }
+
+            return true;
+        }
+
+        AggregateQueryType           type                   = AggregateQueryType::Count;
+        std::optional<WorldRect>     world_rect;
+        std::optional<WorldPosition> center;
+        uint32_t                     radius                 = 0;
+        ComponentMask                required_component_mask;
+        ComponentId                  attribute_component_id = InvalidComponentId; // Only used by AttributeBounds
+        std::string                  attribute_name;                              // Only used by AttributeBounds
+    };
+
+    struct AggregateCellCount
+    {
+        JaniSerializable();
+
+        WorldCellCoordinates cell_coordinates;
+        uint32_t             entity_count = 0;
+    };
+
+    struct AggregateQueryResult
+    {
+        /*
+        * Histograms bigger than this are truncated so the response always fits a single message
+        */
+        static const uint32_t MaximumHistogramCells = 128;
+
+        JaniSerializable();
+
+        uint32_t                        entity_count  = 0;     // Entities accounted (for AttributeBounds, the ones that have the attribute)
+        double                          minimum_value = 0.0;
+        double                          maximum_value = 0.0;
+        std::vector<AggregateCellCount> cell_histogram;
+        bool                            is_truncated  = false; // If the histogram didn't fit MaximumHistogramCells
+    };
+
+    /*
+    * Identifies a single interest query: the entity that registered it, the component it was registered
+    * for and its index on that component query list
+    * Worker interests use InvalidEntityId and InvalidComponentId, with the index of the interest on the
+    * worker interest list
+    */
+    struct ComponentQuerySource
+    {
+        JaniSerializable();
+
+        bool operator==(const ComponentQuerySource& _other) const
+        {
+            return entity_id == _other.entity_id && component_id == _other.component_id && query_index == _other.query_index;
+        }
+
+        EntityId    entity_id    = InvalidEntityId;
+        ComponentId component_id = InvalidComponentId;
+        uint32_t    query_index  = 0;
     };
 
     struct ComponentQueryResultPayload
@@ -882,6 +1398,31 @@ namespace Jani
             std::vector<ComponentQuery> queries;
         };
 
+        // RuntimeWorkerInterestUpdate
+        struct RuntimeWorkerInterestUpdateRequest
+        {
+            JaniSerializable();
+
+            std::vector<WorkerInterest> interests;
+        };
+
+        // RuntimeAggregateQuery
+        struct RuntimeAggregateQueryRequest
+        {
+            JaniSerializable();
+
+            AggregateQuery query;
+        };
+
+        // RuntimeAggregateQuery
+        struct RuntimeAggregateQueryResponse
+        {
+            JaniSerializable();
+
+            bool                 succeed = false;
+            AggregateQueryResult result;
+        };
+
         // RuntimeComponentInterestQuery
         struct RuntimeComponentInterestQueryRequest
         {
@@ -896,9 +1437,21 @@ namespace Jani
         {
             JaniSerializable();
 
-            bool                          succeed = false;
-            ComponentMask                 entity_component_mask;
-            std::vector<ComponentPayload> components_payloads;
+            bool                              succeed = false;
+            ComponentMask                     entity_component_mask;
+            std::vector<ComponentPayload>     components_payloads;
+            std::vector<ComponentQuerySource> query_sources;
+        };
+
+        // RuntimeComponentInterestQuery (sent by the runtime with pre-encoded payloads, wire compatible with the response above)
+        struct RuntimeComponentInterestQueryEncodedResponse
+        {
+            JaniSerializable();
+
+            bool                              succeed = false;
+            ComponentMask                     entity_component_mask;
+            EncodedComponentPayloads          components_payloads;
+            std::vector<ComponentQuerySource> query_sources;
         };
 
         // RuntimeInspectorQuery
@@ -939,6 +1492,13 @@ namespace Jani
 
             uint64_t total_data_sent_per_second = 0;
             uint64_t total_data_received_per_second = 0;
+
+            // Frame time measured between worker updates since the last report
+            uint32_t average_frame_time_us = 0;
+            uint32_t maximum_frame_time_us = 0;
+
+            // Fraction of a single core used by the worker process since the last report
+            float    cpu_usage             = 0.0f;
         };
 
         struct RuntimeDefaultResponse
@@ -948,6 +1508,51 @@ namespace Jani
             bool succeed = false;
         };
 
+        // RuntimeLayerAuthorityHandoffAcknowledge
+        struct RuntimeLayerAuthorityHandoffAcknowledgeRequest
+        {
+            JaniSerializable();
+
+            std::vector<EntityId> entity_ids;
+        };
+
+        // WorkerLayerAuthorityGainImminent
+        struct WorkerLayerAuthorityGainImminentRequest
+        {
+            JaniSerializable();
+
+            EntityId entity_id        = std::numeric_limits<EntityId>::max();
+            uint32_t total_components = 0; // Number of WorkerAddComponent messages that follow with the entity state
+        };
+
+        // WorkerLayerAuthorityLostImminent
+        struct WorkerLayerAuthorityLostImminentRequest
+        {
+            JaniSerializable();
+
+            EntityId entity_id = std::numeric_limits<EntityId>::max();
+        };
+
+        // WorkerLayerCellMigration
+        struct WorkerLayerCellMigrationRequest
+        {
+            JaniSerializable();
+
+            // One of the WorkerLayerAuthority* request types, applied to every entity on this message
+            RequestType              authority_change = RequestType::Unknown;
+            std::vector<EntityId>    entity_ids;
+
+            // Layer components of each entity (same order as the entity ids), only filled when the receiver needs
+            // the entity state, the payloads of all components are encoded back to back on component_data
+            // Components of an entity that don't fit on the message follow as WorkerAddComponent requests, so
+            // the total components of an entity can be higher than the ones encoded here
+            std::vector<uint8_t>     entity_total_components;
+            std::vector<uint8_t>     entity_encoded_components;
+            std::vector<ComponentId> component_ids;
+            std::vector<uint16_t>    component_data_sizes;
+            std::vector<int8_t>      component_data;
+        };
+
         // WorkerLayerAuthorityGain
         struct WorkerLayerAuthorityGainRequest
         {
@@ -974,6 +1579,22 @@ namespace Jani
             ComponentPayload component_payload;
         };
 
+        // WorkerAddComponent, sending side that encodes the payload by reference instead of copying it into the
+        // request, it must serialize exactly like WorkerAddComponentRequest
+        struct WorkerAddComponentRequestRef
+        {
+            template <class Archive>
+            void serialize(Archive& ar)
+            {
+                assert(component_payload);
+                ar(entity_id, component_id, *component_payload);
+            }
+
+            EntityId                entity_id         = std::numeric_limits<EntityId>::max();
+            ComponentId             component_id      = std::numeric_limits<ComponentId>::max();
+            const ComponentPayload* component_payload = nullptr;
+        };
+
         // WorkerRemoveComponent
         struct WorkerRemoveComponentRequest
         {
@@ -1049,13 +1670,194 @@ namespace Jani
 
     };
 
+    /*
+    * Compact set of cell coordinates, cells are grouped into BlockDimSize x BlockDimSize blocks and each block
+    * is stored as a single 64 bit mask on a vector sorted by the block key, iteration follows the block order
+    */
+    class WorldCellBitmap
+    {
+        static const int32_t BlockDimShift = 3;
+        static const int32_t BlockDimSize  = 1 << BlockDimShift;
+
+        static_assert((BlockDimSize & (BlockDimSize - 1)) == 0, "The block dimension must be a power of 2");
+        static_assert(BlockDimSize * BlockDimSize <= 64, "A block must fit a 64 bit cell mask");
+
+        using Block = std::pair<uint64_t, uint64_t>; // Block key, cell mask
+
+    public:
+
+        class Iterator
+        {
+            friend WorldCellBitmap;
+
+        public:
+
+            using iterator_category = std::forward_iterator_tag;
+            using value_type        = WorldCellCoordinates;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const WorldCellCoordinates*;
+            using reference         = WorldCellCoordinates;
+
+            WorldCellCoordinates operator*() const
+            {
+                WorldCellCoordinates cell_coordinates;
+                cell_coordinates.x = static_cast<int32_t>(static_cast<uint32_t>(m_block->first >> 32)) * BlockDimSize + static_cast<int32_t>(m_bit_index / BlockDimSize);
+                cell_coordinates.y = static_cast<int32_t>(static_cast<uint32_t>(m_block->first))       * BlockDimSize + static_cast<int32_t>(m_bit_index % BlockDimSize);
+
+                return cell_coordinates;
+            }
+
+            Iterator& operator++()
+            {
+                m_bit_index++;
+                SkipUnsetBits();
+
+                return *this;
+            }
+
+            bool operator==(const Iterator& _other) const { return m_block == _other.m_block && m_bit_index == _other.m_bit_index; }
+            bool operator!=(const Iterator& _other) const { return !(*this == _other); }
+
+        private:
+
+            Iterator(std::vector<Block>::const_iterator _block, std::vector<Block>::const_iterator _end) : m_block(_block), m_end(_end)
+            {
+                SkipUnsetBits();
+            }
+
+            // Blocks are never empty, so this always stops on a set bit or at the end
+            void SkipUnsetBits()
+            {
+                while (m_block != m_end)
+                {
+                    uint64_t remaining_mask = m_bit_index < 64 ? m_block->second >> m_bit_index : 0;
+                    if (remaining_mask != 0)
+                    {
+                        while (!(remaining_mask & 1))
+                        {
+                            remaining_mask >>= 1;
+                            m_bit_index++;
+                        }
+
+                        return;
+                    }
+
+                    ++m_block;
+                    m_bit_index = 0;
+                }
+            }
+
+            std::vector<Block>::const_iterator m_block;
+            std::vector<Block>::const_iterator m_end;
+            uint32_t                           m_bit_index = 0;
+        };
+
+        /*
+        * Add or remove a cell, return if the bitmap changed
+        */
+        bool insert(WorldCellCoordinates _cell_coordinates)
+        {
+            uint64_t block_key = GetBlockKey(_cell_coordinates);
+            uint64_t cell_bit  = GetCellBit(_cell_coordinates);
+            auto     iter      = std::lower_bound(m_blocks.begin(), m_blocks.end(), block_key, [](const Block& _block, uint64_t _key) { return _block.first < _key; });
+
+            if (iter == m_blocks.end() || iter->first != block_key)
+            {
+                iter = m_blocks.insert(iter, { block_key, 0 });
+            }
+
+            if (iter->second & cell_bit)
+            {
+                return false;
+            }
+
+            iter->second |= cell_bit;
+            m_size++;
+
+            return true;
+        }
+
+        bool erase(WorldCellCoordinates _cell_coordinates)
+        {
+            uint64_t block_key = GetBlockKey(_cell_coordinates);
+            uint64_t cell_bit  = GetCellBit(_cell_coordinates);
+            auto     iter      = std::lower_bound(m_blocks.begin(), m_blocks.end(), block_key, [](const Block& _block, uint64_t _key) { return _block.first < _key; });
+
+            if (iter == m_blocks.end() || iter->first != block_key || !(iter->second & cell_bit))
+            {
+                return false;
+            }
+
+            iter->second &= ~cell_bit;
+            m_size--;
+
+            if (iter->second == 0)
+            {
+                m_blocks.erase(iter);
+            }
+
+            return true;
+        }
+
+        bool contains(WorldCellCoordinates _cell_coordinates) const
+        {
+            uint64_t block_key = GetBlockKey(_cell_coordinates);
+            auto     iter      = std::lower_bound(m_blocks.begin(), m_blocks.end(), block_key, [](const Block& _block, uint64_t _key) { return _block.first < _key; });
+
+            return iter != m_blocks.end() && iter->first == block_key && (iter->second & GetCellBit(_cell_coordinates));
+        }
+
+        void clear()
+        {
+            m_blocks.clear();
+            m_size = 0;
+        }
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        Iterator begin() const { return Iterator(m_blocks.begin(), m_blocks.end()); }
+        Iterator end()   const { return Iterator(m_blocks.end(), m_blocks.end()); }
+
+    private:
+
+        static uint64_t GetBlockKey(WorldCellCoordinates _cell_coordinates)
+        {
+            // Arithmetic shifts so negative coordinates fall on their own blocks
+            uint32_t block_x = static_cast<uint32_t>(_cell_coordinates.x >> BlockDimShift);
+            uint32_t block_y = static_cast<uint32_t>(_cell_coordinates.y >> BlockDimShift);
+
+            return (static_cast<uint64_t>(block_x) << 32) | block_y;
+        }
+
+        static uint64_t GetCellBit(WorldCellCoordinates _cell_coordinates)
+        {
+            uint32_t bit_index = static_cast<uint32_t>(_cell_coordinates.x & (BlockDimSize - 1)) * BlockDimSize + static_cast<uint32_t>(_cell_coordinates.y & (BlockDimSize - 1));
+
+            return uint64_t(1) << bit_index;
+        }
+
+        std::vector<Block> m_blocks;
+        size_t             m_size = 0;
+    };
+
+    struct WorldCellInfo;
+
     struct WorkerCellsInfos
     {
         // The global entity count this worker has
         uint32_t entity_count = 0;
 
+        // Position of this worker on its layer density heap, max if it isn't there (dummy or disconnected worker)
+        uint32_t density_heap_index = std::numeric_limits<uint32_t>::max();
+
         // All the coordinates that this worker owns
-        std::unordered_set<WorldCellCoordinates, WorldCellCoordinatesHasher, WorldCellCoordinatesComparator> coordinates_owned;
+        WorldCellBitmap coordinates_owned;
+
+        // All the sub cells that this worker owns, the coordinates of a split cell are never owned directly
+        std::unordered_set<WorldCellInfo*> sub_cells_owned;
 
         RuntimeWorkerReference* worker_instance = nullptr;
     };
@@ -1066,6 +1868,35 @@ namespace Jani
         std::array<WorkerCellsInfos*, MaximumLayers> worker_cells_infos;
         WorldCellCoordinates                         cell_coordinates;
 
+        /*
+        * Exponentially decayed count of component updates received for the entities on this cell, together with
+        * the entity count it defines the cell cost used by the load balancer, the decay is applied lazily
+        */
+        float                                        update_activity         = 0.0f;
+        uint64_t                                     update_activity_time_ms = 0;
+
+        // World controller time of the last migration on any layer, used to enforce the migration cooldown
+        uint64_t                                     last_migration_time_ms  = std::numeric_limits<uint64_t>::max();
+
+        /*
+        * A cell can be split into sub cells when it alone holds too many entities for a single worker, each sub
+        * cell has its own entities and owners (and the same coordinates as its parent)
+        * The entities map of a split cell still contains every entity inside it but its worker cells infos are
+        * cleared, ownership must be resolved through the sub cell an entity is in
+        */
+        std::vector<std::unique_ptr<WorldCellInfo>> sub_cells;
+        WorldCellInfo*                              parent_cell        = nullptr;
+        uint32_t                                    sub_cell_index     = 0;
+        uint64_t                                    split_update_index = 0; // World controller update the cell was split on
+
+        // Index of the world grid (resolution) this cell belongs to, only layers using that grid have owners here
+        uint32_t                                    grid_index     = 0;
+
+        bool IsSplit() const
+        {
+            return sub_cells.size() > 0;
+        }
+
         std::optional<RuntimeWorkerReference*> GetWorkerForLayer(LayerId _layer_id) const
         {
             assert(_layer_id < MaximumLayers);
@@ -1079,6 +1910,17 @@ namespace Jani
         }
     };
 
+    /*
+    * Velocity estimated by the world controller from successive position updates, used to predict when the
+    * entity will cross into another cell
+    */
+    struct EntityMotion
+    {
+        WorldPosition sample_position;
+        uint64_t      sample_time_ms = std::numeric_limits<uint64_t>::max();
+        glm::vec2     velocity       = glm::vec2(0.0f, 0.0f); // World units per second
+    };
+
     class ServerEntity
     {
         DISABLE_COPY(ServerEntity);
@@ -1093,21 +1935,23 @@ namespace Jani
         }
 
         /*
-        * Update this entity world cell coordinates
+        * Update this entity world cell coordinates on the given grid (resolution)
         * This should only be called by the world controller
         */
-        void SetWorldCellInfo(const WorldCellInfo& _world_cell) // TODO: Make this protected
+        void SetWorldCellInfo(const WorldCellInfo& _world_cell, uint32_t _grid_index = 0) // TODO: Make this protected
         {
-            world_cell_info = &_world_cell;
+            assert(_grid_index < MaximumGridResolutions);
+            world_cell_infos[_grid_index] = &_world_cell;
         }
 
         /*
-        * Return a reference to the current world cell info
+        * Return a reference to the current world cell info on the given grid (resolution), grid 0 is the one
+        * used by spatial queries
         */
-        const WorldCellInfo& GetWorldCellInfo() const
+        const WorldCellInfo& GetWorldCellInfo(uint32_t _grid_index = 0) const
         {
-            assert(world_cell_info);
-            return *world_cell_info;
+            assert(_grid_index < MaximumGridResolutions && world_cell_infos[_grid_index]);
+            return *world_cell_infos[_grid_index];
         }
 
         /*
@@ -1118,7 +1962,7 @@ namespace Jani
         */
         WorldCellCoordinates GetWorldCellCoordinates() const
         {
-            return world_cell_info->cell_coordinates;
+            return world_cell_infos[0]->cell_coordinates;
         }
 
         /*
@@ -1129,6 +1973,23 @@ namespace Jani
             return world_position;
         }
 
+        /*
+        * Update this entity estimated motion
+        * This should only be called by the world controller
+        */
+        void SetMotion(const EntityMotion& _motion)
+        {
+            m_motion = _motion;
+        }
+
+        /*
+        * Return this entity estimated motion, the velocity is zero until it had two position samples
+        */
+        const EntityMotion& GetMotion() const
+        {
+            return m_motion;
+        }
+
         /*
 
         */
@@ -1198,6 +2059,7 @@ namespace Jani
         {
             component_mask[_component_id] = true;
             m_component_payloads[_component_id] = std::move(_payload);
+            m_component_versions[_component_id]++;
         }
 
         bool UpdateComponent(ComponentId _component_id, ComponentPayload _payload)
@@ -1208,9 +2070,20 @@ namespace Jani
             }
 
             m_component_payloads[_component_id] = std::move(_payload);
+            m_component_versions[_component_id]++;
             return true;
         }
 
+        /*
+        * Return the version for the given component payload, it changes every time the
+        * component is added, updated or removed
+        */
+        uint32_t GetComponentVersion(ComponentId _component_id) const
+        {
+            assert(_component_id < MaximumEntityComponents);
+            return m_component_versions[_component_id];
+        }
+
         const ComponentPayload& GetComponentPayload(ComponentId _component_id) const
         {
             if (!component_mask[_component_id])
@@ -1225,6 +2098,7 @@ namespace Jani
         {
             component_mask[_component_id] = false;
             m_component_payloads[_component_id] = ComponentPayload();
+            m_component_versions[_component_id]++;
 
             assert(_component_id < MaximumEntityComponents);
 
@@ -1269,12 +2143,14 @@ namespace Jani
 
         WorldPosition world_position = { 0, 0 };
         WorkerId      world_position_worker_owner = std::numeric_limits<WorkerId>::max();
+        EntityMotion  m_motion;
         ComponentMask component_mask;
-        const WorldCellInfo* world_cell_info = nullptr;
+        std::array<const WorldCellInfo*, MaximumGridResolutions> world_cell_infos = {};
 
         std::array<ComponentPayload, MaximumEntityComponents>            m_component_payloads;
         std::array<std::vector<ComponentQuery>, MaximumEntityComponents> m_component_queries;
         std::array<uint32_t, MaximumEntityComponents>                    m_component_queries_version = {};
+        std::array<uint32_t, MaximumEntityComponents>                    m_component_versions        = {};
     };
 
     template <typename C, typename EM>
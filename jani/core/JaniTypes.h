@@ -56,6 +56,7 @@ namespace Jani
     static EntityId    InvalidEntityId    = std::numeric_limits<WorkerId>::max();
 
     static const uint32_t MaximumLayers           = 32;
+    static const uint32_t MaximumGridResolutions  = 4;
     static const uint32_t MaximumEntityComponents = 64;
     using                 ComponentMask           = std::bitset<MaximumEntityComponents>;
 
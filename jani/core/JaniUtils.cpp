@@ -4,6 +4,12 @@
 #include "JaniUtils.h"
 #include "JaniStructs.h"
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
 std::string Jani::pretty_bytes(uint64_t _bytes)
 {
     char out_buffer[64];
@@ -30,6 +36,34 @@ std::string Jani::pretty_bytes(uint64_t _bytes)
     return std::string(out_buffer);
 }
 
+uint64_t Jani::GetProcessCpuTimeUs()
+{
+#ifdef _WIN32
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time))
+    {
+        return 0;
+    }
+
+    // File times are in 100 nanoseconds units
+    ULARGE_INTEGER kernel_ticks, user_ticks;
+    kernel_ticks.LowPart  = kernel_time.dwLowDateTime;
+    kernel_ticks.HighPart = kernel_time.dwHighDateTime;
+    user_ticks.LowPart    = user_time.dwLowDateTime;
+    user_ticks.HighPart   = user_time.dwHighDateTime;
+
+    return (kernel_ticks.QuadPart + user_ticks.QuadPart) / 10;
+#else
+    timespec cpu_time;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_time) != 0)
+    {
+        return 0;
+    }
+
+    return static_cast<uint64_t>(cpu_time.tv_sec) * 1000000 + static_cast<uint64_t>(cpu_time.tv_nsec) / 1000;
+#endif
+}
+
 static void to_json(nlohmann::json& j, const Jani::WorldPosition& _object)
 {
     j = nlohmann::json
@@ -14,11 +14,17 @@
 #include <string>
 #include <cmath>
 #include <chrono>
+#include <ctime>
 
 namespace Jani
 {
     std::string pretty_bytes(uint64_t _bytes);
 
+    /*
+    * Return the CPU time (user and kernel, in microseconds) used by this process since it started
+    */
+    uint64_t GetProcessCpuTimeUs();
+
     class ElapsedTimeLogger
     {
     public:
@@ -40,6 +40,86 @@ bool Jani::DeploymentConfig::Initialize(const std::string& _config_file_path)
     m_inspector_listen_port     = config_json["inspector_listen_port"];
     m_thread_pool_size          = config_json["thread_pool_size"];
 
+    if (config_json.find("query_time_budget_ms") != config_json.end())
+    {
+        m_query_time_budget = config_json["query_time_budget_ms"].get<uint32_t>();
+    }
+
+    if (config_json.find("world_grid_layout") != config_json.end())
+    {
+        std::string world_grid_layout = config_json["world_grid_layout"];
+        if (world_grid_layout == "morton")
+        {
+            m_world_grid_layout = WorldGridLayout::Morton;
+        }
+        else if (world_grid_layout != "row_major")
+        {
+            return false;
+        }
+    }
+
+    if (config_json.find("worker_target_frame_time_ms") != config_json.end())
+    {
+        m_worker_target_frame_time = config_json["worker_target_frame_time_ms"].get<uint32_t>();
+        if (m_worker_target_frame_time == 0)
+        {
+            return false;
+        }
+    }
+
+    if (config_json.find("worker_bandwidth_budget") != config_json.end())
+    {
+        m_worker_bandwidth_budget = config_json["worker_bandwidth_budget"].get<uint64_t>();
+    }
+
+    if (config_json.find("spatial_partitioning") != config_json.end())
+    {
+        std::string spatial_partitioning = config_json["spatial_partitioning"];
+        if (spatial_partitioning == "hilbert")
+        {
+            m_spatial_partitioning = SpatialPartitioning::HilbertCurve;
+        }
+        else if (spatial_partitioning != "greedy")
+        {
+            return false;
+        }
+    }
+
+    if (config_json.find("balance_high_watermark") != config_json.end())
+    {
+        m_balance_high_watermark = config_json["balance_high_watermark"].get<float>();
+    }
+
+    if (config_json.find("balance_low_watermark") != config_json.end())
+    {
+        m_balance_low_watermark = config_json["balance_low_watermark"].get<float>();
+    }
+
+    if (m_balance_low_watermark <= 0.0f || m_balance_low_watermark >= m_balance_high_watermark)
+    {
+        return false;
+    }
+
+    if (config_json.find("migration_entity_budget") != config_json.end())
+    {
+        m_migration_entity_budget = config_json["migration_entity_budget"].get<uint32_t>();
+    }
+
+    if (config_json.find("migration_byte_budget") != config_json.end())
+    {
+        m_migration_byte_budget = config_json["migration_byte_budget"].get<uint64_t>();
+    }
+
+    if (config_json.find("cell_migration_cooldown_ms") != config_json.end())
+    {
+        m_cell_migration_cooldown = config_json["cell_migration_cooldown_ms"].get<uint32_t>();
+    }
+
+    if (config_json.find("migration_prediction_horizon_ms") != config_json.end())
+    {
+        m_prediction_horizon = config_json["migration_prediction_horizon_ms"].get<uint32_t>();
+    }
+
     m_uses_centralized_world_origin = config_json["uses_centralized_world_origin"];
     m_maximum_world_length          = config_json["maximum_world_length"];
     m_worker_length                 = config_json["worker_length"];
@@ -108,4 +188,59 @@ uint32_t Jani::DeploymentConfig::GetInspectorListenPort() const
 uint32_t Jani::DeploymentConfig::GetThreadPoolSize() const
 {
     return m_thread_pool_size;
+}
+
+uint32_t Jani::DeploymentConfig::GetQueryTimeBudget() const
+{
+    return m_query_time_budget;
+}
+
+Jani::WorldGridLayout Jani::DeploymentConfig::GetWorldGridLayout() const
+{
+    return m_world_grid_layout;
+}
+
+uint32_t Jani::DeploymentConfig::GetWorkerTargetFrameTime() const
+{
+    return m_worker_target_frame_time;
+}
+
+uint64_t Jani::DeploymentConfig::GetWorkerBandwidthBudget() const
+{
+    return m_worker_bandwidth_budget;
+}
+
+Jani::SpatialPartitioning Jani::DeploymentConfig::GetSpatialPartitioning() const
+{
+    return m_spatial_partitioning;
+}
+
+float Jani::DeploymentConfig::GetBalanceHighWatermark() const
+{
+    return m_balance_high_watermark;
+}
+
+float Jani::DeploymentConfig::GetBalanceLowWatermark() const
+{
+    return m_balance_low_watermark;
+}
+
+uint32_t Jani::DeploymentConfig::GetMigrationEntityBudget() const
+{
+    return m_migration_entity_budget;
+}
+
+uint64_t Jani::DeploymentConfig::GetMigrationByteBudget() const
+{
+    return m_migration_byte_budget;
+}
+
+uint32_t Jani::DeploymentConfig::GetCellMigrationCooldown() const
+{
+    return m_cell_migration_cooldown;
+}
+
+uint32_t Jani::DeploymentConfig::GetMigrationPredictionHorizon() const
+{
+    return m_prediction_horizon;
 }
\ No newline at end of file
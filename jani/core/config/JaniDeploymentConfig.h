@@ -103,6 +103,63 @@ public: // MAIN METHODS //
     */
     uint32_t GetThreadPoolSize() const;
 
+    /*
+    * Return the maximum time (in milliseconds) the runtime can spend evaluating component
+    * queries on a single frame, queries that don't fit are carried over to the next frame
+    * A value of 0 means no budget is applied
+    */
+    uint32_t GetQueryTimeBudget() const;
+
+    /*
+    * Return the memory layout used by the runtime world grid
+    */
+    WorldGridLayout GetWorldGridLayout() const;
+
+    /*
+    * Return the frame time (in milliseconds) a worker is expected to keep, a worker reporting this
+    * frame time is considered at full load
+    */
+    uint32_t GetWorkerTargetFrameTime() const;
+
+    /*
+    * Return the outgoing bandwidth (in bytes per second) a worker is expected to keep, a worker reporting
+    * this bandwidth is considered at full load
+    * A value of 0 means bandwidth isn't considered by the load balancer
+    */
+    uint64_t GetWorkerBandwidthBudget() const;
+
+    /*
+    * Return how spatial layer cells are partitioned between workers
+    */
+    SpatialPartitioning GetSpatialPartitioning() const;
+
+    /*
+    * Return the load (1.0 = at the worker budget) that triggers a spatial balance (high watermark) and
+    * the load a worker must be left at, or stay under when receiving cells (low watermark)
+    */
+    float GetBalanceHighWatermark() const;
+    float GetBalanceLowWatermark()  const;
+
+    /*
+    * Return the maximum number of entities and bytes that balance migrations can move on a single runtime update,
+    * migrations required by worker connections/disconnections are never deferred but still consume the budget
+    * A value of 0 means no limit
+    */
+    uint32_t GetMigrationEntityBudget() const;
+    uint64_t GetMigrationByteBudget()   const;
+
+    /*
+    * Return the time (in milliseconds) a cell must wait after migrating before the balance can migrate it again
+    */
+    uint32_t GetCellMigrationCooldown() const;
+
+    /*
+    * Return how far ahead (in milliseconds) entity movement is extrapolated to pre stage the authority handoff
+    * on the worker it's about to move into
+    * A value of 0 disables the prediction
+    */
+    uint32_t GetMigrationPredictionHorizon() const;
+
 ////////////////////////
 private: // VARIABLES //
 ////////////////////////
@@ -112,7 +169,19 @@ private: // VARIABLES //
     uint32_t    m_server_worker_listen_port = 0;
     uint32_t    m_inspector_listen_port     = 0;
 
-    int32_t m_thread_pool_size = 0;
+    int32_t         m_thread_pool_size  = 0;
+    uint32_t        m_query_time_budget = 0;
+    WorldGridLayout m_world_grid_layout = WorldGridLayout::RowMajor;
+
+    uint32_t            m_worker_target_frame_time = 16;
+    uint64_t            m_worker_bandwidth_budget  = 0;
+    SpatialPartitioning m_spatial_partitioning     = SpatialPartitioning::Greedy;
+    float               m_balance_high_watermark   = 1.0f;
+    float               m_balance_low_watermark    = 0.7f;
+    uint32_t            m_migration_entity_budget  = 0;
+    uint64_t            m_migration_byte_budget    = 0;
+    uint32_t            m_cell_migration_cooldown  = 0;
+    uint32_t            m_prediction_horizon       = 0;
 
     bool     m_is_valid                      = false;
     bool     m_uses_centralized_world_origin = true;
@@ -19,7 +19,8 @@ bool Jani::LayerConfig::Initialize(const std::string& _config_file_path)
         return false;
     }
 
-    nlohmann::json config_json;
+    // Ordered since component attribute offsets depend on their declaration order
+    nlohmann::ordered_json config_json;
     file >> config_json;
 
     auto layers = config_json.find("layers");
@@ -61,6 +62,15 @@ bool Jani::LayerConfig::Initialize(const std::string& _config_file_path)
             layer_info.maximum_workers = layer["maximum_workers"].get<uint32_t>();
         }
 
+        if (layer.find("cell_size") != layer.end())
+        {
+            layer_info.cell_size = layer["cell_size"].get<uint32_t>();
+            if (layer_info.cell_size.value() == 0 || !layer_info.use_spatial_area)
+            {
+                return false;
+            }
+        }
+
         if (layer.find("permissions") != layer.end())
         {
             for (auto& permission : layer["permissions"])
@@ -92,6 +102,11 @@ bool Jani::LayerConfig::Initialize(const std::string& _config_file_path)
         component_info.unique_id  = component["id"];
         component_info.layer_name = component["layer_name"];
 
+        if (component.find("serializable") != component.end())
+        {
+            component_info.is_serializable = component["serializable"];
+        }
+
         if (component.find("attributes") != component.end())
         {
             auto& component_attributes = component["attributes"];
@@ -116,6 +131,23 @@ bool Jani::LayerConfig::Initialize(const std::string& _config_file_path)
                     return false;
                 }
             }
+
+            // Attributes are laid out like the members of the matching component struct, serializable components
+            // don't keep that layout on their payload so their attributes can't be read directly
+            std::optional<uint32_t> current_offset = component_info.is_serializable ? std::nullopt : std::optional<uint32_t>(0);
+            for (auto& component_attribute : component_info.component_attributes)
+            {
+                uint32_t attribute_size = GetAttributeTypeSize(component_attribute.type);
+                if (!current_offset || attribute_size == 0)
+                {
+                    current_offset = std::nullopt;
+                    continue;
+                }
+
+                uint32_t aligned_offset    = (current_offset.value() + attribute_size - 1) / attribute_size * attribute_size;
+                component_attribute.offset = aligned_offset;
+                current_offset             = aligned_offset + attribute_size;
+            }
         }
 
         for (auto& layer : m_layers)
@@ -171,6 +203,83 @@ Jani::LayerId Jani::LayerConfig::GetLayerIdForComponent(ComponentId _component_i
     return m_components.find(_component_id)->second.layer_unique_id;
 }
 
+const Jani::LayerConfig::ComponentAttributeInfo* Jani::LayerConfig::GetComponentAttribute(ComponentId _component_id, const std::string& _attribute_name) const
+{
+    auto component_iter = m_components.find(_component_id);
+    if (component_iter == m_components.end())
+    {
+        return nullptr;
+    }
+
+    for (auto& component_attribute : component_iter->second.component_attributes)
+    {
+        if (component_attribute.name == _attribute_name)
+        {
+            return &component_attribute;
+        }
+    }
+
+    return nullptr;
+}
+
+const std::vector<Jani::LayerConfig::ComponentAttributeInfo>* Jani::LayerConfig::GetComponentAttributes(ComponentId _component_id) const
+{
+    auto component_iter = m_components.find(_component_id);
+    if (component_iter == m_components.end())
+    {
+        return nullptr;
+    }
+
+    return &component_iter->second.component_attributes;
+}
+
+uint64_t Jani::LayerConfig::GetComponentAttributesMask(ComponentId _component_id, const std::vector<std::string>& _attribute_names) const
+{
+    auto component_attributes = GetComponentAttributes(_component_id);
+    if (!component_attributes || component_attributes->size() > 64)
+    {
+        return 0;
+    }
+
+    uint64_t attributes_mask = 0;
+    for (auto& attribute_name : _attribute_names)
+    {
+        bool found = false;
+        for (uint32_t i = 0; i < component_attributes->size(); i++)
+        {
+            auto& component_attribute = (*component_attributes)[i];
+            if (component_attribute.name == attribute_name && component_attribute.offset)
+            {
+                attributes_mask |= uint64_t(1) << i;
+                found            = true;
+                break;
+            }
+        }
+
+        if (!found)
+        {
+            return 0;
+        }
+    }
+
+    return attributes_mask;
+}
+
+uint32_t Jani::LayerConfig::GetAttributeTypeSize(ComponentAttributeType _attribute_type)
+{
+    switch (_attribute_type)
+    {
+        case ComponentAttributeType::boolean: return sizeof(bool);
+        case ComponentAttributeType::int32:   return sizeof(int32_t);
+        case ComponentAttributeType::int64:   return sizeof(int64_t);
+        case ComponentAttributeType::int32u:  return sizeof(uint32_t);
+        case ComponentAttributeType::int64u:  return sizeof(uint64_t);
+        case ComponentAttributeType::float32: return sizeof(float);
+        case ComponentAttributeType::float64: return sizeof(double);
+        default:                              return 0;
+    }
+}
+
 bool Jani::LayerConfig::HasLayer(const std::string& _layer_name) const
 {
     return m_layers.find(Hasher(_layer_name)) != m_layers.end();
@@ -30,14 +30,16 @@ class LayerConfig
         bool                     use_spatial_area            = false;
         uint32_t                 maximum_entities_per_worker = std::numeric_limits<uint32_t>::max();
         uint32_t                 maximum_workers             = std::numeric_limits<uint32_t>::max();
+        std::optional<uint32_t>  cell_size; // World units, spatial layers without it use the deployment worker length
         std::set<ComponentId>    components;
         LayerPermissionFlags     layer_permissions           = LayerPermissionBits::None;
     };
 
     struct ComponentAttributeInfo
     {
-        ComponentAttributeType type;
-        std::string            name;
+        ComponentAttributeType  type;
+        std::string             name;
+        std::optional<uint32_t> offset; // Byte offset inside the component payload (natural alignment, declaration order), unknown after a string attribute or on serializable components
     };
 
     struct ComponentInfo
@@ -46,6 +48,7 @@ class LayerConfig
         std::string                         layer_name;
         LayerId                             layer_unique_id = std::numeric_limits<LayerId>::max();
         ComponentId                         unique_id       = std::numeric_limits<ComponentId>::max();
+        bool                                is_serializable = false; // Payload is cereal encoded instead of the raw component memory
         std::vector<ComponentAttributeInfo> component_attributes;
     };
 
@@ -86,6 +89,28 @@ public: // MAIN METHODS //
     */
     LayerId GetLayerIdForComponent(ComponentId _component_id) const;
 
+    /*
+    * Return the attribute info for the given component attribute, if both exist
+    */
+    const ComponentAttributeInfo* GetComponentAttribute(ComponentId _component_id, const std::string& _attribute_name) const;
+
+    /*
+    * Return the schema attributes for the given component, nullptr if the component doesn't exist
+    */
+    const std::vector<ComponentAttributeInfo>* GetComponentAttributes(ComponentId _component_id) const;
+
+    /*
+    * Return a mask with the bit of each given attribute (its index on the component schema) set, returns 0 if
+    * any of them doesn't exist or doesn't have a fixed offset
+    */
+    uint64_t GetComponentAttributesMask(ComponentId _component_id, const std::vector<std::string>& _attribute_names) const;
+
+    /*
+    * Return the size in bytes an attribute type uses inside a component payload, 0 for types without a
+    * fixed size (strings)
+    */
+    static uint32_t GetAttributeTypeSize(ComponentAttributeType _attribute_type);
+
     /*
     * Return if the given layer info exist
     */
@@ -872,7 +872,10 @@ namespace Jani
         RuntimeComponentUpdate,
         RuntimeComponentInterestQueryUpdate, /* update a certain component query */
         RuntimeComponentInterestQuery,       /* perform a certain component query */
+        RuntimeWorkerInterestUpdate,         /* update the interest regions of a worker */
+        RuntimeAggregateQuery,               /* perform an aggregate (count/bounds/histogram) query */
         RuntimeWorkerReportAcknowledge, 
+        RuntimeLayerAuthorityHandoffAcknowledge, /* the new owner received the entity state and is ready to take authority */
 
         /* Worker Spawner Requests */
         SpawnWorkerForLayer,
@@ -885,6 +888,7 @@ namespace Jani
         WorkerLayerAuthorityLost, 
         WorkerLayerAuthorityGainImminent,
         WorkerLayerAuthorityGain, 
+        WorkerLayerCellMigration,        /* the same authority change for many entities, with their components */
 
         /* Inspector -> Runtime Requests */
         RuntimeGetEntitiesInfo, 
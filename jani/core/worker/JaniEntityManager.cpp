@@ -228,6 +228,36 @@ bool Jani::EntityManager::ClearInterestQuery(
     return false;
 }
 
+bool Jani::EntityManager::UpdateWorkerInterest(std::vector<WorkerInterest>&& _interests)
+{
+    for (auto& interest : _interests)
+    {
+        if (!interest.IsValid())
+        {
+            MessageLog().Error("EntityManager -> Trying to update the worker interest with an invalid interest entry");
+            return false;
+        }
+    }
+
+    return m_worker.RequestUpdateWorkerInterest(std::move(_interests));
+}
+
+bool Jani::EntityManager::ClearWorkerInterest()
+{
+    return m_worker.RequestUpdateWorkerInterest({});
+}
+
+Jani::Worker::ResponseCallback<Jani::Message::RuntimeAggregateQueryResponse> Jani::EntityManager::PerformAggregateQuery(AggregateQuery _query)
+{
+    if (!_query.IsValid())
+    {
+        MessageLog().Error("EntityManager -> Trying to perform an invalid aggregate query");
+        return Worker::ResponseCallback<Message::RuntimeAggregateQueryResponse>();
+    }
+
+    return m_worker.RequestAggregateQuery(std::move(_query));
+}
+
 std::optional<Jani::EntityId> Jani::EntityManager::RetrieveNextAvailableEntityId(bool _is_waiting_for_reserve_response) const
 {
     constexpr uint32_t total_entities_to_reserve = 10000;
@@ -131,6 +131,12 @@ public: // MAIN METHODS //
         {
             ComponentClass raw_component;
 
+            // Projections rely on the raw memory layout, they aren't supported by serializable components
+            if (_component_payload.is_partial)
+            {
+                return false;
+            }
+
             StreamVectorWrap<char> data_buffer(nonstd::span<char>(_component_payload.component_data.data(), _component_payload.component_data.data() + _component_payload.component_data.size()));
             std::istream           stream(&data_buffer);
 
@@ -252,12 +258,25 @@ public: // MAIN METHODS //
         {
             ComponentClass raw_component;
 
-            if (_component_payload.component_data.size() != sizeof(ComponentClass))
+            // A partial payload only updates the projected attributes, on top of the current component data
+            if (_component_payload.is_partial)
             {
-                return false;
+                raw_component = _entity.has_component<ComponentClass>() ? *_entity.component<ComponentClass>() : ComponentClass();
+
+                if (!ComponentPartialView(_component_payload).ApplyTo(raw_component))
+                {
+                    return false;
+                }
             }
+            else
+            {
+                if (_component_payload.component_data.size() != sizeof(ComponentClass))
+                {
+                    return false;
+                }
 
-            std::memcpy(&raw_component, _component_payload.component_data.data(), _component_payload.component_data.size());
+                std::memcpy(&raw_component, _component_payload.component_data.data(), _component_payload.component_data.size());
+            }
 
             if (_entity.has_component<ComponentClass>())
             {
@@ -668,6 +687,25 @@ public: // MAIN METHODS //
         const Entity& _entity,
         ComponentId   _target_component_id);
 
+    /*
+    * Replace the interest regions of this worker, those are evaluated once per worker by the runtime
+    * and should be preferred over per-entity queries when many owned entities share the same interest
+    * (ex: everything around the owned cells)
+    */
+    bool UpdateWorkerInterest(std::vector<WorkerInterest>&& _interests);
+
+    /*
+    * Remove all interest regions of this worker
+    */
+    bool ClearWorkerInterest();
+
+    /*
+    * Perform an aggregate query (entity count, attribute bounds or per cell histogram), the aggregation
+    * is done by the runtime so only the result is transferred
+    * Use OnResponse() on the returned object to receive the result
+    */
+    Worker::ResponseCallback<Message::RuntimeAggregateQueryResponse> PerformAggregateQuery(AggregateQuery _query);
+
 ///////////////////////
 public: // ITERATORS //
 ///////////////////////
@@ -277,10 +277,54 @@ bool Jani::Worker::RequestUpdateComponentInterestQuery(
     return false;
 }
 
+bool Jani::Worker::RequestUpdateWorkerInterest(std::vector<WorkerInterest> _interests)
+{
+    assert(m_bridge_connection);
+
+    Message::RuntimeWorkerInterestUpdateRequest worker_interest_update_request;
+    worker_interest_update_request.interests = std::move(_interests);
+
+    auto request_result = m_request_manager.MakeRequest(*m_bridge_connection, Jani::RequestType::RuntimeWorkerInterestUpdate, worker_interest_update_request);
+    if (request_result)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+Jani::Worker::ResponseCallback<Jani::Message::RuntimeAggregateQueryResponse> Jani::Worker::RequestAggregateQuery(AggregateQuery _query)
+{
+    assert(m_bridge_connection);
+
+    Message::RuntimeAggregateQueryRequest aggregate_query_request;
+    aggregate_query_request.query = std::move(_query);
+
+    auto request_result = m_request_manager.MakeRequest(*m_bridge_connection, Jani::RequestType::RuntimeAggregateQuery, aggregate_query_request);
+    if (request_result)
+    {
+        return ResponseCallback<Message::RuntimeAggregateQueryResponse>(request_result.value(), this);
+    }
+
+    return ResponseCallback<Message::RuntimeAggregateQueryResponse>();
+}
+
+void Jani::Worker::BeginFrame()
+{
+    m_frame_begin_timestamp = std::chrono::steady_clock::now();
+    m_is_frame_begin_set    = true;
+}
+
 void Jani::Worker::Update(uint32_t _time_elapsed_ms)
 {
     auto time_now = std::chrono::steady_clock::now();
 
+    // Without a frame begin mark only the time spent here is accounted
+    if (!m_is_frame_begin_set)
+    {
+        m_frame_begin_timestamp = time_now;
+    }
+
     // Erase timed-out entities
     {
         auto iter = m_entity_id_to_info_map.begin();
@@ -289,10 +333,11 @@ void Jani::Worker::Update(uint32_t _time_elapsed_ms)
             auto  entity_id   = iter->first;
             auto& entity_info = iter->second;
 
-            assert(!(entity_info.interest_component_mask.count() == 0 && !entity_info.is_owned));
+            assert(!(entity_info.interest_component_mask.count() == 0 && !entity_info.is_owned && !entity_info.is_authority_gain_imminent));
 
-            // Don't do anything is this entity doesn't have any interest component
-            if (entity_info.interest_component_mask.count() == 0)
+            // Don't do anything is this entity doesn't have any interest component, entities about to be gained
+            // are kept until the runtime resolves their handoff
+            if (entity_info.interest_component_mask.count() == 0 || entity_info.is_authority_gain_imminent)
             {
                 iter++;
                 continue;
@@ -356,6 +401,7 @@ void Jani::Worker::Update(uint32_t _time_elapsed_ms)
                 switch (_request_info.type)
                 {
                     case Jani::RequestType::RuntimeWorkerReportAcknowledge:
+                    case Jani::RequestType::RuntimeLayerAuthorityHandoffAcknowledge:
                     {
                         is_internal_response = true;
                         break;
@@ -415,12 +461,23 @@ void Jani::Worker::Update(uint32_t _time_elapsed_ms)
                         }
                         break;
                     }
+                    case Jani::RequestType::RuntimeAggregateQuery:
+                    {
+                        auto response = _response_payload.GetResponse<Jani::Message::RuntimeAggregateQueryResponse>();
+                        auto callback = std::get_if<ResponseCallback<Message::RuntimeAggregateQueryResponse>>((response_callback));
+                        if (callback)
+                        {
+                            callback->Call(response, false);
+                        }
+                        break;
+                    }
                     case Jani::RequestType::RuntimeAddEntity:
                     case Jani::RequestType::RuntimeRemoveEntity:
                     case Jani::RequestType::RuntimeAddComponent:
                     case Jani::RequestType::RuntimeRemoveComponent:
                     case Jani::RequestType::RuntimeComponentUpdate:
                     case Jani::RequestType::RuntimeComponentInterestQueryUpdate:
+                    case Jani::RequestType::RuntimeWorkerInterestUpdate:
                     {
                         auto response = _response_payload.GetResponse<Jani::Message::RuntimeDefaultResponse>();
                         auto callback = std::get_if<ResponseCallback<Message::RuntimeDefaultResponse>>((response_callback));
@@ -454,25 +511,7 @@ void Jani::Worker::Update(uint32_t _time_elapsed_ms)
                     {
                         auto add_component_request = _request_payload.GetRequest<Message::WorkerAddComponentRequest>();
 
-                        // Check if we already have the entity created
-                        auto entity_iter = m_entity_id_to_info_map.find(add_component_request.entity_id);
-                        if (entity_iter != m_entity_id_to_info_map.end())
-                        {
-                            auto  entity_id   = entity_iter->first;
-                            auto& entity_info = entity_iter->second;
-
-                            assert(entity_info.is_owned);
-
-                            // If this entity had this component as an interest-based type, remove it from the interest mask
-                            // as it will be added into the owned one
-                            // (removed the check as it is unnecessary, just set it directly)
-                            entity_info.interest_component_mask.set(add_component_request.component_id, false);
-
-                            entity_info.owned_component_mask.set(add_component_request.component_id, true);
-
-                            assert(m_on_component_update_callback);
-                            m_on_component_update_callback(entity_id, add_component_request.component_id, add_component_request.component_payload);
-                        }
+                        ProcessAddComponent(add_component_request.entity_id, add_component_request.component_id, add_component_request.component_payload);
 
                         break;
                     }
@@ -505,67 +544,41 @@ void Jani::Worker::Update(uint32_t _time_elapsed_ms)
                     }
                     case RequestType::WorkerLayerAuthorityLostImminent:
                     {
-                        assert(false);
+                        auto authority_lost_imminent_request = _request_payload.GetRequest<Message::WorkerLayerAuthorityLostImminentRequest>();
+
+                        ProcessAuthorityLostImminent(authority_lost_imminent_request.entity_id);
+
                         break;
                     }
                     case RequestType::WorkerLayerAuthorityLost:
                     {
                         auto authority_lost_request = _request_payload.GetRequest<Message::WorkerLayerAuthorityLostRequest>();
 
-                        auto entity_iter = m_entity_id_to_info_map.find(authority_lost_request.entity_id);
-                        if (entity_iter != m_entity_id_to_info_map.end())
-                        {
-                            auto  entity_id   = entity_iter->first;
-                            auto& entity_info = entity_iter->second;
-
-                            assert(m_on_authority_lost_callback);
-                            m_on_authority_lost_callback(entity_id);
-
-                            entity_info.is_owned = false;
-
-                            entity_info.interest_component_mask |= entity_info.owned_component_mask;
-                            entity_info.owned_component_mask.reset();
-
-                            if (entity_info.component_mask.count() == 0)
-                            {
-                                m_entity_count--;
-
-                                assert(m_on_entity_destroy_callback);
-                                m_on_entity_destroy_callback(entity_id);
-
-                                m_entity_id_to_info_map.erase(entity_iter);
-                            }
-                        }
+                        ProcessAuthorityLost(authority_lost_request.entity_id);
 
                         break;
                     }
                     case RequestType::WorkerLayerAuthorityGainImminent:
                     {
-                        assert(false);
+                        auto authority_gain_imminent_request = _request_payload.GetRequest<Message::WorkerLayerAuthorityGainImminentRequest>();
+
+                        ProcessAuthorityGainImminent(authority_gain_imminent_request.entity_id, authority_gain_imminent_request.total_components);
+
                         break;
                     }
                     case RequestType::WorkerLayerAuthorityGain:
                     {
                         auto authority_gain_request = _request_payload.GetRequest<Message::WorkerLayerAuthorityGainRequest>();
 
-                        auto entity_iter = m_entity_id_to_info_map.find(authority_gain_request.entity_id);
-                        if (entity_iter == m_entity_id_to_info_map.end())
-                        {
-                            EntityInfo new_entity_info;
-                            entity_iter = m_entity_id_to_info_map.insert({ authority_gain_request.entity_id, std::move(new_entity_info) }).first;
-
-                            assert(m_on_entity_create_callback);
-                            m_on_entity_create_callback(authority_gain_request.entity_id);
-
-                            m_entity_count++;
-                        }
+                        ProcessAuthorityGain(authority_gain_request.entity_id);
 
-                        auto& entity_info = entity_iter->second;
-
-                        entity_info.is_owned = true;
+                        break;
+                    }
+                    case RequestType::WorkerLayerCellMigration:
+                    {
+                        auto cell_migration_request = _request_payload.GetRequest<Message::WorkerLayerCellMigrationRequest>();
 
-                        assert(m_on_authority_gain_callback);
-                        m_on_authority_gain_callback(authority_gain_request.entity_id);
+                        ProcessCellMigration(cell_migration_request);
 
                         break;
                     }
@@ -618,15 +631,41 @@ void Jani::Worker::Update(uint32_t _time_elapsed_ms)
             });
     }
 
+    // Handoff acknowledgements queued while processing the runtime messages go together
+    FlushAuthorityHandoffAcknowledgements();
+
+    // Frame time is the busy time of the frame, idle time between frames isn't load
+    {
+        uint32_t frame_time_us = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_frame_begin_timestamp).count());
+
+        m_is_frame_begin_set            = false;
+        m_report_total_frame_time_us   += frame_time_us;
+        m_report_maximum_frame_time_us  = std::max(m_report_maximum_frame_time_us, frame_time_us);
+        m_report_total_frames++;
+    }
+
     // Determine if we should send a worker report
     // [[unlikely]]
     if(m_bridge_connection && std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_last_worker_report_timestamp).count() > 1000)
     {
-        m_last_worker_report_timestamp = std::chrono::steady_clock::now();
+        auto     report_time_now     = std::chrono::steady_clock::now();
+        uint64_t report_cpu_time_us  = GetProcessCpuTimeUs();
+        float    report_period_s     = std::chrono::duration_cast<std::chrono::microseconds>(report_time_now - m_last_worker_report_timestamp).count() / 1000000.0f;
+        float    report_cpu_s        = static_cast<float>(report_cpu_time_us - m_last_worker_report_cpu_time) / 1000000.0f;
+
+        m_last_worker_report_timestamp = report_time_now;
+        m_last_worker_report_cpu_time  = report_cpu_time_us;
      
         Message::RuntimeWorkerReportAcknowledgeRequest worker_report;
         worker_report.total_data_received_per_second = Connection<>::GetTotalDataReceived();
         worker_report.total_data_sent_per_second     = Connection<>::GetTotalDataSent();
+        worker_report.average_frame_time_us          = m_report_total_frames > 0 ? static_cast<uint32_t>(m_report_total_frame_time_us / m_report_total_frames) : 0;
+        worker_report.maximum_frame_time_us          = m_report_maximum_frame_time_us;
+        worker_report.cpu_usage                      = report_period_s > 0.0f ? report_cpu_s / report_period_s : 0.0f;
+
+        m_report_total_frame_time_us   = 0;
+        m_report_maximum_frame_time_us = 0;
+        m_report_total_frames          = 0;
 
         if (!m_request_manager.MakeRequest(
             *m_bridge_connection,
@@ -660,6 +699,301 @@ bool Jani::Worker::IsEntityOwned(EntityId _entity_id) const
     return false;
 }
 
+bool Jani::Worker::IsEntityAuthorityLossImminent(EntityId _entity_id) const
+{
+    auto entity_info_iter = m_entity_id_to_info_map.find(_entity_id);
+    if (entity_info_iter != m_entity_id_to_info_map.end())
+    {
+        return entity_info_iter->second.is_owned && entity_info_iter->second.is_authority_lost_imminent;
+    }
+
+    return false;
+}
+
+void Jani::Worker::ProcessAddComponent(EntityId _entity_id, ComponentId _component_id, const ComponentPayload& _component_payload)
+{
+    // Check if we already have the entity created
+    auto entity_iter = m_entity_id_to_info_map.find(_entity_id);
+    if (entity_iter == m_entity_id_to_info_map.end())
+    {
+        return;
+    }
+
+    auto& entity_info = entity_iter->second;
+
+    // The entity state streamed before an authority gain is kept as interest until the
+    // runtime flips the authority
+    if (!entity_info.is_owned && entity_info.is_authority_gain_imminent)
+    {
+        entity_info.component_mask.set(_component_id, true);
+        entity_info.interest_component_mask.set(_component_id, true);
+        entity_info.imminent_component_mask.set(_component_id, true);
+        entity_info.last_update_received_timestamp = std::chrono::steady_clock::now();
+
+        assert(m_on_component_update_callback);
+        m_on_component_update_callback(_entity_id, _component_id, _component_payload);
+
+        TryAcknowledgeAuthorityHandoff(_entity_id, entity_info);
+
+        return;
+    }
+
+    assert(entity_info.is_owned);
+
+    // If this entity had this component as an interest-based type, remove it from the interest mask
+    // as it will be added into the owned one
+    // (removed the check as it is unnecessary, just set it directly)
+    entity_info.interest_component_mask.set(_component_id, false);
+
+    entity_info.owned_component_mask.set(_component_id, true);
+
+    assert(m_on_component_update_callback);
+    m_on_component_update_callback(_entity_id, _component_id, _component_payload);
+}
+
+void Jani::Worker::ProcessAuthorityLostImminent(EntityId _entity_id)
+{
+    // The authority is kept until the loss is confirmed, the runtime still accepts our updates
+    auto entity_iter = m_entity_id_to_info_map.find(_entity_id);
+    if (entity_iter != m_entity_id_to_info_map.end() && entity_iter->second.is_owned)
+    {
+        entity_iter->second.is_authority_lost_imminent = true;
+    }
+}
+
+void Jani::Worker::ProcessAuthorityLost(EntityId _entity_id)
+{
+    auto entity_iter = m_entity_id_to_info_map.find(_entity_id);
+    if (entity_iter == m_entity_id_to_info_map.end())
+    {
+        return;
+    }
+
+    auto& entity_info = entity_iter->second;
+
+    // A cancelled handoff, the components received so far stay as interest and time out normally
+    if (!entity_info.is_owned && entity_info.is_authority_gain_imminent)
+    {
+        entity_info.imminent_component_mask.reset();
+        entity_info.imminent_total_components  = 0;
+        entity_info.is_authority_gain_imminent = false;
+        entity_info.is_handoff_acknowledged    = false;
+    }
+    else
+    {
+        assert(m_on_authority_lost_callback);
+        m_on_authority_lost_callback(_entity_id);
+
+        entity_info.is_owned                   = false;
+        entity_info.is_authority_lost_imminent = false;
+
+        entity_info.interest_component_mask |= entity_info.owned_component_mask;
+        entity_info.owned_component_mask.reset();
+    }
+
+    if (entity_info.component_mask.count() == 0)
+    {
+        m_entity_count--;
+
+        assert(m_on_entity_destroy_callback);
+        m_on_entity_destroy_callback(_entity_id);
+
+        m_entity_id_to_info_map.erase(entity_iter);
+    }
+}
+
+void Jani::Worker::ProcessAuthorityGainImminent(EntityId _entity_id, uint32_t _total_components)
+{
+    auto entity_iter = m_entity_id_to_info_map.find(_entity_id);
+    if (entity_iter == m_entity_id_to_info_map.end())
+    {
+        EntityInfo new_entity_info;
+        entity_iter = m_entity_id_to_info_map.insert({ _entity_id, std::move(new_entity_info) }).first;
+
+        assert(m_on_entity_create_callback);
+        m_on_entity_create_callback(_entity_id);
+
+        m_entity_count++;
+    }
+
+    auto& entity_info = entity_iter->second;
+
+    // The runtime doesn't hand off entities we already own, but a late message from a cancelled
+    // handoff can still arrive
+    if (entity_info.is_owned)
+    {
+        return;
+    }
+
+    entity_info.imminent_component_mask.reset();
+    entity_info.imminent_total_components  = _total_components;
+    entity_info.is_authority_gain_imminent = true;
+    entity_info.is_handoff_acknowledged    = false;
+
+    TryAcknowledgeAuthorityHandoff(_entity_id, entity_info);
+}
+
+void Jani::Worker::ProcessAuthorityGain(EntityId _entity_id)
+{
+    auto entity_iter = m_entity_id_to_info_map.find(_entity_id);
+    if (entity_iter == m_entity_id_to_info_map.end())
+    {
+        EntityInfo new_entity_info;
+        entity_iter = m_entity_id_to_info_map.insert({ _entity_id, std::move(new_entity_info) }).first;
+
+        assert(m_on_entity_create_callback);
+        m_on_entity_create_callback(_entity_id);
+
+        m_entity_count++;
+    }
+
+    auto& entity_info = entity_iter->second;
+
+    // A handoff to another worker was cancelled, we never lost the authority
+    if (entity_info.is_owned)
+    {
+        entity_info.is_authority_lost_imminent = false;
+        return;
+    }
+
+    // Components streamed during the handoff become owned
+    if (entity_info.is_authority_gain_imminent)
+    {
+        entity_info.owned_component_mask    |= entity_info.imminent_component_mask;
+        entity_info.interest_component_mask &= ~entity_info.imminent_component_mask;
+
+        entity_info.imminent_component_mask.reset();
+        entity_info.imminent_total_components  = 0;
+        entity_info.is_authority_gain_imminent = false;
+        entity_info.is_handoff_acknowledged    = false;
+    }
+
+    entity_info.is_owned = true;
+
+    assert(m_on_authority_gain_callback);
+    m_on_authority_gain_callback(_entity_id);
+}
+
+void Jani::Worker::ProcessCellMigration(const Message::WorkerLayerCellMigrationRequest& _cell_migration_request)
+{
+    // Validate the whole message before applying anything, a malformed one is dropped
+    {
+        uint64_t total_encoded_components = 0;
+        uint64_t total_data_size          = 0;
+        bool     has_valid_counts         = (_cell_migration_request.entity_total_components.size() == 0 || _cell_migration_request.entity_total_components.size() == _cell_migration_request.entity_ids.size())
+                                         && (_cell_migration_request.entity_encoded_components.size() == 0 || _cell_migration_request.entity_encoded_components.size() == _cell_migration_request.entity_ids.size());
+
+        for (uint32_t i = 0; has_valid_counts && i < _cell_migration_request.entity_encoded_components.size(); i++)
+        {
+            uint32_t total_components = i < _cell_migration_request.entity_total_components.size() ? _cell_migration_request.entity_total_components[i] : 0;
+            has_valid_counts         &= _cell_migration_request.entity_encoded_components[i] <= total_components;
+            total_encoded_components += _cell_migration_request.entity_encoded_components[i];
+        }
+
+        for (auto data_size : _cell_migration_request.component_data_sizes)
+        {
+            total_data_size += data_size;
+        }
+
+        for (auto component_id : _cell_migration_request.component_ids)
+        {
+            has_valid_counts &= component_id < MaximumEntityComponents;
+        }
+
+        if (!has_valid_counts
+            || total_encoded_components != _cell_migration_request.component_ids.size()
+            || total_encoded_components != _cell_migration_request.component_data_sizes.size()
+            || total_data_size != _cell_migration_request.component_data.size())
+        {
+            Jani::MessageLog().Error("Worker -> Received cell migration with {} entities and mismatching component sizes, ignoring it", _cell_migration_request.entity_ids.size());
+            return;
+        }
+    }
+
+    uint32_t component_index = 0;
+    uint32_t data_offset     = 0;
+
+    for (uint32_t i = 0; i < _cell_migration_request.entity_ids.size(); i++)
+    {
+        EntityId entity_id          = _cell_migration_request.entity_ids[i];
+        uint32_t total_components   = i < _cell_migration_request.entity_total_components.size() ? _cell_migration_request.entity_total_components[i] : 0;
+        uint32_t encoded_components = i < _cell_migration_request.entity_encoded_components.size() ? _cell_migration_request.entity_encoded_components[i] : 0;
+
+        switch (_cell_migration_request.authority_change)
+        {
+            case RequestType::WorkerLayerAuthorityLostImminent: ProcessAuthorityLostImminent(entity_id);                   break;
+            case RequestType::WorkerLayerAuthorityLost:         ProcessAuthorityLost(entity_id);                           break;
+            case RequestType::WorkerLayerAuthorityGainImminent: ProcessAuthorityGainImminent(entity_id, total_components); break;
+            case RequestType::WorkerLayerAuthorityGain:         ProcessAuthorityGain(entity_id);                           break;
+            default:
+            {
+                Jani::MessageLog().Error("Worker -> Received cell migration with an invalid authority change");
+                return;
+            }
+        }
+
+        // Components that didn't fit on this message arrive next as WorkerAddComponent requests
+        for (uint32_t j = 0; j < encoded_components; j++, component_index++)
+        {
+            assert(component_index < _cell_migration_request.component_ids.size());
+
+            uint16_t data_size = _cell_migration_request.component_data_sizes[component_index];
+
+            ComponentPayload component_payload;
+            component_payload.entity_owner = entity_id;
+            component_payload.component_id = _cell_migration_request.component_ids[component_index];
+            component_payload.component_data.assign(
+                _cell_migration_request.component_data.begin() + data_offset,
+                _cell_migration_request.component_data.begin() + data_offset + data_size);
+
+            data_offset += data_size;
+
+            ProcessAddComponent(entity_id, component_payload.component_id, component_payload);
+        }
+    }
+}
+
+void Jani::Worker::TryAcknowledgeAuthorityHandoff(EntityId _entity_id, EntityInfo& _entity_info)
+{
+    if (!_entity_info.is_authority_gain_imminent
+        || _entity_info.is_handoff_acknowledged
+        || _entity_info.imminent_component_mask.count() < _entity_info.imminent_total_components)
+    {
+        return;
+    }
+
+    m_pending_handoff_acknowledgements.push_back(_entity_id);
+
+    _entity_info.is_handoff_acknowledged = true;
+}
+
+void Jani::Worker::FlushAuthorityHandoffAcknowledgements()
+{
+    if (!m_bridge_connection || m_pending_handoff_acknowledgements.size() == 0)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < m_pending_handoff_acknowledgements.size(); i += MaximumAcknowledgementsPerMessage)
+    {
+        uint32_t end_index = std::min(i + MaximumAcknowledgementsPerMessage, static_cast<uint32_t>(m_pending_handoff_acknowledgements.size()));
+
+        Message::RuntimeLayerAuthorityHandoffAcknowledgeRequest handoff_acknowledge_request;
+        handoff_acknowledge_request.entity_ids.assign(m_pending_handoff_acknowledgements.begin() + i, m_pending_handoff_acknowledgements.begin() + end_index);
+
+        // The runtime forces the handoff after its timeout if this doesn't arrive
+        if (!m_request_manager.MakeRequest(
+            *m_bridge_connection,
+            RequestType::RuntimeLayerAuthorityHandoffAcknowledge,
+            handoff_acknowledge_request))
+        {
+            Jani::MessageLog().Error("Worker -> Failed to acknowledge authority handoff for {} entities", end_index - i);
+        }
+    }
+
+    m_pending_handoff_acknowledgements.clear();
+}
+
 bool Jani::Worker::IsComponentOwned(ComponentId _component_id) const
 {
     JaniWarnOnce("Worker -> Calling IsComponentOwned() but the method isn't implemented yet, returning false");
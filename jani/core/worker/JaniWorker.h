@@ -22,6 +22,11 @@ class Worker
 {
     friend EntityManager;
 
+    /*
+    * Maximum number of entities acknowledged on a single authority handoff message
+    */
+    static const uint32_t MaximumAcknowledgementsPerMessage = 128;
+
 public:
 
     using OnAuthorityGainCallback   = std::function<void(EntityId)>;
@@ -94,6 +99,7 @@ public:
     using ResponseCallbackType = std::variant
         <
         ResponseCallback<Message::RuntimeReserveEntityIdRangeResponse>,
+        ResponseCallback<Message::RuntimeAggregateQueryResponse>,
         ResponseCallback<Message::RuntimeAuthenticationResponse>,
         ResponseCallback<Message::RuntimeDefaultResponse>
         >;
@@ -109,6 +115,14 @@ private:
         std::array<std::chrono::time_point<std::chrono::steady_clock>, MaximumEntityComponents> component_queries_time;
         bool                                                                                    is_owned = false;
 
+        // Authority handoff state, an entity about to be gained keeps the received components on the interest mask
+        // (and on the imminent mask) until the runtime flips the authority
+        ComponentMask                                                                           imminent_component_mask;
+        uint32_t                                                                                imminent_total_components   = 0;
+        bool                                                                                    is_authority_gain_imminent  = false;
+        bool                                                                                    is_authority_lost_imminent  = false;
+        bool                                                                                    is_handoff_acknowledged     = false;
+
         // This time is used when an entity is pure interest-based (only exist because of interest queries)
         // If the update timestamp timeout (according to this worker interest timeout settings), it will be removed
         // This does not affect entities that have at least one component owned by this worker
@@ -155,6 +169,13 @@ public: // MAIN METHODS //
     */
     bool IsConnected() const;
 
+    /*
+    * Mark the start of the game work for the current frame, the reported frame time goes from here until the
+    * end of Update(), any idle/sleep time must happen before calling this
+    * If not called, only the time spent inside Update() is reported
+    */
+    void BeginFrame();
+
     /*
     * The main update function
     * Use this to process current component data
@@ -188,6 +209,24 @@ protected:
     */
     void WaitForNextMessage(RequestInfo::RequestIndex _message_index, bool _perform_worker_updates);
 
+    /*
+    * Process the authority changes and component additions sent by the runtime, a cell migration message
+    * applies the same authority change to many entities and carries their components
+    */
+    void ProcessAddComponent(EntityId _entity_id, ComponentId _component_id, const ComponentPayload& _component_payload);
+    void ProcessAuthorityLostImminent(EntityId _entity_id);
+    void ProcessAuthorityLost(EntityId _entity_id);
+    void ProcessAuthorityGainImminent(EntityId _entity_id, uint32_t _total_components);
+    void ProcessAuthorityGain(EntityId _entity_id);
+    void ProcessCellMigration(const Message::WorkerLayerCellMigrationRequest& _cell_migration_request);
+
+    /*
+    * Queue the handoff acknowledgement for an entity about to be gained if all its state was received, queued
+    * acknowledgements are sent together once the runtime messages for this update were processed
+    */
+    void TryAcknowledgeAuthorityHandoff(EntityId _entity_id, EntityInfo& _entity_info);
+    void FlushAuthorityHandoffAcknowledgements();
+
 public:
 
     /*
@@ -273,11 +312,32 @@ protected:
         ComponentId                  _component_id,
         std::vector<ComponentQuery>  _queries);
 
+    /*
+    * Request the game server to replace the interest regions of this worker
+    * Worker interests are evaluated once per worker instead of once per entity, an empty
+    * list removes all of them
+    * This operation is dependent on the permissions of this worker
+    */
+    bool RequestUpdateWorkerInterest(std::vector<WorkerInterest> _interests);
+
+    /*
+    * Request the game server to perform an aggregate query, only the aggregated values are
+    * sent back (entity count, attribute bounds or a per cell histogram)
+    * This operation is dependent on the permissions of this worker
+    */
+    ResponseCallback<Message::RuntimeAggregateQueryResponse> RequestAggregateQuery(AggregateQuery _query);
+
     /*
     * Returns if the given entity is owned by this worker
     */
     bool IsEntityOwned(EntityId _entity_id) const;
 
+    /*
+    * Returns if the given entity is owned by this worker but is being handed off to another worker, the
+    * authority is kept (and updates are accepted) until the runtime confirms the loss
+    */
+    bool IsEntityAuthorityLossImminent(EntityId _entity_id) const;
+
     /*
     * Returns if the given component is owned by this worker layer
     */
@@ -298,9 +358,16 @@ private: // VARIABLES //
     uint32_t m_interest_entity_timeout = 3000;
 
     std::chrono::time_point<std::chrono::steady_clock> m_last_worker_report_timestamp = std::chrono::steady_clock::now();
+    std::chrono::time_point<std::chrono::steady_clock> m_frame_begin_timestamp        = std::chrono::steady_clock::now();
+    bool                                               m_is_frame_begin_set           = false;
+    uint64_t                                           m_last_worker_report_cpu_time  = GetProcessCpuTimeUs();
+    uint64_t                                           m_report_total_frame_time_us   = 0;
+    uint32_t                                           m_report_maximum_frame_time_us = 0;
+    uint32_t                                           m_report_total_frames          = 0;
 
     std::unordered_map<EntityId, EntityInfo>                            m_entity_id_to_info_map;
     std::unordered_map<RequestInfo::RequestIndex, ResponseCallbackType> m_response_callbacks;
+    std::vector<EntityId>                                               m_pending_handoff_acknowledgements;
 
     // Callbacks
     OnAuthorityGainCallback   m_on_authority_gain_callback;
@@ -584,8 +584,8 @@ std::optional<std::pair<Jani::WorldPosition, Jani::ComponentQuery>> Jani::Inspec
         else if (_constraint.or_constraint && _constraint.or_constraint.value().first && _constraint.or_constraint.value().second)
         {
             auto or_query = _query.Or();
-            ApplyConstraintToQuery(*_constraint.and_constraint.value().first, *or_query.first);
-            ApplyConstraintToQuery(*_constraint.and_constraint.value().second, *or_query.second);
+            ApplyConstraintToQuery(*_constraint.or_constraint.value().first, *or_query.first);
+            ApplyConstraintToQuery(*_constraint.or_constraint.value().second, *or_query.second);
         }
         else if (_constraint.and_constraint && _constraint.and_constraint.value().first && _constraint.and_constraint.value().second)
         {
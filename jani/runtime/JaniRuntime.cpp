@@ -7,11 +7,14 @@
 #include "config/JaniWorkerSpawnerConfig.h"
 #include "JaniRuntimeBridge.h"
 #include "JaniRuntimeDatabase.h"
+#include "JaniRuntimeQuerySet.h"
 #include "JaniRuntimeWorkerReference.h"
 #include "JaniRuntimeWorkerSpawnerReference.h"
 #include "JaniRuntimeWorldController.h"
 #include "nonstd/bitset_iter.h"
 
+#include <glm/gtc/constants.hpp>
+
 /*
     *** Pendencias 
 
@@ -82,6 +85,7 @@ Jani::Runtime::Runtime(
     , m_deployment_config(_deployment_config)
     , m_layer_config(_layer_config)
     , m_worker_spawner_config(_worker_spawner_config)
+    , m_component_payload_cache(_layer_config)
 {
 }
 
@@ -127,8 +131,6 @@ bool Jani::Runtime::Initialize()
     m_world_controller->RegisterCellOwnershipChangeCallback(
         [&](const std::map<EntityId, ServerEntity*>& _entities, WorldCellCoordinates _cell_coordinates, LayerId _layer_id, const RuntimeWorkerReference* _current_worker, const RuntimeWorkerReference* _new_worker)
         {
-            auto& layer_info = m_layer_config.GetLayerInfo(_layer_id);
-
             if (_current_worker == nullptr && _new_worker == nullptr)
             {
                 return;
@@ -147,106 +149,26 @@ bool Jani::Runtime::Initialize()
                 Jani::MessageLog().Info("Runtime -> Cell migration performed from worker_id {} to worker_id {} on layer_id {} for cell ({},{})", _current_worker->GetId(), _new_worker->GetId(), _layer_id, _cell_coordinates.x, _cell_coordinates.y);
             }
 
+            std::vector<EntityId> entity_ids;
+            entity_ids.reserve(_entities.size());
             for (auto& [entity_id, entity] : _entities)
             {
-                Message::WorkerLayerAuthorityLostRequest authority_lost_request;
-                authority_lost_request.entity_id = entity_id;
-
-                if (_current_worker)
-                {
-                    if (!m_request_manager->MakeRequest(
-                        *m_worker_connections,
-                        _current_worker->GetConnectionClientHash(),
-                        RequestType::WorkerLayerAuthorityLost,
-                        authority_lost_request))
-                    {
-                    }
-                }
-
-                if (_new_worker)
-                {
-                    Message::WorkerLayerAuthorityGainRequest authority_gain_request;
-                    authority_gain_request.entity_id = entity_id;
-
-                    if (!m_request_manager->MakeRequest(
-                        *m_worker_connections,
-                        _new_worker->GetConnectionClientHash(),
-                        RequestType::WorkerLayerAuthorityGain,
-                        authority_gain_request))
-                    {
-                    }
-
-                    for (auto component_id : layer_info.components)
-                    {
-                        if (!entity->HasComponent(component_id))
-                        {
-                            continue;
-                        }
-
-                        Message::WorkerAddComponentRequest add_component_request;
-                        add_component_request.entity_id         = entity->GetId();
-                        add_component_request.component_id      = component_id;
-                        add_component_request.component_payload = entity->GetComponentPayload(component_id); // If possible, somehow avoid this allocation!!
-
-                        if (!m_request_manager->MakeRequest(
-                            *m_worker_connections,
-                            _new_worker->GetConnectionClientHash(),
-                            RequestType::WorkerAddComponent,
-                            add_component_request))
-                        {
-                        }
-                    }
-                }
+                entity_ids.push_back(entity_id);
             }
+
+            BeginAuthorityHandoff(entity_ids, _layer_id, _current_worker, _new_worker);
         });
 
     m_world_controller->RegisterEntityLayerOwnershipChangeCallback(
         [&](const ServerEntity& _entity, LayerId _layer_id, const RuntimeWorkerReference& _current_worker, const RuntimeWorkerReference& _new_worker)
         {
-            auto& layer_info = m_layer_config.GetLayerInfo(_layer_id);
-
-            Message::WorkerLayerAuthorityLostRequest authority_lost_request;
-            authority_lost_request.entity_id = _entity.GetId();
-
-            if (!m_request_manager->MakeRequest(
-                *m_worker_connections,
-                _current_worker.GetConnectionClientHash(),
-                RequestType::WorkerLayerAuthorityLost,
-                authority_lost_request))
-            {
-            }
-
-            Message::WorkerLayerAuthorityGainRequest authority_gain_request;
-            authority_gain_request.entity_id = _entity.GetId();
-
-            if (!m_request_manager->MakeRequest(
-                *m_worker_connections,
-                _new_worker.GetConnectionClientHash(),
-                RequestType::WorkerLayerAuthorityGain,
-                authority_gain_request))
-            {
-            }
-
-            for (auto component_id : layer_info.components)
-            {
-                if (!_entity.HasComponent(component_id))
-                {
-                    continue;
-                }
-
-                Message::WorkerAddComponentRequest add_component_request;
-                add_component_request.entity_id         = _entity.GetId();
-                add_component_request.component_id      = component_id;
-                add_component_request.component_payload = _entity.GetComponentPayload(component_id); // If possible, somehow avoid this allocation!!
+            BeginAuthorityHandoff({ _entity.GetId() }, _layer_id, &_current_worker, &_new_worker);
+        });
 
-                if (!m_request_manager->MakeRequest(
-                    *m_worker_connections,
-                    _new_worker.GetConnectionClientHash(),
-                    RequestType::WorkerAddComponent,
-                    add_component_request))
-                {
-                }
-            }
+    m_world_controller->RegisterEntityLayerOwnershipPredictCallback(
+        [&](const ServerEntity& _entity, LayerId _layer_id, const RuntimeWorkerReference& _current_worker, const RuntimeWorkerReference& _predicted_worker)
+        {
+            PredictAuthorityHandoff(_entity.GetId(), _layer_id, _current_worker, _predicted_worker);
         });
 
     m_world_controller->RegisterWorkerLayerRequestCallback(
@@ -306,105 +228,360 @@ void Jani::Runtime::Update()
         // ElapsedTimeAutoLogger("World controller update: ", 1000);
 
         m_world_controller->Update();
+
+        UpdateAuthorityHandoffs();
     }
     
     {
         // ElapsedTimeAutoLogger("Total query time: ", 1000);
 
+        // Queries that can't start before the deadline are deferred to the next frame, the controller will
+        // reduce the frequency of the ones that keep missing it
+        auto query_begin_time    = std::chrono::steady_clock::now();
+        auto query_time_budget   = std::chrono::microseconds(m_deployment_config.GetQueryTimeBudget() * 1000);
+        auto query_deadline_time = query_time_budget.count() > 0 ? query_begin_time + query_time_budget : std::chrono::steady_clock::time_point::max();
+
+        struct DueQuery
+        {
+            EntityQueryController::QueryInfo* query_info   = nullptr;
+            ServerEntity*                     entity       = nullptr;
+            uint64_t                          locality_key = 0;
+        };
+
+        struct PendingQueryResult
+        {
+            Connection<>::ClientHash client_hash       = std::numeric_limits<Connection<>::ClientHash>::max();
+            const ServerEntity*      entity            = nullptr;
+            const ComponentPayload*  component_payload = nullptr;
+            uint32_t                 component_version = 0;
+            uint64_t                 projection_mask   = 0; // 0 if the full component is sent
+            const std::vector<char>* encoded_payload   = nullptr;
+            ComponentQuerySource     query_source;
+        };
+
+        struct MergedQueryResult
+        {
+            Connection<>::ClientHash                       client_hash = std::numeric_limits<Connection<>::ClientHash>::max();
+            const ServerEntity*                            entity      = nullptr;
+            ComponentMask                                  merged_component_mask;
+            nonstd::transient_vector<PendingQueryResult>   merged_components;
+            nonstd::transient_vector<ComponentQuerySource> query_sources;
+        };
+
+        struct MergedQueryKeyHasher
+        {
+            std::size_t operator()(const std::pair<Connection<>::ClientHash, EntityId>& _key) const
+            {
+                return std::hash<Connection<>::ClientHash>()(_key.first) ^ (std::hash<EntityId>()(_key.second) << 1);
+            }
+        };
+
+        // Number of queries evaluated by a single task, big enough to amortize the task dispatch
+        const uint32_t query_chunk_size = 64;
+
+        // Collect all due queries resolving their entities only once, outdated ones are flagged here
+        nonstd::transient_vector<DueQuery> due_queries;
+        m_entity_query_controller.ForEach(
+            [&](auto& query_info) -> void
+            {
+                auto entity = m_database.GetEntityByIdMutable(query_info.entity_id);
+                if (!entity || entity.value()->GetQueryVersion(query_info.component_id) != query_info.query_version)
+                {
+                    query_info.is_outdated = true;
+                    return;
+                }
+
+                WorldCellCoordinates cell_coordinates = entity.value()->GetWorldCellCoordinates();
+
+                DueQuery due_query;
+                due_query.query_info   = &query_info;
+                due_query.entity       = entity.value();
+                due_query.locality_key = (static_cast<uint64_t>(static_cast<uint32_t>(cell_coordinates.y)) << 32) | static_cast<uint32_t>(cell_coordinates.x);
+                due_queries.push_back(due_query);
+            });
+
+        // Sorting by cell makes queries from the same (and neighbour) cells fall on the same chunk, so the
+        // cell data is still hot when the next query of the chunk runs
+        std::sort(due_queries.begin(), due_queries.end(), 
+            [](const DueQuery& _first, const DueQuery& _second)
+            {
+                return _first.locality_key < _second.locality_key;
+            });
+
+        // Worker interests are evaluated once per worker according to their own frequency, there is one of
+        // those per worker instead of one per entity so they aren't subject to the query budget
+        struct DueWorkerInterest
+        {
+            const RuntimeWorkerReference* worker_instance = nullptr;
+            uint32_t                      interest_index  = 0;
+        };
+
+        nonstd::transient_vector<DueWorkerInterest> due_worker_interests;
+        for (auto& [client_hash, worker_instance] : m_worker_instance_mapping)
+        {
+            if (!m_trust_server_workers
+                && !(m_layer_config.GetLayerInfo(worker_instance->GetLayerId()).layer_permissions & LayerPermissionBits::CanReceiveQueryResults))
+            {
+                continue;
+            }
+
+            for (uint32_t interest_index = 0; interest_index < worker_instance->GetInterests().size(); interest_index++)
+            {
+                if (worker_instance->ConsumeInterestEvaluation(interest_index, query_begin_time))
+                {
+                    due_worker_interests.push_back({ worker_instance, interest_index });
+                }
+            }
+        }
+
+        auto AppendPendingResults = [&](
+            nonstd::transient_vector<PendingQueryResult>&              _chunk_result,
+            Connection<>::ClientHash                                   _client_hash, 
+            const nonstd::transient_vector<ComponentQueryResultEntry>& _query_results, 
+            const ComponentQuerySource&                                _query_source,
+            const ComponentQuery*                                      _component_query)
+        {
+            // Projections are resolved once per query evaluation instead of once per result, a mask has the bit i
+            // set for each requested schema attribute i and 0 means the full component must be sent
+            std::array<uint64_t, MaximumEntityComponents> projection_masks = {};
+            if (_component_query)
+            {
+                for (auto& projection : _component_query->projections)
+                {
+                    if (projection.component_id < MaximumEntityComponents)
+                    {
+                        projection_masks[projection.component_id] = m_layer_config.GetComponentAttributesMask(projection.component_id, projection.attribute_names);
+                    }
+                }
+            }
+
+            for (auto& query_entry : _query_results)
+            {
+                for (auto& component_payload : query_entry.component_payloads)
+                {
+                    PendingQueryResult pending_result;
+                    pending_result.client_hash       = _client_hash;
+                    pending_result.entity            = query_entry.entity;
+                    pending_result.component_payload = component_payload;
+                    pending_result.component_version = query_entry.entity->GetComponentVersion(component_payload->component_id);
+                    pending_result.projection_mask   = component_payload->component_id < MaximumEntityComponents ? projection_masks[component_payload->component_id] : 0;
+                    pending_result.query_source      = _query_source;
+
+                    // The payload is encoded only once per frame (and projection) no matter how many observers receive it
+                    pending_result.encoded_payload = &m_component_payload_cache.GetOrEncode(
+                        *component_payload, 
+                        pending_result.component_version,
+                        pending_result.projection_mask);
+
+                    _chunk_result.push_back(pending_result);
+                }
+            }
+        };
+
+        // Each chunk (and each worker interest) writes into its own buffer, they are merged into the outbound
+        // requests after the join
+        size_t total_chunks = (due_queries.size() + query_chunk_size - 1) / query_chunk_size;
+        nonstd::transient_vector<nonstd::transient_vector<PendingQueryResult>> chunk_results(total_chunks + due_worker_interests.size());
+
         jobxx::job query_job = m_thread_pool->GetQueue().create_job(
-            [this](jobxx::context& ctx)
+            [&](jobxx::context& ctx)
             {
-                m_entity_query_controller.ForEach(
-                [&](auto& query_info) -> void
+                for (size_t chunk_index = 0; chunk_index < total_chunks; chunk_index++)
                 {
                     ctx.spawn_task(
-                        [this, &query_info]()
+                        [&, chunk_index]()
                         {
-                            EntityId    entity_id     = query_info.entity_id;
-                            ComponentId component_id  = query_info.component_id;
-                            uint32_t    query_version = query_info.query_version;
+                            auto&  chunk_result = chunk_results[chunk_index];
+                            size_t chunk_begin  = chunk_index * query_chunk_size;
+                            size_t chunk_end    = std::min(chunk_begin + query_chunk_size, due_queries.size());
 
-                            auto entity = m_database.GetEntityByIdMutable(entity_id);
-                            if (!entity)
+                            for (size_t due_query_index = chunk_begin; due_query_index < chunk_end; due_query_index++)
                             {
-                                query_info.is_outdated = true;
-                                return;
-                            }
+                                auto&         query_info   = *due_queries[due_query_index].query_info;
+                                ServerEntity* entity       = due_queries[due_query_index].entity;
+                                ComponentId   component_id = query_info.component_id;
 
-                            if (entity.value()->GetQueryVersion(component_id) != query_version)
-                            {
-                                query_info.is_outdated = true;
-                                return;
-                            }
+                                if (std::chrono::steady_clock::now() > query_deadline_time)
+                                {
+                                    query_info.is_deferred = true;
+                                    continue;
+                                }
 
-                            auto& cell_info = m_world_controller->GetWorldCellInfo(entity.value()->GetWorldCellCoordinates());
-                            auto cell_worker = cell_info.GetWorkerForLayer(m_layer_config.GetLayerIdForComponent(component_id));
-                            if (!cell_worker)
-                            {
-                                return;
-                            }
-                            
-                            if (!m_trust_server_workers
-                                && !(m_layer_config.GetLayerInfo(cell_worker.value()->GetLayerId()).layer_permissions & LayerPermissionBits::CanReceiveQueryResults))
-                            {
-                                // There is no need to log this occurrence since it's ok for a worker to not be able to receive
-                                // component queries even if they were set by a previous worker owner
-                                return;
-                            }
+                                LayerId layer_id  = m_layer_config.GetLayerIdForComponent(component_id);
+                                auto    worker_id = GetAuthoritativeWorkerId(*entity, layer_id);
+                                if (!worker_id)
+                                {
+                                    continue;
+                                }
 
-                            nonstd::transient_vector<std::pair<ComponentMask, nonstd::transient_vector<const ComponentPayload*>>> query_results;
+                                if (!m_trust_server_workers
+                                    && !(m_layer_config.GetLayerInfo(layer_id).layer_permissions & LayerPermissionBits::CanReceiveQueryResults))
+                                {
+                                    // There is no need to log this occurrence since it's ok for a worker to not be able to receive
+                                    // component queries even if they were set by a previous worker owner
+                                    continue;
+                                }
 
-                            // Get and apply the queries
-                            auto component_queries = entity.value()->GetQueriesForComponent(component_id);
-                            for (auto& component_query : component_queries)
-                            {
-                                auto query_result = PerformComponentQuery(component_query, entity.value()->GetWorldPosition(), cell_worker.value()->GetId());
-                                query_results.insert(query_results.end(), std::make_move_iterator(query_result.begin()), std::make_move_iterator(query_result.end()));
-                            }
+                                // Results go to the authoritative worker, that is still the previous owner during a handoff
+                                auto client_hash = worker_id.value();
 
-                            {
-                                for (auto& query_entry : query_results)
+                                // Get and apply the queries
+                                auto& component_queries = entity->GetQueriesForComponent(component_id);
+                                for (uint32_t query_index = 0; query_index < component_queries.size(); query_index++)
                                 {
-                                    Message::RuntimeComponentInterestQueryResponse response;
-                                    response.succeed               = true;
-                                    response.entity_component_mask = query_entry.first;
-                                    response.components_payloads.reserve(query_entry.second.size());
+                                    auto& component_query = component_queries[query_index];
 
-                                    uint32_t total_accumulated_size = 0;
-                                    for (auto& component_payload : query_entry.second)
+                                    // With distance bands the query runs at its highest frequency, but each band is only
+                                    // refreshed when its own period elapsed
+                                    uint32_t due_distance_bands_mask = component_query.GetDueDistanceBandsMask(query_info.previous_evaluation_time, query_info.evaluation_time);
+                                    if (due_distance_bands_mask == 0)
                                     {
-                                        // Check if the message is getting too big and break it
-                                        if (total_accumulated_size + component_payload->component_data.size() > 500)
-                                        {
-                                            m_request_manager->MakeRequest(
-                                                *m_worker_connections,
-                                                cell_worker.value()->GetConnectionClientHash(), 
-                                                Jani::RequestType::RuntimeComponentInterestQuery,
-                                                response);
-
-                                            response.components_payloads.clear();
-                                            total_accumulated_size = 0;
-                                        }
-
-                                        response.components_payloads.push_back(*component_payload);
-
-                                        total_accumulated_size += response.components_payloads.back().component_data.size();
+                                        continue;
                                     }
 
-                                    if (response.components_payloads.size() > 0)
-                                    {
-                                        m_request_manager->MakeRequest(
-                                            *m_worker_connections,
-                                            cell_worker.value()->GetConnectionClientHash(),
-                                            Jani::RequestType::RuntimeComponentInterestQuery,
-                                            response);
-                                    }
+                                    ComponentQuerySource query_source;
+                                    query_source.entity_id    = entity->GetId();
+                                    query_source.component_id = component_id;
+                                    query_source.query_index  = query_index;
+
+                                    auto query_results = PerformComponentQuery(component_query, entity->GetWorldPosition(), worker_id.value(), due_distance_bands_mask);
+                                    AppendPendingResults(chunk_result, client_hash, query_results, query_source, &component_query);
                                 }
                             }
                         });
-                });  
+                }
+
+                for (size_t interest_index = 0; interest_index < due_worker_interests.size(); interest_index++)
+                {
+                    ctx.spawn_task(
+                        [&, interest_index]()
+                        {
+                            auto& due_worker_interest = due_worker_interests[interest_index];
+                            auto& worker_instance     = *due_worker_interest.worker_instance;
+                            auto& interest            = worker_instance.GetInterests()[due_worker_interest.interest_index];
+
+                            ComponentQuerySource query_source;
+                            query_source.query_index = due_worker_interest.interest_index;
+
+                            auto query_results = PerformWorkerInterestQuery(worker_instance, interest);
+                            AppendPendingResults(chunk_results[total_chunks + interest_index], worker_instance.GetConnectionClientHash(), query_results, query_source, nullptr);
+                        });
+                }
             });
         m_thread_pool->GetQueue().wait_job_actively(query_job);
+
+        // Merge all results going to the same worker connection, each (entity, component) is sent only once
+        // per frame no matter how many queries selected it, the response carries all queries that did
+        // If the same component was selected with different projections, the full component wins over any
+        // projection and different projections are joined together
+        nonstd::transient_vector<MergedQueryResult>                                                              merged_results;
+        nonstd::transient_unordered_map<std::pair<Connection<>::ClientHash, EntityId>, size_t, MergedQueryKeyHasher> merged_result_indices;
+        for (auto& chunk_result : chunk_results)
+        {
+            for (auto& pending_result : chunk_result)
+            {
+                auto [merged_iter, inserted] = merged_result_indices.insert({ { pending_result.client_hash, pending_result.entity->GetId() }, merged_results.size() });
+                if (inserted)
+                {
+                    MergedQueryResult merged_result;
+                    merged_result.client_hash = pending_result.client_hash;
+                    merged_result.entity      = pending_result.entity;
+                    merged_results.push_back(std::move(merged_result));
+                }
+
+                auto&       merged_result = merged_results[merged_iter->second];
+                ComponentId component_id  = pending_result.component_payload->component_id;
+
+                if (!merged_result.merged_component_mask.test(component_id))
+                {
+                    merged_result.merged_component_mask.set(component_id);
+                    merged_result.merged_components.push_back(pending_result);
+                }
+                else
+                {
+                    auto merged_component = std::find_if(merged_result.merged_components.begin(), merged_result.merged_components.end(), 
+                        [&](const PendingQueryResult& _merged_component)
+                        {
+                            return _merged_component.component_payload->component_id == component_id;
+                        });
+
+                    if (merged_component != merged_result.merged_components.end() 
+                        && merged_component->projection_mask != 0 
+                        && merged_component->projection_mask != pending_result.projection_mask)
+                    {
+                        merged_component->projection_mask = pending_result.projection_mask == 0 ? 0 : merged_component->projection_mask | pending_result.projection_mask;
+                        merged_component->encoded_payload = &m_component_payload_cache.GetOrEncode(
+                            *merged_component->component_payload, 
+                            merged_component->component_version, 
+                            merged_component->projection_mask);
+                    }
+                }
+
+                if (std::find(merged_result.query_sources.begin(), merged_result.query_sources.end(), pending_result.query_source) == merged_result.query_sources.end())
+                {
+                    merged_result.query_sources.push_back(pending_result.query_source);
+                }
+            }
+        }
+
+        for (auto& merged_result : merged_results)
+        {
+            Message::RuntimeComponentInterestQueryEncodedResponse response;
+            response.succeed               = true;
+            response.entity_component_mask = merged_result.entity->GetComponentMask();
+            response.query_sources.insert(response.query_sources.end(), merged_result.query_sources.begin(), merged_result.query_sources.end());
+
+            auto SendResponse = [&]()
+            {
+                m_request_manager->MakeRequest(
+                    *m_worker_connections,
+                    merged_result.client_hash,
+                    Jani::RequestType::RuntimeComponentInterestQuery,
+                    response);
+            };
+
+            uint32_t total_accumulated_size = 0;
+            for (auto& merged_component : merged_result.merged_components)
+            {
+                auto encoded_payload = merged_component.encoded_payload;
+
+                // Check if the message is getting too big and break it
+                if (total_accumulated_size + encoded_payload->size() > 500)
+                {
+                    SendResponse();
+
+                    response.components_payloads.encoded_payloads.clear();
+                    total_accumulated_size = 0;
+                }
+
+                response.components_payloads.encoded_payloads.push_back(encoded_payload);
+
+                total_accumulated_size += static_cast<uint32_t>(encoded_payload->size());
+            }
+
+            if (response.components_payloads.encoded_payloads.size() > 0)
+            {
+                SendResponse();
+            }
+        }
+
+        // All messages referencing the encoded payloads were sent
+        m_component_payload_cache.Clear();
+
+        auto query_evaluation_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - query_begin_time);
+        auto previous_downgrades   = m_entity_query_controller.GetBudgetCounters().total_downgrades;
+
+        m_entity_query_controller.AcknowledgeEvaluationEnd(query_evaluation_time, query_time_budget);
+
+        auto budget_counters = m_entity_query_controller.GetBudgetCounters();
+        if (budget_counters.total_downgrades != previous_downgrades)
+        {
+            JaniWarning("Runtime -> Query time budget exceeded ({}us), {} queries deferred and {} downgraded this frame, total downgraded queries {}", 
+                query_evaluation_time.count(),
+                budget_counters.last_frame_deferred,
+                budget_counters.total_downgrades - previous_downgrades,
+                budget_counters.downgraded_queries);
+        }
     }
 
     auto ProcessWorkerRequest = [&](
@@ -543,8 +720,6 @@ void Jani::Runtime::Update()
                 auto& entity_map = m_database.GetEntities();
                 for (auto& [entity_id, entity] : entity_map)
                 {
-                    auto& cell_info = m_world_controller->GetWorldCellInfo(entity->GetWorldCellCoordinates());
-                    
                     // Check if the message is getting too big and break it
                     if (get_entities_info_response.entities_infos.size() * sizeof(Message::RuntimeGetEntitiesInfoResponse::EntityInfo) > 500)
                     {
@@ -568,11 +743,13 @@ void Jani::Runtime::Update()
                 Message::RuntimeGetCellsInfosResponse get_cells_infos_response;
                 get_cells_infos_response.succeed = true;
 
-                auto& workers_infos_position_layer = m_world_controller->GetWorkersInfosForLayer(get_cells_infos_request.layer_id);
-                int32_t worker_length              = m_deployment_config.GetWorkerLength();
+                // Each layer reports the cells of its own grid resolution
+                auto&    workers_infos_position_layer = m_world_controller->GetWorkersInfosForLayer(get_cells_infos_request.layer_id);
+                uint32_t grid_index                   = m_world_controller->GetGridIndexForLayer(get_cells_infos_request.layer_id);
+                int32_t  worker_length                = static_cast<int32_t>(m_world_controller->GetGridCellLength(grid_index));
                 for (auto& [worker_id, worker_info] : workers_infos_position_layer)
                 {
-                    for (auto& worker_coordinate : worker_info.worker_cells_infos.coordinates_owned)
+                    for (auto worker_coordinate : worker_info.worker_cells_infos.coordinates_owned)
                     {
                         // Check if the message is getting too big and break it
                         if (get_cells_infos_response.cells_infos.size() * sizeof(Message::RuntimeGetCellsInfosResponse::CellInfo) > 500)
@@ -581,8 +758,8 @@ void Jani::Runtime::Update()
                             get_cells_infos_response.cells_infos.clear();
                         }
 
-                        auto& cell_info           = m_world_controller->GetWorldCellInfo(worker_coordinate);
-                        auto  cell_world_position = m_world_controller->ConvertCellCoordinatesIntoPosition(worker_coordinate);
+                        auto& cell_info           = m_world_controller->GetWorldCellInfo(worker_coordinate, grid_index);
+                        auto  cell_world_position = m_world_controller->ConvertCellCoordinatesIntoPosition(worker_coordinate, grid_index);
                         auto  cell_rect           = WorldRect({ cell_world_position.x, cell_world_position.y, worker_length, worker_length });
 
                         get_cells_infos_response.cells_infos.push_back({
@@ -592,6 +769,29 @@ void Jani::Runtime::Update()
                             worker_coordinate, 
                             static_cast<uint32_t>(cell_info.entities.size()) });
                     }
+
+                    // Sub cells are reported with their own rect inside their cell
+                    int32_t sub_cell_length = worker_length / static_cast<int32_t>(RuntimeWorldController::SubCellDimSize);
+                    for (auto* sub_cell_info : worker_info.worker_cells_infos.sub_cells_owned)
+                    {
+                        if (get_cells_infos_response.cells_infos.size() * sizeof(Message::RuntimeGetCellsInfosResponse::CellInfo) > 500)
+                        {
+                            _response_payload.PushResponse(get_cells_infos_response);
+                            get_cells_infos_response.cells_infos.clear();
+                        }
+
+                        auto    cell_world_position = m_world_controller->ConvertCellCoordinatesIntoPosition(sub_cell_info->cell_coordinates, grid_index);
+                        int32_t sub_cell_x          = static_cast<int32_t>(sub_cell_info->sub_cell_index % RuntimeWorldController::SubCellDimSize);
+                        int32_t sub_cell_y          = static_cast<int32_t>(sub_cell_info->sub_cell_index / RuntimeWorldController::SubCellDimSize);
+                        auto    cell_rect           = WorldRect({ cell_world_position.x + sub_cell_x * sub_cell_length, cell_world_position.y + sub_cell_y * sub_cell_length, sub_cell_length, sub_cell_length });
+
+                        get_cells_infos_response.cells_infos.push_back({
+                            worker_id,
+                            get_cells_infos_request.layer_id,
+                            cell_rect,
+                            sub_cell_info->cell_coordinates, 
+                            static_cast<uint32_t>(sub_cell_info->entities.size()) });
+                    }
                 }
 
                 _response_payload.PushResponse(std::move(get_cells_infos_response));
@@ -636,7 +836,7 @@ void Jani::Runtime::Update()
 
                 for (auto& query_entry : query_entries)
                 {
-                    if (query_entry.second.size() == 0)
+                    if (query_entry.component_payloads.size() == 0)
                     {
                         continue;
                     }
@@ -644,19 +844,13 @@ void Jani::Runtime::Update()
                     Message::RuntimeInspectorQueryResponse response;
                     response.succeed               = true;
                     response.window_id             = inspector_query_request.window_id;
-                    response.entity_id             = query_entry.second.front()->entity_owner;
-                    response.entity_component_mask = query_entry.first;
-                    response.entity_world_position = WorldPosition({ 0, 0 });
-                    response.components_payloads.reserve(query_entry.second.size());
-
-                    auto entity = m_database.GetEntityById(response.entity_id);
-                    if (entity)
-                    {
-                        response.entity_world_position = entity.value()->GetWorldPosition();
-                    }
+                    response.entity_id             = query_entry.entity->GetId();
+                    response.entity_component_mask = query_entry.entity_component_mask;
+                    response.entity_world_position = query_entry.entity->GetWorldPosition();
+                    response.components_payloads.reserve(query_entry.component_payloads.size());
 
                     uint32_t total_accumulated_size = 0;
-                    for (auto& component_payload : query_entry.second)
+                    for (auto& component_payload : query_entry.component_payloads)
                     {
                         // Check if the message is getting too big and break it
                         if (total_accumulated_size + component_payload->component_data.size() > 500)
@@ -716,6 +910,9 @@ void Jani::Runtime::Update()
         }
         */
 
+        // Handoffs from this worker can't be acknowledged by it anymore, the new workers take the authority now
+        UpdateAuthorityHandoffs(worker_id);
+
         if (!m_world_controller->HandleWorkerDisconnection(worker_id, worker_layer_id))
         {
             Jani::MessageLog().Critical("Runtime -> Worker disconnection not handled correctly by the world controller, this failure will trigger an emergency backup and shutdown since the runtime is not able to continue on a non-broken state, worker_id {}, worker_layer_id {}, worker_client_hash {}", worker_id, worker_layer_id, _client_hash);
@@ -900,7 +1097,7 @@ bool Jani::Runtime::OnWorkerAddEntity(
     {
         for (int i = 0; i < MaximumLayers; i++)
         {
-            auto worker = entity.value()->GetWorldCellInfo().GetWorkerForLayer(i);
+            auto worker = m_world_controller->GetEntityWorkerForLayer(*entity.value(), i);
             if (worker)
             {
                 Message::WorkerLayerAuthorityGainRequest authority_gain_request;
@@ -921,7 +1118,7 @@ bool Jani::Runtime::OnWorkerAddEntity(
     for (auto requested_component_payload : _entity_payload.component_payloads) 
     {
         LayerId layer_id = m_layer_config.GetLayerIdForComponent(requested_component_payload.component_id);
-        auto worker      = entity.value()->GetWorldCellInfo().GetWorkerForLayer(layer_id);
+        auto worker      = m_world_controller->GetEntityWorkerForLayer(*entity.value(), layer_id);
         if (!worker)
         {
             // If there is no worker available, we just need to ignore this component addition
@@ -971,13 +1168,16 @@ bool Jani::Runtime::OnWorkerRemoveEntity(
         return false;
     }
 
+    // Drop any handoff for this entity, there is nothing left to flip
+    m_pending_handoffs.erase(m_pending_handoffs.lower_bound({ _entity_id, 0 }), m_pending_handoffs.upper_bound({ _entity_id, std::numeric_limits<LayerId>::max() }));
+
     /*
     // Setup layer workers authority gain
     {
         for (int i = 0; i < MaximumLayers; i++)
         {
             LayerId layer_id = m_layer_config.GetLayerIdForComponent(i);
-            auto worker      = entity.value()->GetWorldCellInfo().GetWorkerForLayer(layer_id);
+            auto worker      = m_world_controller->GetEntityWorkerForLayer(*entity.value(), layer_id);
             if (worker)
             {
                 Message::WorkerLayerAuthorityGainRequest authority_gain_request;
@@ -1038,9 +1238,9 @@ bool Jani::Runtime::OnWorkerAddComponent(
     }
 
     {
-        LayerId layer_id = m_layer_config.GetLayerIdForComponent(_component_id);
-        auto worker      = entity.value()->GetWorldCellInfo().GetWorkerForLayer(layer_id);
-        if (!worker)
+        LayerId layer_id  = m_layer_config.GetLayerIdForComponent(_component_id);
+        auto    worker_id = GetAuthoritativeWorkerId(*entity.value(), layer_id);
+        if (!worker_id)
         {
             // If there is no worker available, we don't need to worry about a worker receiving
             // the request to add the component since there is no worker available for this layer
@@ -1059,7 +1259,7 @@ bool Jani::Runtime::OnWorkerAddComponent(
             // Send a message to this worker to acknowledge him about receiving the component/entity
             if (!m_request_manager->MakeRequest(
                 *m_worker_connections,
-                worker.value()->GetConnectionClientHash(),
+                worker_id.value(),
                 RequestType::WorkerAddComponent,
                 add_component_request))
             {
@@ -1070,6 +1270,10 @@ bool Jani::Runtime::OnWorkerAddComponent(
                     _component_id);
                 return false;
             }
+
+            // The worker gaining the authority gets it too, the channel is ordered so it always arrives after the
+            // migration state and can't make that worker acknowledge before receiving all the other components
+            StreamAuthorityHandoffComponent(_entity_id, layer_id, _component_id, entity.value()->GetComponentPayload(_component_id));
         }
     }
 
@@ -1139,9 +1343,8 @@ bool Jani::Runtime::OnWorkerComponentUpdate(
             return false;
         }
 
-        auto& cell_info  = m_world_controller->GetWorldCellInfo(entity.value()->GetWorldCellCoordinates());
-        auto cell_worker = cell_info.GetWorkerForLayer(layer_id);
-        if (!cell_worker)
+        auto authoritative_worker_id = GetAuthoritativeWorkerId(*entity.value(), layer_id);
+        if (!authoritative_worker_id)
         {
             JaniTrace("Runtime -> OnWorkerComponentUpdate() no worker owner is available on layer {} for entity id {} (worker requester {})", layer_id, _entity_id, _worker_id);
             return false;
@@ -1149,7 +1352,7 @@ bool Jani::Runtime::OnWorkerComponentUpdate(
 
         // This can happen if we just changed the owned of an entity layer and it didn't received the message yet or
         // it arrived before it sent an update
-        if (_worker_id != cell_worker.value()->GetId())
+        if (_worker_id != authoritative_worker_id.value())
         {
             return false;
         }
@@ -1175,6 +1378,12 @@ bool Jani::Runtime::OnWorkerComponentUpdate(
         m_world_controller->AcknowledgeEntityPositionChange(*entity.value(), _entity_world_position.value());
     }
 
+    // Updates are the activity measure used by the load balancer cell cost
+    m_world_controller->AcknowledgeEntityUpdate(*entity.value());
+
+    // Keep streaming the entity state to the worker that is about to gain its authority
+    StreamAuthorityHandoffComponent(_entity_id, layer_id, _component_id, entity.value()->GetComponentPayload(_component_id));
+
     return true;
 }
 
@@ -1199,10 +1408,9 @@ bool Jani::Runtime::OnWorkerComponentInterestQueryUpdate(
         return false;
     }
 
-    LayerId layer_id    = m_layer_config.GetLayerIdForComponent(_component_id);
-    auto&   cell_info   = m_world_controller->GetWorldCellInfo(entity.value()->GetWorldCellCoordinates());
-    auto    cell_worker = cell_info.GetWorkerForLayer(layer_id);
-    if (!cell_worker)
+    LayerId layer_id                = m_layer_config.GetLayerIdForComponent(_component_id);
+    auto    authoritative_worker_id = GetAuthoritativeWorkerId(*entity.value(), layer_id);
+    if (!authoritative_worker_id)
     {
         JaniTrace("Runtime -> OnWorkerComponentInterestQueryUpdate() no worker owner is available on layer {} for entity id {} (worker requester {})", layer_id, _entity_id, _worker_id);
         return false;
@@ -1210,16 +1418,16 @@ bool Jani::Runtime::OnWorkerComponentInterestQueryUpdate(
 
     // This can happen if we just changed the owned of an entity layer and it didn't received the message yet or
     // it arrived before it sent an update
-    if (_worker_id != cell_worker.value()->GetId())
+    if (_worker_id != authoritative_worker_id.value())
     {
         return false;
     }
 
-    // Use the highest frequency
+    // Use the highest frequency, including the distance bands
     QueryUpdateFrequency frequency = QueryUpdateFrequency::Min;
     for (auto& query_info : _component_queries)
     {
-        frequency = static_cast<QueryUpdateFrequency>(std::max(static_cast<uint32_t>(frequency), static_cast<uint32_t>(query_info.frequency)));
+        frequency = static_cast<QueryUpdateFrequency>(std::max(static_cast<uint32_t>(frequency), static_cast<uint32_t>(query_info.GetHighestFrequency())));
     }
 
     entity.value()->UpdateQueriesForComponent(_component_id, std::move(_component_queries));
@@ -1229,203 +1437,1106 @@ bool Jani::Runtime::OnWorkerComponentInterestQueryUpdate(
     return true;
 }
 
-nonstd::transient_vector<std::pair<Jani::ComponentMask, nonstd::transient_vector<const Jani::ComponentPayload*>>> Jani::Runtime::PerformComponentQuery(
-    const ComponentQuery&   _query, 
-    WorldPosition           _search_center_location,
-    std::optional<WorkerId> _ignore_worker) const
+bool Jani::Runtime::OnWorkerInterestUpdate(
+    RuntimeWorkerReference&     _worker_instance,
+    WorkerId                    _worker_id,
+    std::vector<WorkerInterest> _interests)
+{
+    if (!m_trust_server_workers
+        && !(m_layer_config.GetLayerInfo(_worker_instance.GetLayerId()).layer_permissions & LayerPermissionBits::CanUpdateInterest))
+    {
+        JaniWarning("Runtime -> worker {} called OnWorkerInterestUpdate() without having permission, ignoring request", _worker_id);
+        return false;
+    }
+
+    for (auto& interest : _interests)
+    {
+        if (!interest.IsValid())
+        {
+            JaniWarning("Runtime -> OnWorkerInterestUpdate() received an invalid interest from worker {}, ignoring request", _worker_id);
+            return false;
+        }
+    }
+
+    _worker_instance.SetInterests(std::move(_interests));
+
+    return true;
+}
+
+std::optional<Jani::AggregateQueryResult> Jani::Runtime::OnWorkerAggregateQuery(
+    RuntimeWorkerReference& _worker_instance,
+    WorkerId                _worker_id,
+    const AggregateQuery&   _query)
 {
-    nonstd::transient_vector<std::pair<ComponentMask, nonstd::transient_vector<const ComponentPayload*>>> query_result;
-    nonstd::transient_unordered_map<EntityId, ServerEntity*>                                              selected_entities;
+    if (!m_trust_server_workers
+        && !(m_layer_config.GetLayerInfo(_worker_instance.GetLayerId()).layer_permissions & LayerPermissionBits::CanReceiveQueryResults))
+    {
+        JaniWarning("Runtime -> worker {} called OnWorkerAggregateQuery() without having permission, ignoring request", _worker_id);
+        return std::nullopt;
+    }
 
     if (!_query.IsValid())
     {
-        return std::move(query_result);
+        JaniWarning("Runtime -> OnWorkerAggregateQuery() received an invalid query from worker {}, ignoring request", _worker_id);
+        return std::nullopt;
     }
 
-    bool has_area_query = false;
-    std::function<void(const ComponentQueryInstruction&)> ProcessQueryInstruction = [&](const ComponentQueryInstruction& _current_query_instruction)
+    return m_world_controller->PerformAggregateQuery(_query);
+}
+
+Jani::EntityQueryController::QueryBudgetCounters Jani::Runtime::GetQueryBudgetCounters() const
+{
+    return m_entity_query_controller.GetBudgetCounters();
+}
+
+Jani::AuthorityHandoffCounters Jani::Runtime::GetAuthorityHandoffCounters() const
+{
+    AuthorityHandoffCounters handoff_counters   = m_handoff_counters;
+    handoff_counters.pending_handoffs           = static_cast<uint32_t>(m_pending_handoffs.size());
+    handoff_counters.average_handoff_latency_ms = handoff_counters.total_handoffs > 0 ? static_cast<uint32_t>(m_total_handoff_latency_ms / handoff_counters.total_handoffs) : 0;
+
+    return handoff_counters;
+}
+
+bool Jani::Runtime::OnWorkerLayerAuthorityHandoffAcknowledge(
+    RuntimeWorkerReference&      _worker_instance,
+    WorkerId                     _worker_id,
+    const std::vector<EntityId>& _entity_ids)
+{
+    AuthorityChangeBatch authority_changes;
+
+    for (auto entity_id : _entity_ids)
     {
-        if (_current_query_instruction.box_constraint)
+        // The handoff may have been completed by timeout or cancelled before the acknowledge arrived
+        auto handoff_iter = m_pending_handoffs.find({ entity_id, _worker_instance.GetLayerId() });
+        if (handoff_iter == m_pending_handoffs.end() || handoff_iter->second.new_worker_id != _worker_id)
         {
-            if (selected_entities.size() == 0 && !has_area_query)
-            {
-                has_area_query = true;
-                m_world_controller->ForEachEntityOnRect(
-                    _current_query_instruction.box_constraint.value(),
-                    [&](EntityId _selected_entity_id, ServerEntity& _selected_entity, WorldCellCoordinates _cell_coordinates)
-                    {
-                        selected_entities.insert({ _selected_entity_id, &_selected_entity });
-                    });
-            }
-            else
-            {
-                auto iter = selected_entities.begin();
-                while (iter != selected_entities.end())
-                {
-                    auto& selected_entity      = iter->second;
-                    glm::vec2 entity_position  = selected_entity->GetWorldPosition();
-                    glm::vec2 min_box_position = glm::vec2(_current_query_instruction.box_constraint->x, _current_query_instruction.box_constraint->y);
-                    glm::vec2 max_box_position = min_box_position + glm::vec2(_current_query_instruction.box_constraint->width, _current_query_instruction.box_constraint->height);
-                    if (entity_position.x < min_box_position.x 
-                        || entity_position.y < min_box_position.y
-                        || entity_position.x > max_box_position.x
-                        || entity_position.y > max_box_position.y)
-                    {
-                        iter = selected_entities.erase(iter);
-                    }
-                    else
-                    {
-                        iter++;
-                    }
-                }
-            }
+            JaniTrace("Runtime -> OnWorkerLayerAuthorityHandoffAcknowledge() no pending handoff for entity id {} (worker requester {})", entity_id, _worker_id);
+            continue;
         }
-        else if (_current_query_instruction.area_constraint)
+
+        // The new worker missed part of the state, it will acknowledge again once the handoff is restarted
+        if (handoff_iter->second.is_state_stale)
         {
-            if (selected_entities.size() == 0 && !has_area_query)
-            {
-                has_area_query          = true;
-                WorldPosition half_area = WorldPosition({
-                    static_cast<int32_t>(_current_query_instruction.area_constraint->width / 2),
-                    static_cast<int32_t>(_current_query_instruction.area_constraint->height / 2) });
-                WorldRect     rect      = WorldRect({
-                    _search_center_location.x - half_area.x , _search_center_location.y - half_area.y,
-                    _search_center_location.x + half_area.x , _search_center_location.y + half_area.y });
-                m_world_controller->ForEachEntityOnRect(
-                    rect,
-                    [&](EntityId _selected_entity_id, ServerEntity& _selected_entity, WorldCellCoordinates _cell_coordinates)
-                    {
-                        selected_entities.insert({ _selected_entity_id, &_selected_entity });
-                    });
-            }
-            else
-            {
-                auto iter = selected_entities.begin();
-                while (iter != selected_entities.end())
-                {
-                    auto& selected_entity      = iter->second;
-                    glm::vec2 half_area        = glm::vec2(_current_query_instruction.area_constraint->width, _current_query_instruction.area_constraint->height) / 2.0f;
-                    glm::vec2 entity_position  = selected_entity->GetWorldPosition();
-                    glm::vec2 min_box_position = glm::vec2(_search_center_location) - half_area;
-                    glm::vec2 max_box_position = glm::vec2(_search_center_location) + half_area;
-                    if (entity_position.x < min_box_position.x 
-                        || entity_position.y < min_box_position.y
-                        || entity_position.x > max_box_position.x
-                        || entity_position.y > max_box_position.y)
-                    {
-                        iter = selected_entities.erase(iter);
-                    }
-                    else
-                    {
-                        iter++;
-                    }
-                }
+            JaniTrace("Runtime -> OnWorkerLayerAuthorityHandoffAcknowledge() ignoring acknowledge of stale handoff for entity id {} (worker requester {})", entity_id, _worker_id);
+            continue;
+        }
+
+        // A pre staged handoff only flips once the entity crosses into the new worker
+        if (handoff_iter->second.is_predicted)
+        {
+            handoff_iter->second.is_acknowledged = true;
+            continue;
+        }
+
+        AuthorityHandoff handoff = handoff_iter->second;
+        m_pending_handoffs.erase(handoff_iter);
+
+        CompleteAuthorityHandoff(entity_id, handoff, false, authority_changes);
+    }
+
+    SendAuthorityChanges(authority_changes, _worker_instance.GetLayerId());
+
+    return true;
+}
+
+std::optional<Jani::WorkerId> Jani::Runtime::GetAuthoritativeWorkerId(
+    const ServerEntity& _entity,
+    LayerId             _layer_id) const
+{
+    // While an entity layer is being handed off the previous owner keeps the authority
+    auto handoff_iter = m_pending_handoffs.find({ _entity.GetId(), _layer_id });
+    if (handoff_iter != m_pending_handoffs.end())
+    {
+        return handoff_iter->second.current_worker_id;
+    }
+
+    auto cell_worker = m_world_controller->GetEntityWorkerForLayer(_entity, _layer_id);
+    if (!cell_worker)
+    {
+        return std::nullopt;
+    }
+
+    return cell_worker.value()->GetId();
+}
+
+void Jani::Runtime::BeginAuthorityHandoff(
+    const std::vector<EntityId>&  _entity_ids,
+    LayerId                       _layer_id,
+    const RuntimeWorkerReference* _current_worker,
+    const RuntimeWorkerReference* _new_worker)
+{
+    std::optional<WorkerId> cell_worker_id = _current_worker ? std::optional<WorkerId>(_current_worker->GetId()) : std::nullopt;
+    std::optional<WorkerId> new_worker_id  = _new_worker ? std::optional<WorkerId>(_new_worker->GetId()) : std::nullopt;
+    AuthorityChangeBatch    authority_changes;
+    auto                    time_now       = std::chrono::steady_clock::now();
+
+    for (auto entity_id : _entity_ids)
+    {
+        std::optional<WorkerId> current_worker_id = cell_worker_id;
+
+        // The entity crossed into the worker it was predicted to, that worker already has its state and if it
+        // acknowledged it the authority flips right away, otherwise the handoff continues as a regular one
+        auto handoff_iter = m_pending_handoffs.find({ entity_id, _layer_id });
+        if (handoff_iter != m_pending_handoffs.end() && handoff_iter->second.is_predicted && handoff_iter->second.new_worker_id == new_worker_id)
+        {
+            auto& handoff = handoff_iter->second;
+
+            handoff.is_predicted    = false;
+            handoff.start_timestamp = time_now;
+
+            if (handoff.is_acknowledged && !handoff.is_state_stale)
+            {
+                AuthorityHandoff completed_handoff = handoff;
+                m_pending_handoffs.erase(handoff_iter);
+                m_handoff_counters.total_predicted_hits++;
+
+                CompleteAuthorityHandoff(entity_id, completed_handoff, false, authority_changes);
+            }
+            else
+            {
+                authority_changes[{ handoff.current_worker_id, RequestType::WorkerLayerAuthorityLostImminent, false }].push_back(entity_id);
+            }
+
+            continue;
+        }
+
+        // If the entity moved again before its previous handoff completed, the authority is still on the previous
+        // owner and the worker that was about to receive it must drop the state it got
+        if (handoff_iter != m_pending_handoffs.end())
+        {
+            current_worker_id = handoff_iter->second.current_worker_id;
+
+            if (handoff_iter->second.new_worker_id != new_worker_id)
+            {
+                authority_changes[{ handoff_iter->second.new_worker_id, RequestType::WorkerLayerAuthorityLost, false }].push_back(entity_id);
+            }
+
+            m_pending_handoffs.erase(handoff_iter);
+            m_handoff_counters.total_cancelled_handoffs++;
+        }
+
+        if (!current_worker_id && !new_worker_id)
+        {
+            continue;
+        }
+
+        // Back to the worker that never lost the authority, confirming it again clears its imminent loss
+        if (current_worker_id == new_worker_id)
+        {
+            authority_changes[{ new_worker_id.value(), RequestType::WorkerLayerAuthorityGain, false }].push_back(entity_id);
+            continue;
+        }
+
+        // Without a worker on both sides there is no one to keep simulating the entity, flip it immediately
+        if (!current_worker_id || !new_worker_id)
+        {
+            if (current_worker_id)
+            {
+                authority_changes[{ current_worker_id.value(), RequestType::WorkerLayerAuthorityLost, false }].push_back(entity_id);
+            }
+
+            if (new_worker_id)
+            {
+                authority_changes[{ new_worker_id.value(), RequestType::WorkerLayerAuthorityGain, true }].push_back(entity_id);
+            }
+
+            continue;
+        }
+
+        authority_changes[{ current_worker_id.value(), RequestType::WorkerLayerAuthorityLostImminent, false }].push_back(entity_id);
+        authority_changes[{ new_worker_id.value(), RequestType::WorkerLayerAuthorityGainImminent, true }].push_back(entity_id);
+
+        AuthorityHandoff handoff;
+        handoff.current_worker_id = current_worker_id.value();
+        handoff.new_worker_id     = new_worker_id.value();
+        handoff.start_timestamp   = time_now;
+
+        m_pending_handoffs.insert({ { entity_id, _layer_id }, handoff });
+    }
+
+    SendAuthorityChanges(authority_changes, _layer_id);
+}
+
+void Jani::Runtime::PredictAuthorityHandoff(
+    EntityId                      _entity_id,
+    LayerId                       _layer_id,
+    const RuntimeWorkerReference& _current_worker,
+    const RuntimeWorkerReference& _predicted_worker)
+{
+    AuthorityChangeBatch authority_changes;
+    auto                 time_now = std::chrono::steady_clock::now();
+
+    auto handoff_iter = m_pending_handoffs.find({ _entity_id, _layer_id });
+    if (handoff_iter != m_pending_handoffs.end())
+    {
+        auto& handoff = handoff_iter->second;
+
+        // An actual ownership change is already being handed off
+        if (!handoff.is_predicted)
+        {
+            return;
+        }
+
+        // Still heading into the same worker, keep the pre staged handoff alive
+        if (handoff.new_worker_id == _predicted_worker.GetId())
+        {
+            handoff.start_timestamp = time_now;
+            return;
+        }
+
+        // The entity changed its direction, the previously predicted worker must drop the state it got
+        authority_changes[{ handoff.new_worker_id, RequestType::WorkerLayerAuthorityLost, false }].push_back(_entity_id);
+
+        m_pending_handoffs.erase(handoff_iter);
+        m_handoff_counters.total_predicted_misses++;
+    }
+
+    // Only the new worker is told, the current one keeps simulating the entity normally until it crosses
+    authority_changes[{ _predicted_worker.GetId(), RequestType::WorkerLayerAuthorityGainImminent, true }].push_back(_entity_id);
+
+    AuthorityHandoff handoff;
+    handoff.current_worker_id = _current_worker.GetId();
+    handoff.new_worker_id     = _predicted_worker.GetId();
+    handoff.start_timestamp   = time_now;
+    handoff.is_predicted      = true;
+
+    m_pending_handoffs.insert({ { _entity_id, _layer_id }, handoff });
+    m_handoff_counters.total_predicted_handoffs++;
+
+    SendAuthorityChanges(authority_changes, _layer_id);
+}
+
+void Jani::Runtime::CompleteAuthorityHandoff(
+    EntityId                _entity_id,
+    const AuthorityHandoff& _handoff,
+    bool                    _forced,
+    AuthorityChangeBatch&   _authority_changes)
+{
+    // Both changes are sent on the same update, from now on only updates from the new worker are accepted
+    // A stale state is only possible on forced handoffs, the gain carries the whole state so the new worker doesn't keep it
+    _authority_changes[{ _handoff.current_worker_id, RequestType::WorkerLayerAuthorityLost, false }].push_back(_entity_id);
+    _authority_changes[{ _handoff.new_worker_id, RequestType::WorkerLayerAuthorityGain, _handoff.is_state_stale }].push_back(_entity_id);
+
+    uint32_t handoff_latency_ms = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _handoff.start_timestamp).count());
+
+    m_handoff_counters.total_handoffs++;
+    m_handoff_counters.total_forced_handoffs      += _forced ? 1 : 0;
+    m_handoff_counters.last_handoff_latency_ms     = handoff_latency_ms;
+    m_handoff_counters.maximum_handoff_latency_ms  = std::max(m_handoff_counters.maximum_handoff_latency_ms, handoff_latency_ms);
+    m_total_handoff_latency_ms                    += handoff_latency_ms;
+
+    if (_forced)
+    {
+        JaniTrace("Runtime -> Forced authority handoff for entity id {} from worker {} to worker {} after {}ms", _entity_id, _handoff.current_worker_id, _handoff.new_worker_id, handoff_latency_ms);
+    }
+}
+
+void Jani::Runtime::StreamAuthorityHandoffComponent(
+    EntityId                _entity_id,
+    LayerId                 _layer_id,
+    ComponentId             _component_id,
+    const ComponentPayload& _component_payload)
+{
+    auto handoff_iter = m_pending_handoffs.find({ _entity_id, _layer_id });
+    if (handoff_iter == m_pending_handoffs.end() || handoff_iter->second.is_state_stale)
+    {
+        return;
+    }
+
+    // Encoded straight from the database payload, without a copy into the request
+    Message::WorkerAddComponentRequestRef add_component_request;
+    add_component_request.entity_id         = _entity_id;
+    add_component_request.component_id      = _component_id;
+    add_component_request.component_payload = &_component_payload;
+
+    if (!m_request_manager->MakeRequest(
+        *m_worker_connections,
+        handoff_iter->second.new_worker_id,
+        RequestType::WorkerAddComponent,
+        add_component_request))
+    {
+        JaniWarning("Runtime -> Failed to stream component {} of entity id {} to worker {} during an authority handoff, the handoff will be restarted", _component_id, _entity_id, handoff_iter->second.new_worker_id);
+
+        handoff_iter->second.is_state_stale = true;
+    }
+}
+
+void Jani::Runtime::UpdateAuthorityHandoffs(std::optional<WorkerId> _disconnected_worker_id)
+{
+    std::map<LayerId, AuthorityChangeBatch> layers_authority_changes;
+    auto                                    time_now                     = std::chrono::steady_clock::now();
+    uint32_t                                predicted_handoff_expiration = m_deployment_config.GetMigrationPredictionHorizon() * 2;
+
+    auto handoff_iter = m_pending_handoffs.begin();
+    while (handoff_iter != m_pending_handoffs.end())
+    {
+        auto& handoff                 = handoff_iter->second;
+        auto  elapsed_ms              = std::chrono::duration_cast<std::chrono::milliseconds>(time_now - handoff.start_timestamp).count();
+        bool  is_expired              = elapsed_ms >= (handoff.is_predicted ? predicted_handoff_expiration : AuthorityHandoffTimeout);
+        bool  is_current_disconnected = _disconnected_worker_id && handoff.current_worker_id == _disconnected_worker_id.value();
+        bool  is_new_disconnected     = _disconnected_worker_id && handoff.new_worker_id == _disconnected_worker_id.value();
+        auto [entity_id, layer_id]    = handoff_iter->first;
+
+        // The new worker missed a component, send it the whole entity state again and wait for a new acknowledge
+        if (handoff.is_state_stale && !is_expired && !is_current_disconnected && !is_new_disconnected)
+        {
+            layers_authority_changes[layer_id][{ handoff.new_worker_id, RequestType::WorkerLayerAuthorityGainImminent, true }].push_back(entity_id);
+
+            handoff.is_state_stale  = false;
+            handoff.is_acknowledged = false;
+
+            handoff_iter++;
+            continue;
+        }
+
+        // The entity never crossed or one of the workers is gone, the authority stays where it is
+        if (handoff.is_predicted)
+        {
+            if (!is_expired && !is_current_disconnected && !is_new_disconnected)
+            {
+                handoff_iter++;
+                continue;
             }
+
+            if (!is_new_disconnected)
+            {
+                layers_authority_changes[layer_id][{ handoff.new_worker_id, RequestType::WorkerLayerAuthorityLost, false }].push_back(entity_id);
+            }
+
+            handoff_iter = m_pending_handoffs.erase(handoff_iter);
+            m_handoff_counters.total_predicted_misses++;
+
+            continue;
         }
-        else if (_current_query_instruction.radius_constraint)
+
+        if (!is_expired && !is_current_disconnected)
+        {
+            handoff_iter++;
+            continue;
+        }
+
+        AuthorityHandoff ended_handoff = handoff;
+        handoff_iter                   = m_pending_handoffs.erase(handoff_iter);
+
+        CompleteAuthorityHandoff(entity_id, ended_handoff, true, layers_authority_changes[layer_id]);
+    }
+
+    for (auto& [layer_id, authority_changes] : layers_authority_changes)
+    {
+        SendAuthorityChanges(authority_changes, layer_id);
+    }
+}
+
+void Jani::Runtime::SendAuthorityChanges(
+    const AuthorityChangeBatch& _authority_changes,
+    LayerId                     _layer_id)
+{
+    static_assert(MaximumEntityComponents <= std::numeric_limits<uint8_t>::max(), "Cell migration component counts are encoded as 8 bits");
+
+    auto& layer_info = m_layer_config.GetLayerInfo(_layer_id);
+
+    for (auto& [change_key, entity_ids] : _authority_changes)
+    {
+        WorkerId    worker_id          = std::get<0>(change_key);
+        RequestType authority_change   = std::get<1>(change_key);
+        bool        include_components = std::get<2>(change_key);
+        uint32_t    message_size       = 0;
+
+        Message::WorkerLayerCellMigrationRequest cell_migration_request;
+        cell_migration_request.authority_change = authority_change;
+
+        // Components that didn't fit on the current message, sent right after it
+        std::vector<std::tuple<EntityId, ComponentId, const ComponentPayload*>> overflow_components;
+
+        auto SendMessage = [&]()
         {
-            if (selected_entities.size() == 0 && !has_area_query)
+            if (cell_migration_request.entity_ids.size() == 0)
+            {
+                return;
+            }
+
+            if (!m_request_manager->MakeRequest(
+                *m_worker_connections,
+                worker_id,
+                RequestType::WorkerLayerCellMigration,
+                cell_migration_request))
+            {
+                JaniWarning("Runtime -> Failed to send cell migration with {} entities to worker {}", cell_migration_request.entity_ids.size(), worker_id);
+            }
+
+            // The connection is ordered so these always arrive after the entity authority change
+            for (auto& overflow_component : overflow_components)
             {
-                has_area_query = true;
-                m_world_controller->ForEachEntityOnRadius(
-                    _search_center_location,
-                    _current_query_instruction.radius_constraint.value(),
-                    [&](EntityId _selected_entity_id, ServerEntity& _selected_entity, WorldCellCoordinates _cell_coordinates)
+                EntityId    entity_id    = std::get<0>(overflow_component);
+                ComponentId component_id = std::get<1>(overflow_component);
+
+                Message::WorkerAddComponentRequestRef add_component_request;
+                add_component_request.entity_id         = entity_id;
+                add_component_request.component_id      = component_id;
+                add_component_request.component_payload = std::get<2>(overflow_component);
+
+                if (!m_request_manager->MakeRequest(
+                    *m_worker_connections,
+                    worker_id,
+                    RequestType::WorkerAddComponent,
+                    add_component_request))
+                {
+                    JaniWarning("Runtime -> Failed to send component {} of entity id {} after its cell migration to worker {}", component_id, entity_id, worker_id);
+
+                    // The worker won't have the whole entity state, restart the handoff if there is one
+                    auto handoff_iter = m_pending_handoffs.find({ entity_id, _layer_id });
+                    if (handoff_iter != m_pending_handoffs.end())
                     {
-                        selected_entities.insert({ _selected_entity_id, &_selected_entity });
-                    });
+                        handoff_iter->second.is_state_stale = true;
+                    }
+                }
             }
-            else
+
+            cell_migration_request                  = {};
+            cell_migration_request.authority_change = authority_change;
+            message_size                            = 0;
+            overflow_components.clear();
+        };
+
+        for (auto entity_id : entity_ids)
+        {
+            const uint32_t entity_header_size    = sizeof(EntityId) + sizeof(uint8_t) * 2;
+            const uint32_t component_header_size = sizeof(ComponentId) + sizeof(uint16_t);
+
+            const ServerEntity*                                                       entity      = nullptr;
+            uint32_t                                                                  entity_size = entity_header_size;
+            nonstd::transient_vector<std::pair<ComponentId, const ComponentPayload*>> entity_components;
+
+            if (include_components)
             {
-                auto iter = selected_entities.begin();
-                while (iter != selected_entities.end())
+                auto entity_query = m_database.GetEntityById(entity_id);
+                if (!entity_query)
+                {
+                    continue;
+                }
+
+                entity = entity_query.value();
+
+                for (auto component_id : layer_info.components)
                 {
-                    auto& selected_entity     = iter->second;
-                    glm::vec2 entity_position = selected_entity->GetWorldPosition();
-                    glm::vec2 center_position = _search_center_location;
-                    if (glm::distance(entity_position, center_position) > _current_query_instruction.radius_constraint.value())
+                    if (!entity->HasComponent(component_id))
                     {
-                        iter = selected_entities.erase(iter);
+                        continue;
                     }
-                    else
+
+                    auto& component_payload = entity->GetComponentPayload(component_id);
+                    if (component_payload.component_data.size() > MaximumComponentDataSize)
                     {
-                        iter++;
+                        JaniWarning("Runtime -> Component {} of entity id {} has {} bytes and can't be sent to worker {}, the maximum is {}", component_id, entity_id, component_payload.component_data.size(), worker_id, MaximumComponentDataSize);
+                        continue;
                     }
+
+                    entity_components.push_back({ component_id, &component_payload });
+                    entity_size += component_header_size + static_cast<uint32_t>(component_payload.component_data.size());
+                }
+            }
+
+            // An entity that doesn't fit the remaining budget starts a new message, if it's bigger than the whole
+            // budget the components that don't fit follow as their own requests
+            if (message_size + entity_size > MaximumCellMigrationMessageSize)
+            {
+                SendMessage();
+            }
+
+            cell_migration_request.entity_ids.push_back(entity_id);
+            message_size += entity_header_size;
+
+            if (!entity)
+            {
+                continue;
+            }
+
+            // Payloads are encoded directly from the entity, without intermediate component payload copies
+            uint8_t encoded_components = 0;
+            for (auto& [component_id, component_payload] : entity_components)
+            {
+                auto& component_data = component_payload->component_data;
+                if (message_size + component_header_size + component_data.size() > MaximumCellMigrationMessageSize)
+                {
+                    overflow_components.push_back({ entity_id, component_id, component_payload });
+                    continue;
                 }
+
+                cell_migration_request.component_ids.push_back(component_id);
+                cell_migration_request.component_data_sizes.push_back(static_cast<uint16_t>(component_data.size()));
+                cell_migration_request.component_data.insert(cell_migration_request.component_data.end(), component_data.begin(), component_data.end());
+
+                message_size += component_header_size + static_cast<uint32_t>(component_data.size());
+                encoded_components++;
+            }
+
+            cell_migration_request.entity_total_components.push_back(static_cast<uint8_t>(entity_components.size()));
+            cell_migration_request.entity_encoded_components.push_back(encoded_components);
+        }
+
+        SendMessage();
+    }
+}
+
+nonstd::transient_vector<Jani::ComponentQueryResultEntry> Jani::Runtime::PerformComponentQuery(
+    const ComponentQuery&   _query, 
+    WorldPosition           _search_center_location,
+    std::optional<WorkerId> _ignore_worker, 
+    uint32_t                _due_distance_bands_mask) const
+{
+    nonstd::transient_vector<ComponentQueryResultEntry> query_result;
+
+    if (!_query.IsValid())
+    {
+        return std::move(query_result);
+    }
+
+    // Each node is evaluated into a QueryEntitySet (sorted ids or bitmap, selected by cardinality) and the
+    // results are combined by set algebra. A leaf under an And is applied as a filter over its sibling when
+    // the sibling selection is expected to be smaller than what the leaf would select by itself
+    const auto& database_entities = m_database.GetEntities();
+    float       total_entities    = static_cast<float>(database_entities.size());
+    float       world_area        = static_cast<float>(m_deployment_config.GetMaximumWorldLength()) * static_cast<float>(m_deployment_config.GetMaximumWorldLength());
+
+    auto GetAreaRect = [&](const WorldArea& _area) -> WorldRect
+    {
+        return WorldRect({
+            _search_center_location.x - static_cast<int32_t>(_area.width / 2),
+            _search_center_location.y - static_cast<int32_t>(_area.height / 2),
+            static_cast<int32_t>(_area.width),
+            static_cast<int32_t>(_area.height) });
+    };
+
+    auto IsLeafInstruction = [](const ComponentQueryInstruction& _query_instruction) -> bool
+    {
+        return _query_instruction.box_constraint
+            || _query_instruction.area_constraint
+            || _query_instruction.radius_constraint
+            || _query_instruction.component_constraints
+            || _query_instruction.attribute_constraint
+            || _query_instruction.segment_constraint;
+    };
+
+    struct ResolvedAttribute
+    {
+        ComponentAttributeType type   = ComponentAttributeType::boolean;
+        uint32_t               offset = 0;
+        uint32_t               size   = 0;
+    };
+
+    // Attribute constraints are resolved against the component schema once per query evaluation, constraints
+    // that can't be resolved (unknown attribute or without a fixed offset, like any on serializable components)
+    // never match
+    nonstd::transient_unordered_map<const ComponentAttributeConstraint*, std::optional<ResolvedAttribute>> resolved_attributes;
+    auto ResolveAttribute = [&](const ComponentAttributeConstraint& _attribute_constraint) -> const std::optional<ResolvedAttribute>&
+    {
+        auto resolved_iter = resolved_attributes.find(&_attribute_constraint);
+        if (resolved_iter != resolved_attributes.end())
+        {
+            return resolved_iter->second;
+        }
+
+        std::optional<ResolvedAttribute> resolved_attribute;
+        auto attribute_info = m_layer_config.GetComponentAttribute(_attribute_constraint.component_id, _attribute_constraint.attribute_name);
+        if (attribute_info && attribute_info->offset)
+        {
+            resolved_attribute         = ResolvedAttribute();
+            resolved_attribute->type   = attribute_info->type;
+            resolved_attribute->offset = attribute_info->offset.value();
+            resolved_attribute->size   = LayerConfig::GetAttributeTypeSize(attribute_info->type);
+        }
+
+        return resolved_attributes.insert({ &_attribute_constraint, resolved_attribute }).first->second;
+    };
+
+    auto MatchesAttributeConstraint = [&](const ComponentAttributeConstraint& _attribute_constraint, const ServerEntity& _entity) -> bool
+    {
+        auto& resolved_attribute = ResolveAttribute(_attribute_constraint);
+        if (!resolved_attribute || !_entity.HasComponent(_attribute_constraint.component_id))
+        {
+            return false;
+        }
+
+        auto& component_data = _entity.GetComponentPayload(_attribute_constraint.component_id).component_data;
+        if (component_data.size() < resolved_attribute->offset + resolved_attribute->size)
+        {
+            return false;
+        }
+
+        auto Compare = [&](auto _value, auto _constant) -> bool
+        {
+            switch (_attribute_constraint.comparison)
+            {
+                case QueryComparisonOperator::Equal:        return _value == _constant;
+                case QueryComparisonOperator::NotEqual:     return _value != _constant;
+                case QueryComparisonOperator::Less:         return _value < _constant;
+                case QueryComparisonOperator::LessEqual:    return _value <= _constant;
+                case QueryComparisonOperator::Greater:      return _value > _constant;
+                case QueryComparisonOperator::GreaterEqual: return _value >= _constant;
             }
+
+            return false;
+        };
+
+        auto ReadValue = [&](auto& _value)
+        {
+            std::memcpy(&_value, component_data.data() + resolved_attribute->offset, sizeof(_value));
+        };
+
+        switch (resolved_attribute->type)
+        {
+            case ComponentAttributeType::boolean: { uint8_t  value; ReadValue(value); return Compare(static_cast<int64_t>(value != 0), _attribute_constraint.integer_value); } // Any byte other than 0/1 isn't a valid bool
+            case ComponentAttributeType::int32:   { int32_t  value; ReadValue(value); return Compare(static_cast<int64_t>(value), _attribute_constraint.integer_value); }
+            case ComponentAttributeType::int64:   { int64_t  value; ReadValue(value); return Compare(value, _attribute_constraint.integer_value); }
+            case ComponentAttributeType::int32u:  { uint32_t value; ReadValue(value); return Compare(static_cast<int64_t>(value), _attribute_constraint.integer_value); }
+            case ComponentAttributeType::int64u:  { uint64_t value; ReadValue(value); return Compare(value, static_cast<uint64_t>(_attribute_constraint.integer_value)); }
+            case ComponentAttributeType::float32: { float    value; ReadValue(value); return Compare(static_cast<double>(value), _attribute_constraint.real_value); }
+            case ComponentAttributeType::float64: { double   value; ReadValue(value); return Compare(value, _attribute_constraint.real_value); }
+            default:                              return false;
+        }
+    };
+
+    auto MatchesLeafInstruction = [&](const ComponentQueryInstruction& _query_instruction, const ServerEntity& _entity) -> bool
+    {
+        if (_query_instruction.box_constraint || _query_instruction.area_constraint)
+        {
+            WorldRect     rect            = _query_instruction.box_constraint ? _query_instruction.box_constraint.value() : GetAreaRect(_query_instruction.area_constraint.value());
+            WorldPosition entity_position = _entity.GetWorldPosition();
+            return entity_position.x >= rect.x
+                && entity_position.y >= rect.y
+                && entity_position.x <= rect.x + rect.width
+                && entity_position.y <= rect.y + rect.height;
+        }
+        else if (_query_instruction.radius_constraint)
+        {
+            return glm::distance(glm::vec2(_entity.GetWorldPosition()), glm::vec2(_search_center_location)) <= _query_instruction.radius_constraint.value();
+        }
+        else if (_query_instruction.component_constraints)
+        {
+            return (_query_instruction.component_constraints.value() & _entity.GetComponentMask()) == _query_instruction.component_constraints.value();
+        }
+        else if (_query_instruction.attribute_constraint)
+        {
+            return MatchesAttributeConstraint(_query_instruction.attribute_constraint.value(), _entity);
+        }
+        else if (_query_instruction.segment_constraint)
+        {
+            glm::vec2 segment_begin  = glm::vec2(_search_center_location);
+            glm::vec2 segment_vector = glm::vec2(_query_instruction.segment_constraint->end_offset.x, _query_instruction.segment_constraint->end_offset.y);
+            glm::vec2 position       = glm::vec2(_entity.GetWorldPosition());
+            float     length_pow2    = glm::dot(segment_vector, segment_vector);
+            float     projection     = length_pow2 > 0.0f ? glm::clamp(glm::dot(position - segment_begin, segment_vector) / length_pow2, 0.0f, 1.0f) : 0.0f;
+            return glm::distance(position, segment_begin + segment_vector * projection) <= static_cast<float>(_query_instruction.segment_constraint->thickness);
+        }
+
+        return false;
+    };
+
+    // A segment limited to its first hits depends on every entity along it, so it can't be applied as a
+    // per entity filter over another selection
+    auto CanFilterByLeafInstruction = [&](const ComponentQueryInstruction& _query_instruction) -> bool
+    {
+        return IsLeafInstruction(_query_instruction) 
+            && !(_query_instruction.segment_constraint && _query_instruction.segment_constraint->max_hits > 0);
+    };
+
+    // Spatial estimates assume entities are uniformly distributed over the world
+    std::function<float(const ComponentQueryInstruction&)> EstimateCardinality = [&](const ComponentQueryInstruction& _query_instruction) -> float
+    {
+        if (_query_instruction.box_constraint)
+        {
+            float rect_area = static_cast<float>(_query_instruction.box_constraint->width) * static_cast<float>(_query_instruction.box_constraint->height);
+            return total_entities * std::min(1.0f, rect_area / world_area);
+        }
+        else if (_query_instruction.area_constraint)
+        {
+            float rect_area = static_cast<float>(_query_instruction.area_constraint->width) * static_cast<float>(_query_instruction.area_constraint->height);
+            return total_entities * std::min(1.0f, rect_area / world_area);
+        }
+        else if (_query_instruction.radius_constraint)
+        {
+            float radius      = static_cast<float>(_query_instruction.radius_constraint.value());
+            float circle_area = glm::pi<float>() * radius * radius;
+            return total_entities * std::min(1.0f, circle_area / world_area);
+        }
+        else if (_query_instruction.segment_constraint)
+        {
+            auto& segment_constraint = _query_instruction.segment_constraint.value();
+            float segment_length     = glm::length(glm::vec2(segment_constraint.end_offset.x, segment_constraint.end_offset.y));
+            float thickness          = static_cast<float>(segment_constraint.thickness);
+            float capsule_area       = segment_length * thickness * 2.0f + glm::pi<float>() * thickness * thickness;
+            float estimate           = total_entities * std::min(1.0f, capsule_area / world_area);
+            return segment_constraint.max_hits > 0 ? std::min(estimate, static_cast<float>(segment_constraint.max_hits)) : estimate;
+        }
+        else if (_query_instruction.component_constraints || _query_instruction.attribute_constraint)
+        {
+            return total_entities;
+        }
+        else if (_query_instruction.and_constraint)
+        {
+            return std::min(EstimateCardinality(*_query_instruction.and_constraint->first), EstimateCardinality(*_query_instruction.and_constraint->second));
+        }
+        else if (_query_instruction.or_constraint)
+        {
+            return std::min(total_entities, EstimateCardinality(*_query_instruction.or_constraint->first) + EstimateCardinality(*_query_instruction.or_constraint->second));
+        }
+        else if (_query_instruction.not_constraint)
+        {
+            return total_entities - EstimateCardinality(*_query_instruction.not_constraint.value());
+        }
+
+        return 0.0f;
+    };
+
+    auto EvaluateLeafInstruction = [&](const ComponentQueryInstruction& _query_instruction) -> QueryEntitySet
+    {
+        nonstd::transient_vector<EntityId> selected_ids;
+
+        if (_query_instruction.box_constraint || _query_instruction.area_constraint)
+        {
+            WorldRect rect = _query_instruction.box_constraint ? _query_instruction.box_constraint.value() : GetAreaRect(_query_instruction.area_constraint.value());
+            m_world_controller->ForEachEntityOnRect(
+                rect,
+                [&](EntityId _selected_entity_id, ServerEntity& _selected_entity, WorldCellCoordinates _cell_coordinates)
+                {
+                    selected_ids.push_back(_selected_entity_id);
+                });
+        }
+        else if (_query_instruction.radius_constraint)
+        {
+            m_world_controller->ForEachEntityOnRadius(
+                _search_center_location,
+                _query_instruction.radius_constraint.value(),
+                [&](EntityId _selected_entity_id, ServerEntity& _selected_entity, WorldCellCoordinates _cell_coordinates)
+                {
+                    selected_ids.push_back(_selected_entity_id);
+                });
+        }
+        else if (_query_instruction.segment_constraint)
+        {
+            WorldPosition segment_end = WorldPosition({
+                _search_center_location.x + _query_instruction.segment_constraint->end_offset.x,
+                _search_center_location.y + _query_instruction.segment_constraint->end_offset.y });
+
+            m_world_controller->ForEachEntityOnSegment(
+                _search_center_location,
+                segment_end,
+                static_cast<float>(_query_instruction.segment_constraint->thickness),
+                _query_instruction.segment_constraint->max_hits,
+                [&](EntityId _selected_entity_id, ServerEntity& _selected_entity, WorldCellCoordinates _cell_coordinates)
+                {
+                    selected_ids.push_back(_selected_entity_id);
+                });
         }
-        else if (_current_query_instruction.component_constraints)
+        else if (_query_instruction.component_constraints || _query_instruction.attribute_constraint)
         {
-            if (selected_entities.size() == 0 && !has_area_query)
+            // The database is ordered by id so there is no need to sort the selection
+            for (auto& [entity_id, entity] : database_entities)
             {
-                const auto& entities = m_database.GetEntities();
-                for (auto& [entity_id, entity] : entities)
+                if (MatchesLeafInstruction(_query_instruction, *entity))
                 {
-                    auto total_required_components = _current_query_instruction.component_constraints.value().count();
-                    auto component_mask            = entity->GetComponentMask();
-                    if ((_current_query_instruction.component_constraints.value() & component_mask).count() == total_required_components)
-                    {
-                        selected_entities.insert({ entity_id, entity.get() });
-                    }
+                    selected_ids.push_back(entity_id);
                 }
             }
-            else
+
+            return QueryEntitySet::FromIds(std::move(selected_ids), true);
+        }
+
+        return QueryEntitySet::FromIds(std::move(selected_ids));
+    };
+
+    auto FilterByLeafInstruction = [&](const QueryEntitySet& _entity_set, const ComponentQueryInstruction& _query_instruction, bool _keep_matches) -> QueryEntitySet
+    {
+        nonstd::transient_vector<EntityId> selected_ids;
+        selected_ids.reserve(static_cast<size_t>(_entity_set.GetCardinality()));
+
+        _entity_set.ForEach(
+            [&](EntityId _entity_id)
             {
-                auto iter = selected_entities.begin();
-                while (iter != selected_entities.end())
+                auto entity = m_database.GetEntityById(_entity_id);
+                if (entity && MatchesLeafInstruction(_query_instruction, *entity.value()) == _keep_matches)
                 {
-                    auto& selected_entity          = iter->second;
-                    auto total_required_components = _current_query_instruction.component_constraints.value().count();
-                    auto component_mask            = selected_entity->GetComponentMask();
-                    if ((_current_query_instruction.component_constraints.value() & component_mask).count() != total_required_components)
-                    {
-                        iter = selected_entities.erase(iter);
-                    }
-                    else
-                    {
-                        iter++;
-                    }
+                    selected_ids.push_back(_entity_id);
+                }
+            });
+
+        return QueryEntitySet::FromIds(std::move(selected_ids), true);
+    };
+
+    auto EvaluateAllEntities = [&]() -> QueryEntitySet
+    {
+        nonstd::transient_vector<EntityId> selected_ids;
+        selected_ids.reserve(database_entities.size());
+        for (auto& [entity_id, entity] : database_entities)
+        {
+            selected_ids.push_back(entity_id);
+        }
+
+        return QueryEntitySet::FromIds(std::move(selected_ids), true);
+    };
+
+    std::function<QueryEntitySet(const ComponentQueryInstruction&)> EvaluateQueryInstruction = [&](const ComponentQueryInstruction& _query_instruction) -> QueryEntitySet
+    {
+        if (IsLeafInstruction(_query_instruction))
+        {
+            return EvaluateLeafInstruction(_query_instruction);
+        }
+        else if (_query_instruction.and_constraint)
+        {
+            const ComponentQueryInstruction* small_instruction = _query_instruction.and_constraint->first.get();
+            const ComponentQueryInstruction* large_instruction = _query_instruction.and_constraint->second.get();
+            float                            small_estimate    = EstimateCardinality(*small_instruction);
+            float                            large_estimate    = EstimateCardinality(*large_instruction);
+
+            // Never start from a negated side, it would materialize almost every entity on the world
+            if (small_instruction->not_constraint || (!large_instruction->not_constraint && large_estimate < small_estimate))
+            {
+                std::swap(small_instruction, large_instruction);
+                std::swap(small_estimate, large_estimate);
+            }
+
+            QueryEntitySet small_set = EvaluateQueryInstruction(*small_instruction);
+            if (small_set.GetCardinality() == 0)
+            {
+                return small_set;
+            }
+
+            // A and not B
+            if (large_instruction->not_constraint)
+            {
+                const ComponentQueryInstruction& negated_instruction = *large_instruction->not_constraint.value();
+                if (CanFilterByLeafInstruction(negated_instruction) && small_set.GetCardinality() <= EstimateCardinality(negated_instruction))
+                {
+                    return FilterByLeafInstruction(small_set, negated_instruction, false);
                 }
+
+                return QueryEntitySet::Difference(small_set, EvaluateQueryInstruction(negated_instruction));
+            }
+
+            if (CanFilterByLeafInstruction(*large_instruction) && small_set.GetCardinality() <= large_estimate)
+            {
+                return FilterByLeafInstruction(small_set, *large_instruction, true);
             }
+
+            return QueryEntitySet::Intersection(small_set, EvaluateQueryInstruction(*large_instruction));
         }
-        else if (_current_query_instruction.and_constraint)
+        else if (_query_instruction.or_constraint)
         {
-            ProcessQueryInstruction(*_current_query_instruction.and_constraint->first);
-            ProcessQueryInstruction(*_current_query_instruction.and_constraint->second);
+            return QueryEntitySet::Union(
+                EvaluateQueryInstruction(*_query_instruction.or_constraint->first),
+                EvaluateQueryInstruction(*_query_instruction.or_constraint->second));
         }
-        else if (_current_query_instruction.or_constraint)
+        else if (_query_instruction.not_constraint)
+        {
+            return QueryEntitySet::Difference(EvaluateAllEntities(), EvaluateQueryInstruction(*_query_instruction.not_constraint.value()));
+        }
+
+        return QueryEntitySet();
+    };
+
+    QueryEntitySet selected_entities = EvaluateQueryInstruction(*_query.root_query);
+
+    auto IsComponentIgnored = [&](const ServerEntity& _entity, ComponentId _component_id) -> bool
+    {
+        if (!_ignore_worker)
         {
-            ProcessQueryInstruction(*_current_query_instruction.or_constraint->first);
-            ProcessQueryInstruction(*_current_query_instruction.or_constraint->second);
+            return false;
         }
+
+        LayerId component_layer             = m_layer_config.GetLayerIdForComponent(_component_id);
+        auto current_component_layer_worker = m_world_controller->GetEntityWorkerForLayer(_entity, component_layer);
+
+        return current_component_layer_worker && current_component_layer_worker.value()->GetId() == _ignore_worker.value();
     };
 
-    ProcessQueryInstruction(*_query.root_query);
+    // Return the entity if it exists and its distance band is due on this evaluation, entities inside bands 
+    // that aren't due are left for a later one
+    auto ResolveEntity = [&](EntityId _entity_id, float& _out_distance) -> const ServerEntity*
+    {
+        auto selected_entity = m_database.GetEntityById(_entity_id);
+        if (!selected_entity)
+        {
+            return nullptr;
+        }
+
+        const ServerEntity* entity = selected_entity.value();
+
+        _out_distance = glm::distance(glm::vec2(_search_center_location), glm::vec2(entity->GetWorldPosition()));
+
+        if (_query.distance_bands.size() > 0)
+        {
+            uint32_t band_index = _query.GetDistanceBandIndex(_out_distance);
+            if (!(_due_distance_bands_mask & (1u << band_index)))
+            {
+                return nullptr;
+            }
+        }
+
+        return entity;
+    };
 
-    for (auto& [entity_id, entity] : selected_entities)
+    auto AppendEntity = [&](const ServerEntity* _entity)
     {
-        std::pair<ComponentMask, nonstd::transient_vector<const ComponentPayload*>> entry;
-        entry.first = entity->GetComponentMask();
+        ComponentQueryResultEntry entry;
+        entry.entity                = _entity;
+        entry.entity_component_mask = _entity->GetComponentMask();
 
         for (const auto& requested_component_id : bitset::indices_on(_query.component_mask))
         {
             // Check if we should ignore this
-            LayerId component_layer             = m_layer_config.GetLayerIdForComponent(requested_component_id);
-            auto current_component_layer_worker = m_world_controller->GetWorldCellInfo(entity->GetWorldCellCoordinates()).GetWorkerForLayer(component_layer);
-            if (_ignore_worker 
-                && current_component_layer_worker 
-                && current_component_layer_worker.value()->GetId() == _ignore_worker.value())
+            if (IsComponentIgnored(*_entity, requested_component_id))
             {
                 continue;
             }
 
-            if (entity->HasComponent(requested_component_id))
+            if (_entity->HasComponent(requested_component_id))
             {
-                entry.second.push_back(&entity->GetComponentPayload(requested_component_id));
+                entry.component_payloads.push_back(&_entity->GetComponentPayload(requested_component_id));
             }
         }
 
         query_result.push_back(std::move(entry));
+    };
+
+    if (_query.max_results > 0 && selected_entities.GetCardinality() > _query.max_results)
+    {
+        // Partial selection: keep only the nearest max_results entities on a max-heap (by distance from the query
+        // center) while iterating, result entries are built only for the ones that survive
+        using NearestEntry = std::pair<float, const ServerEntity*>;
+
+        auto IsNearer = [](const NearestEntry& _first, const NearestEntry& _second) -> bool
+        {
+            return _first.first < _second.first;
+        };
+
+        nonstd::transient_vector<NearestEntry> nearest_entities;
+        nearest_entities.reserve(_query.max_results);
+
+        selected_entities.ForEach(
+            [&](EntityId _entity_id)
+            {
+                float distance = 0.0f;
+                auto  entity   = ResolveEntity(_entity_id, distance);
+                if (!entity)
+                {
+                    return;
+                }
+
+                if (nearest_entities.size() == _query.max_results && distance >= nearest_entities.front().first)
+                {
+                    return;
+                }
+
+                // Entities that would be returned without any component shouldn't take a slot
+                bool has_requested_component = false;
+                for (const auto& requested_component_id : bitset::indices_on(_query.component_mask & entity->GetComponentMask()))
+                {
+                    if (!IsComponentIgnored(*entity, requested_component_id))
+                    {
+                        has_requested_component = true;
+                        break;
+                    }
+                }
+
+                if (!has_requested_component)
+                {
+                    return;
+                }
+
+                if (nearest_entities.size() == _query.max_results)
+                {
+                    std::pop_heap(nearest_entities.begin(), nearest_entities.end(), IsNearer);
+                    nearest_entities.pop_back();
+                }
+
+                nearest_entities.push_back({ distance, entity });
+                std::push_heap(nearest_entities.begin(), nearest_entities.end(), IsNearer);
+            });
+
+        std::sort_heap(nearest_entities.begin(), nearest_entities.end(), IsNearer);
+
+        query_result.reserve(nearest_entities.size());
+        for (auto& [distance, entity] : nearest_entities)
+        {
+            AppendEntity(entity);
+        }
+    }
+    else
+    {
+        query_result.reserve(static_cast<size_t>(selected_entities.GetCardinality()));
+        selected_entities.ForEach(
+            [&](EntityId _entity_id)
+            {
+                float distance = 0.0f;
+                auto  entity   = ResolveEntity(_entity_id, distance);
+                if (entity)
+                {
+                    AppendEntity(entity);
+                }
+            });
+    }
+
+    return std::move(query_result);
+}
+
+nonstd::transient_vector<Jani::ComponentQueryResultEntry> Jani::Runtime::PerformWorkerInterestQuery(
+    const RuntimeWorkerReference& _worker_instance,
+    const WorkerInterest&         _interest) const
+{
+    nonstd::transient_vector<ComponentQueryResultEntry> query_result;
+
+    if (!_interest.IsValid())
+    {
+        return std::move(query_result);
+    }
+
+    // Regions can overlap (owned cells margin and rects), make sure each entity is selected only once
+    nonstd::transient_unordered_set<EntityId> selected_entity_ids;
+
+    auto SelectEntity = [&](EntityId _entity_id, ServerEntity& _entity, WorldCellCoordinates _cell_coordinates) -> void
+    {
+        if ((_entity.GetComponentMask() & _interest.required_component_mask) != _interest.required_component_mask
+            || !selected_entity_ids.insert(_entity_id).second)
+        {
+            return;
+        }
+
+        ComponentQueryResultEntry entry;
+        entry.entity                = &_entity;
+        entry.entity_component_mask = _entity.GetComponentMask();
+
+        for (const auto& requested_component_id : bitset::indices_on(_interest.component_mask))
+        {
+            if (!_entity.HasComponent(requested_component_id))
+            {
+                continue;
+            }
+
+            // The worker already has the data for the components it owns
+            auto component_layer_worker = m_world_controller->GetEntityWorkerForLayer(_entity, m_layer_config.GetLayerIdForComponent(requested_component_id));
+            if (component_layer_worker && component_layer_worker.value()->GetId() == _worker_instance.GetId())
+            {
+                continue;
+            }
+
+            entry.component_payloads.push_back(&_entity.GetComponentPayload(requested_component_id));
+        }
+
+        if (entry.component_payloads.size() > 0)
+        {
+            query_result.push_back(std::move(entry));
+        }
+    };
+
+    if (_interest.include_owned_cells)
+    {
+        m_world_controller->ForEachEntityOnWorkerCells(_worker_instance, _interest.owned_cells_margin, SelectEntity);
+    }
+
+    for (auto& world_rect : _interest.world_rects)
+    {
+        m_world_controller->ForEachEntityOnRect(world_rect, SelectEntity);
     }
 
     return std::move(query_result);
@@ -8,6 +8,8 @@
 //////////////
 #include "JaniInternal.h"
 #include "JaniRuntimeThreadContext.h"
+#include "JaniRuntimeEntityQueryController.h"
+#include "JaniRuntimeComponentPayloadCache.h"
 
 ///////////////
 // NAMESPACE //
@@ -19,241 +21,32 @@ JaniNamespaceBegin(Jani)
 class RuntimeWorldController;
 class RuntimeWorkerReference;
 
-struct EntityQueryController
+/*
+* An entity selected by a component query together with the requested component payloads
+*/
+struct ComponentQueryResultEntry
 {
-    struct QueryInfo
-    {
-        EntityId     entity_id     = std::numeric_limits<EntityId>::max();
-        ComponentId  component_id  = std::numeric_limits<ComponentId>::max();
-        uint32_t     query_version = std::numeric_limits<uint32_t>::max();
-        mutable bool is_outdated   = false;
-    };
-
-    void InsertQuery(EntityId _entity_id, ComponentId _component_id, QueryUpdateFrequency _update_frequency, uint32_t _query_version)
-    {
-        /*
-        if (magic_enum::enum_integer(_update_frequency) > magic_enum::enum_integer(QueryUpdateFrequency::Max)
-            || !magic_enum::enum_index(_update_frequency).has_value())
-        {
-            return;
-        }
-        */
-
-        auto GetListIndexForFrequencyEnum = [](QueryUpdateFrequency _frequency_enum) -> uint32_t
-        {
-            switch (_frequency_enum)
-            {
-            case QueryUpdateFrequency::_50: return 0;
-            case QueryUpdateFrequency::_40: return 1;
-            case QueryUpdateFrequency::_30: return 2;
-            case QueryUpdateFrequency::_20: return 3;
-            case QueryUpdateFrequency::_10: return 4;
-            case QueryUpdateFrequency::_5: return 5;
-            default: return 6;
-            }
-        };
-
-        QueryInfo new_entry;
-        new_entry.entity_id     = _entity_id;
-        new_entry.component_id  = _component_id;
-        new_entry.query_version = _query_version;
-
-        uint32_t list_entry_index = GetListIndexForFrequencyEnum(_update_frequency);
-        auto&     free_list       = free_lists[list_entry_index];
-        safety.lock();
-        if (free_list.size() > 0)
-        {
-            auto infos_index = free_list.back();
-            free_list.pop_back();
-            safety.unlock();
-
-            query_infos[list_entry_index][infos_index] = std::move(new_entry);
-        }
-        else
-        {
-            query_infos[list_entry_index].push_back(std::move(new_entry));
-            safety.unlock();
-        }
-    }
-
-    void ForEach(std::function<void(QueryInfo&)> _callback)
-    {
-        auto time_now         = std::chrono::steady_clock::now();
-        uint64_t elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(time_now - initial_timestamp).count();
-
-        auto GetFrequencyFromEnum = [](QueryUpdateFrequency _frequency_enum) -> uint32_t
-        {
-            switch (static_cast<uint32_t>(_frequency_enum))
-            {
-                case 0: return 50;
-                case 1: return 40;
-                case 2: return 30;
-                case 3: return 20;
-                case 4: return 10;
-                case 5: return 5;
-                default: return 1;
-            }
-        };
-
-        for (int i = 0; i < query_infos.size(); i++)
-        {
-            uint32_t required_elapsed_time = 1000 / GetFrequencyFromEnum(static_cast<QueryUpdateFrequency>(i));
-
-            if (elapsed_time / required_elapsed_time <= previous_elapsed_time / required_elapsed_time)
-            {
-                continue;
-            }
-
-            for (int info_index = 0; info_index < query_infos[i].size(); info_index++)
-            {
-                if (query_infos[i][info_index])
-                {
-                    if (query_infos[i][info_index]->is_outdated)
-                    {
-                        auto& free_list = free_lists[i];
-                        {
-                            std::lock_guard l(safety);
-                            free_list.push_back(info_index);
-                        }
-                        query_infos[i][info_index] = std::nullopt;
-                    }
-                    else
-                    {
-                        _callback(*query_infos[i][info_index]);
-                    }
-                }
-            }
-        }
-
-        previous_elapsed_time = elapsed_time;
-    }
-
-
-    std::array<std::vector<std::optional<QueryInfo>>, magic_enum::enum_integer(QueryUpdateFrequency::Count)> query_infos;
-    std::array<std::vector<uint32_t>, magic_enum::enum_integer(QueryUpdateFrequency::Count)>                 free_lists;
-    std::chrono::time_point<std::chrono::steady_clock>                                                       initial_timestamp     = std::chrono::steady_clock::now();
-    uint64_t                                                                                                 previous_elapsed_time = 0;
-    std::mutex                                                                                               safety;
-
-#if 0
-
-    /*
-    *
-    * Linked list implementation
-    *
-    */
-
-    struct QueryInfo
-    {
-        EntityId                   entity_id    = std::numeric_limits<EntityId>::max();
-        ComponentId                component_id = std::numeric_limits<ComponentId>::max();
-
-        std::unique_ptr<QueryInfo> next;
-        QueryInfo*                 previous     = nullptr;
-    };
+    const ServerEntity*                               entity = nullptr;
+    ComponentMask                                     entity_component_mask;
+    nonstd::transient_vector<const ComponentPayload*> component_payloads;
+};
 
-    void InsertQuery(EntityId _entity_id, ComponentId _component_id, QueryUpdateFrequency _update_frequency)
-    {
-        if (magic_enum::enum_integer(_update_frequency) > magic_enum::enum_integer(QueryUpdateFrequency::Max)
-            || !magic_enum::enum_index(_update_frequency).has_value())
-        {
-            return;
-        }
-
-        std::unique_ptr<QueryInfo> new_query_info;
-        if (free_nodes.size() > 0)
-        {
-            new_query_info = std::move(free_nodes.back());
-            free_nodes.pop_back();
-        }
-        else
-        {
-            new_query_info = std::make_unique<QueryInfo>();
-        }
-
-        new_query_info->entity_id    = _entity_id;
-        new_query_info->component_id = _component_id;
-        new_query_info->previous     = nullptr;
-
-        uint32_t list_entry_index = magic_enum::enum_index(_update_frequency).value();
-
-        if (query_infos[list_entry_index])
-        {
-            new_query_info->next = std::move(query_infos[list_entry_index]);
-            new_query_info->next->previous = new_query_info.get();
-        }
-
-        query_infos[list_entry_index] = std::move(new_query_info);
-    }
-
-    void ForEach(std::function<bool(EntityId, ComponentId)> _callback)
-    {
-        auto time_now         = std::chrono::steady_clock::now();
-        uint64_t elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(time_now - initial_timestamp).count();
-
-        for (int i = 0; i < query_infos.size(); i++)
-        {
-            if (query_infos[i] == nullptr)
-            {
-                continue;
-            }
-
-            uint32_t frequency = magic_enum::enum_integer(magic_enum::enum_value<QueryUpdateFrequency>(i));
-
-            if (elapsed_time / frequency > previous_elapsed_time / frequency)
-            {
-                QueryInfo* current_node = query_infos[i].get();
-                while (current_node != nullptr)
-                {
-                    bool result = _callback(current_node->entity_id, current_node->component_id);
-                    if (!result)
-                    {
-                        // Root
-                        if (current_node->previous == nullptr)
-                        {
-                            auto temp = std::move(query_infos[i]);
-                            query_infos[i] = std::move(temp->next);
-                            current_node = nullptr;
-                            if (query_infos[i])
-                            {
-                                query_infos[i]->previous = nullptr;
-                                current_node = query_infos[i].get();
-                            }
-
-                            free_nodes.push_back(std::move(temp));
-                        }
-                        else
-                        {
-                            auto temp = std::move(current_node->previous->next);
-                            current_node->previous->next = std::move(temp->next);
-                            current_node = nullptr;
-                            if (temp->next)
-                            {
-                                temp->next->previous = temp->previous;
-                                current_node = temp->next.get();
-                            }
-
-                            free_nodes.push_back(std::move(temp));
-                        }
-                    }
-                    else
-                    {
-                        current_node = current_node->next ? current_node->next.get() : nullptr;
-                    }
-                }
-            }
-        }
-
-        previous_elapsed_time = elapsed_time;
-    }
-
-
-    std::array<std::unique_ptr<QueryInfo>, magic_enum::enum_integer(QueryUpdateFrequency::Count)> query_infos;
-    std::vector<std::unique_ptr<QueryInfo>>                                                       free_nodes;
-    std::chrono::time_point<std::chrono::steady_clock>                                            initial_timestamp     = std::chrono::steady_clock::now();
-    uint64_t                                                                                      previous_elapsed_time = 0;
-
-#endif
+/*
+* Authority handoff counters, the latency is the time between announcing a handoff to both workers (or the
+* entity crossing into a pre staged one) and flipping the authority to the new one
+*/
+struct AuthorityHandoffCounters
+{
+    uint64_t total_handoffs             = 0;
+    uint64_t total_forced_handoffs      = 0; // Flipped because the new worker didn't acknowledge in time
+    uint64_t total_cancelled_handoffs   = 0; // The entity moved again before the handoff completed
+    uint64_t total_predicted_handoffs   = 0; // Pre staged because the entity was predicted to cross into the new worker
+    uint64_t total_predicted_hits       = 0; // The entity crossed into an acknowledged pre staged handoff, flipped immediately
+    uint64_t total_predicted_misses     = 0; // Pre staged handoffs dropped because the entity didn't cross in time
+    uint32_t pending_handoffs           = 0;
+    uint32_t last_handoff_latency_ms    = 0;
+    uint32_t average_handoff_latency_ms = 0;
+    uint32_t maximum_handoff_latency_ms = 0;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -263,6 +56,46 @@ class Runtime
 {
     friend RuntimeBridge;
 
+    /*
+    * An entity layer being handed off between two workers, the current worker keeps the authority (and the
+    * new one receives its updates) until the new worker acknowledges it has the entity state
+    * A predicted handoff is pre staged on the worker the entity is about to move into, it never flips by itself,
+    * only when the entity actually crosses (immediately if it was already acknowledged)
+    */
+    struct AuthorityHandoff
+    {
+        WorkerId                                           current_worker_id = std::numeric_limits<WorkerId>::max();
+        WorkerId                                           new_worker_id     = std::numeric_limits<WorkerId>::max();
+        std::chrono::time_point<std::chrono::steady_clock> start_timestamp   = std::chrono::steady_clock::now();
+        bool                                               is_predicted      = false;
+        bool                                               is_acknowledged   = false;
+        bool                                               is_state_stale    = false; // A component failed to stream, restart it
+    };
+
+    /*
+    * Time (in milliseconds) the new worker has to acknowledge a handoff before the authority is forced into it
+    */
+    static const uint32_t AuthorityHandoffTimeout = 500;
+
+    /*
+    * Encoded size budget of a single cell migration message, leaving room on the connection datagram
+    * for the request header and the vector sizes
+    */
+    static const uint32_t MaximumCellMigrationMessageSize = Connection<>::MaximumDatagramSize - 128;
+
+    /*
+    * Largest component payload that can be sent to a worker, either encoded on a cell migration message or on
+    * its own request, bigger components never fit a datagram
+    */
+    static const uint32_t MaximumComponentDataSize = MaximumCellMigrationMessageSize - sizeof(EntityId) - sizeof(uint8_t) * 2 - sizeof(ComponentId) - sizeof(uint16_t);
+    static_assert(MaximumComponentDataSize <= std::numeric_limits<uint16_t>::max(), "Cell migration component sizes are encoded as 16 bits");
+
+    /*
+    * Entities that must receive the same authority change, grouped by the worker that receives them and
+    * whether the entity layer components must go along
+    */
+    using AuthorityChangeBatch = std::map<std::tuple<WorkerId, RequestType, bool>, std::vector<EntityId>>;
+
 //////////////////////////
 public: // CONSTRUCTORS //
 //////////////////////////
@@ -288,6 +121,18 @@ public: // MAIN METHODS //
     */
     void Update();
 
+    /*
+    * Return the query budget counters, useful to monitor if the runtime is
+    * degrading query frequencies because of load
+    */
+    EntityQueryController::QueryBudgetCounters GetQueryBudgetCounters() const;
+
+    /*
+    * Return the authority handoff counters, useful to monitor how long entities take to
+    * change workers at cell boundaries
+    */
+    AuthorityHandoffCounters GetAuthorityHandoffCounters() const;
+
 private:
 
     /*
@@ -301,6 +146,71 @@ private:
         Connection<>::ClientHash _client_hash, 
         WorkerType               _type);
 
+    /*
+    * Return the worker that currently holds the authority over the given entity layer, while a handoff is
+    * pending that is still the previous owner even if the entity is already on a cell of the new one
+    */
+    std::optional<WorkerId> GetAuthoritativeWorkerId(
+        const ServerEntity& _entity,
+        LayerId             _layer_id) const;
+
+    /*
+    * Start handing off the given entity layers from the current to the new worker, the current worker is told
+    * its authority loss is imminent and the new one receives the entities state, the authority only flips when
+    * the new worker acknowledges it
+    * If there is no worker on one of the sides (dummy worker) the authority changes immediately
+    */
+    void BeginAuthorityHandoff(
+        const std::vector<EntityId>&  _entity_ids,
+        LayerId                       _layer_id,
+        const RuntimeWorkerReference* _current_worker,
+        const RuntimeWorkerReference* _new_worker);
+
+    /*
+    * Pre stage a handoff of the given entity layer on the worker it's predicted to move into, that worker receives
+    * the entity state (and its updates from now on) while the current worker keeps the authority
+    * Predictions are ignored while a handoff caused by an actual ownership change is pending
+    */
+    void PredictAuthorityHandoff(
+        EntityId                      _entity_id,
+        LayerId                       _layer_id,
+        const RuntimeWorkerReference& _current_worker,
+        const RuntimeWorkerReference& _predicted_worker);
+
+    /*
+    * Flip the authority of a pending handoff to its new worker, the messages are added to the given batch
+    */
+    void CompleteAuthorityHandoff(
+        EntityId                _entity_id,
+        const AuthorityHandoff& _handoff,
+        bool                    _forced,
+        AuthorityChangeBatch&   _authority_changes);
+
+    /*
+    * Forward a component change of an entity layer being handed off to the worker that is about to receive it,
+    * if it can't be sent the handoff is restarted on the next update so that worker gets the whole state again
+    */
+    void StreamAuthorityHandoffComponent(
+        EntityId                _entity_id,
+        LayerId                 _layer_id,
+        ComponentId             _component_id,
+        const ComponentPayload& _component_payload);
+
+    /*
+    * Complete handoffs that timed out, or that involve the given disconnected worker
+    * Predicted handoffs are dropped instead once they outlive twice the prediction horizon without a refresh
+    * Handoffs with a stale state are restarted, keeping their start time so they are still forced on timeout
+    */
+    void UpdateAuthorityHandoffs(std::optional<WorkerId> _disconnected_worker_id = std::nullopt);
+
+    /*
+    * Send a batch of authority changes on the given layer as cell migration messages, each message carries
+    * as many entities (and their layer components, if required) as fit on a single datagram
+    */
+    void SendAuthorityChanges(
+        const AuthorityChangeBatch& _authority_changes,
+        LayerId                     _layer_id);
+
 /////////////////////////////////////
 protected: // WORKER COMMUNICATION //
 /////////////////////////////////////
@@ -381,16 +291,49 @@ protected: // WORKER COMMUNICATION //
         EntityId                    _entity_id,
         ComponentId                 _component_id,
         std::vector<ComponentQuery> _component_queries);
+
+    /*
+    * Received when a worker request to update its interest regions
+    */
+    bool OnWorkerInterestUpdate(
+        RuntimeWorkerReference&     _worker_instance,
+        WorkerId                    _worker_id,
+        std::vector<WorkerInterest> _interests);
+
+    /*
+    * Received when a worker request to perform an aggregate query
+    */
+    std::optional<AggregateQueryResult> OnWorkerAggregateQuery(
+        RuntimeWorkerReference& _worker_instance,
+        WorkerId                _worker_id,
+        const AggregateQuery&   _query);
+
+    /*
+    * Received when a worker that is about to gain authority over an entity received its state
+    */
+    bool OnWorkerLayerAuthorityHandoffAcknowledge(
+        RuntimeWorkerReference&      _worker_instance,
+        WorkerId                     _worker_id,
+        const std::vector<EntityId>& _entity_ids);
     
 private:
 
     /*
     * Perform a component query, optionally it can ignore entities owned by the given worker
+    * If the query has distance bands, only entities inside the bands set on the due mask are returned
     */
-    nonstd::transient_vector<std::pair<Jani::ComponentMask, nonstd::transient_vector<const Jani::ComponentPayload*>>> PerformComponentQuery(
+    nonstd::transient_vector<ComponentQueryResultEntry> PerformComponentQuery(
         const ComponentQuery&   _query, 
         WorldPosition           _search_center_location, 
-        std::optional<WorkerId> _ignore_worker = std::nullopt) const;
+        std::optional<WorkerId> _ignore_worker           = std::nullopt, 
+        uint32_t                _due_distance_bands_mask = std::numeric_limits<uint32_t>::max()) const;
+
+    /*
+    * Perform a worker interest query, entity components owned by the worker itself are ignored
+    */
+    nonstd::transient_vector<ComponentQueryResultEntry> PerformWorkerInterestQuery(
+        const RuntimeWorkerReference& _worker_instance,
+        const WorkerInterest&         _interest) const;
 
     /*
     * Perform a quick check if there is an active worker layer that accepts the
@@ -426,6 +369,11 @@ private: // VARIABLES //
     std::unordered_map<Connection<>::ClientHash, RuntimeWorkerReference*> m_worker_instance_mapping;
 
     EntityQueryController m_entity_query_controller;
+    ComponentPayloadCache m_component_payload_cache;
+
+    std::map<std::pair<EntityId, LayerId>, AuthorityHandoff> m_pending_handoffs;
+    AuthorityHandoffCounters                                 m_handoff_counters;
+    uint64_t                                                 m_total_handoff_latency_ms = 0;
 };
 
 // Jani
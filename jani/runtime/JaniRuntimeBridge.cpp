@@ -211,4 +211,37 @@ bool Jani::RuntimeBridge::OnWorkerComponentInterestQueryUpdate(
         _entity_id,
         _component_id,
         std::move(_component_queries));
+}
+
+bool Jani::RuntimeBridge::OnWorkerInterestUpdate(
+    RuntimeWorkerReference&     _worker_instance,
+    WorkerId                    _worker_id,
+    std::vector<WorkerInterest> _interests)
+{
+    return m_runtime.OnWorkerInterestUpdate(
+        _worker_instance,
+        _worker_id,
+        std::move(_interests));
+}
+
+std::optional<Jani::AggregateQueryResult> Jani::RuntimeBridge::OnWorkerAggregateQuery(
+    RuntimeWorkerReference& _worker_instance,
+    WorkerId                _worker_id,
+    const AggregateQuery&   _query)
+{
+    return m_runtime.OnWorkerAggregateQuery(
+        _worker_instance,
+        _worker_id,
+        _query);
+}
+
+bool Jani::RuntimeBridge::OnWorkerLayerAuthorityHandoffAcknowledge(
+    RuntimeWorkerReference&      _worker_instance,
+    WorkerId                     _worker_id,
+    const std::vector<EntityId>& _entity_ids)
+{
+    return m_runtime.OnWorkerLayerAuthorityHandoffAcknowledge(
+        _worker_instance,
+        _worker_id,
+        _entity_ids);
 }
\ No newline at end of file
@@ -195,7 +195,29 @@ private: // WORKER -> BRIDGE COMMUNICATION //
         ComponentId                 _component_id,
         std::vector<ComponentQuery> _component_queries);
 
-    //         std::optional<bool>          _authority_loss_imminent_acknowledgement, 
+    /*
+    * Received when a worker request to update its interest regions
+    */
+    bool OnWorkerInterestUpdate(
+        RuntimeWorkerReference&     _worker_instance,
+        WorkerId                    _worker_id,
+        std::vector<WorkerInterest> _interests);
+
+    /*
+    * Received when a worker request to perform an aggregate query
+    */
+    std::optional<AggregateQueryResult> OnWorkerAggregateQuery(
+        RuntimeWorkerReference& _worker_instance,
+        WorkerId                _worker_id,
+        const AggregateQuery&   _query);
+
+    /*
+    * Received when a worker that is about to gain authority over an entity received its state
+    */
+    bool OnWorkerLayerAuthorityHandoffAcknowledge(
+        RuntimeWorkerReference&      _worker_instance,
+        WorkerId                     _worker_id,
+        const std::vector<EntityId>& _entity_ids);
 
 /////////////////////////////////////////////
 private: // BRIDGE -> WORKER COMMUNICATION //
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: JaniRuntimeComponentPayloadCache.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "JaniRuntimeComponentPayloadCache.h"
+
+Jani::ComponentPayloadCache::ComponentPayloadCache(const LayerConfig& _layer_config)
+    : m_layer_config(_layer_config)
+{
+}
+
+Jani::ComponentPayloadCache::~ComponentPayloadCache()
+{
+}
+
+const std::vector<char>& Jani::ComponentPayloadCache::GetOrEncode(const ComponentPayload& _component_payload, uint32_t _component_version, uint64_t _projection_mask)
+{
+    CacheKey cache_key;
+    cache_key.entity_id         = _component_payload.entity_owner;
+    cache_key.component_id      = _component_payload.component_id;
+    cache_key.component_version = _component_version;
+    cache_key.projection_mask   = _projection_mask;
+
+    auto&           shard = m_shards[CacheKeyHasher()(cache_key) % TotalShards];
+    std::lock_guard l(shard.safety);
+
+    auto iter = shard.encoded_payloads.find(cache_key);
+    if (iter != shard.encoded_payloads.end())
+    {
+        m_total_hits++;
+        return *iter->second;
+    }
+
+    std::array<char, Connection<>::MaximumDatagramSize> temporary_buffer;
+    StreamVectorWrap<char>                              data_buffer(temporary_buffer);
+    std::ostream                                        out_stream(&data_buffer);
+
+    {
+        cereal::BinaryOutputArchive archive(out_stream);
+
+        auto partial_payload = _projection_mask != 0 ? BuildPartialPayload(_component_payload, _projection_mask) : std::nullopt;
+        if (partial_payload)
+        {
+            archive(partial_payload.value());
+        }
+        else
+        {
+            archive(_component_payload);
+        }
+    }
+
+    auto encoded_payload = std::make_unique<std::vector<char>>(temporary_buffer.data(), temporary_buffer.data() + static_cast<size_t>(out_stream.tellp()));
+    auto& result         = *encoded_payload;
+
+    shard.encoded_payloads.insert({ cache_key, std::move(encoded_payload) });
+    m_total_encoded++;
+
+    return result;
+}
+
+std::optional<Jani::ComponentPayload> Jani::ComponentPayloadCache::BuildPartialPayload(const ComponentPayload& _component_payload, uint64_t _projection_mask) const
+{
+    auto component_attributes = m_layer_config.GetComponentAttributes(_component_payload.component_id);
+    if (!component_attributes || _component_payload.is_partial)
+    {
+        return std::nullopt;
+    }
+
+    ComponentPayload partial_payload;
+    partial_payload.entity_owner = _component_payload.entity_owner;
+    partial_payload.component_id = _component_payload.component_id;
+    partial_payload.is_partial   = true;
+
+    for (uint32_t i = 0; i < component_attributes->size() && i < 64; i++)
+    {
+        auto& component_attribute = (*component_attributes)[i];
+        if (!(_projection_mask & (uint64_t(1) << i)))
+        {
+            continue;
+        }
+
+        // Attributes without a fixed offset can't be projected, fallback to sending the full component
+        uint32_t attribute_size = LayerConfig::GetAttributeTypeSize(component_attribute.type);
+        if (!component_attribute.offset 
+            || attribute_size == 0
+            || component_attribute.offset.value() + attribute_size > _component_payload.component_data.size())
+        {
+            return std::nullopt;
+        }
+
+        uint16_t segment_offset = static_cast<uint16_t>(component_attribute.offset.value());
+        uint16_t segment_size   = static_cast<uint16_t>(attribute_size);
+        auto&    component_data = partial_payload.component_data;
+        size_t   current_size   = component_data.size();
+
+        component_data.resize(current_size + sizeof(uint16_t) * 2 + segment_size);
+        std::memcpy(component_data.data() + current_size, &segment_offset, sizeof(uint16_t));
+        std::memcpy(component_data.data() + current_size + sizeof(uint16_t), &segment_size, sizeof(uint16_t));
+        std::memcpy(component_data.data() + current_size + sizeof(uint16_t) * 2, _component_payload.component_data.data() + segment_offset, segment_size);
+    }
+
+    return std::move(partial_payload);
+}
+
+void Jani::ComponentPayloadCache::Clear()
+{
+    for (auto& shard : m_shards)
+    {
+        std::lock_guard l(shard.safety);
+        shard.encoded_payloads.clear();
+    }
+
+    m_total_encoded = 0;
+    m_total_hits    = 0;
+}
+
+uint32_t Jani::ComponentPayloadCache::GetTotalEncoded() const
+{
+    return m_total_encoded;
+}
+
+uint32_t Jani::ComponentPayloadCache::GetTotalHits() const
+{
+    return m_total_hits;
+}
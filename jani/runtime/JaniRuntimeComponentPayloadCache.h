@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: JaniRuntimeComponentPayloadCache.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include "JaniInternal.h"
+
+///////////////
+// NAMESPACE //
+///////////////
+
+// Jani
+JaniNamespaceBegin(Jani)
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: ComponentPayloadCache
+////////////////////////////////////////////////////////////////////////////////
+class ComponentPayloadCache
+{
+    /*
+    * Number of independent maps (each with its own mutex) used to reduce contention when
+    * multiple query tasks are encoding payloads at the same time
+    */
+    static const uint32_t TotalShards = 16;
+
+    struct CacheKey
+    {
+        EntityId    entity_id         = std::numeric_limits<EntityId>::max();
+        ComponentId component_id      = std::numeric_limits<ComponentId>::max();
+        uint32_t    component_version = 0;
+        uint64_t    projection_mask   = 0;
+
+        bool operator==(const CacheKey& _other) const
+        {
+            return entity_id == _other.entity_id && component_id == _other.component_id && component_version == _other.component_version && projection_mask == _other.projection_mask;
+        }
+    };
+
+    struct CacheKeyHasher
+    {
+        std::size_t operator()(const CacheKey& _key) const
+        {
+            return std::hash<EntityId>()(_key.entity_id) ^ (std::hash<ComponentId>()(_key.component_id) << 1) ^ (std::hash<uint32_t>()(_key.component_version) << 7) ^ (std::hash<uint64_t>()(_key.projection_mask) << 13);
+        }
+    };
+
+    struct Shard
+    {
+        std::mutex                                                                       safety;
+        std::unordered_map<CacheKey, std::unique_ptr<std::vector<char>>, CacheKeyHasher> encoded_payloads;
+    };
+
+//////////////////////////
+public: // CONSTRUCTORS //
+//////////////////////////
+
+    ComponentPayloadCache(const LayerConfig& _layer_config);
+    ~ComponentPayloadCache();
+
+//////////////////////////
+public: // MAIN METHODS //
+//////////////////////////
+
+    /*
+    * Return the encoded buffer for the given component payload and version, encoding it if this is
+    * the first time it was requested since the last Clear() call
+    * If a projection mask is provided (bit i set for the schema attribute i) a partial payload with only those
+    * attributes is encoded instead, each projection is cached independently
+    * The returned reference is valid until Clear() is called, this method is thread safe
+    */
+    const std::vector<char>& GetOrEncode(const ComponentPayload& _component_payload, uint32_t _component_version, uint64_t _projection_mask = 0);
+
+    /*
+    * Release all encoded payloads, should be called once per frame after all messages that
+    * reference the encoded buffers were sent
+    */
+    void Clear();
+
+    /*
+    * Return the number of payloads encoded and the number of cache hits since the last Clear() call
+    */
+    uint32_t GetTotalEncoded() const;
+    uint32_t GetTotalHits()    const;
+
+private:
+
+    /*
+    * Build a partial payload containing only the attributes set on the projection mask
+    */
+    std::optional<ComponentPayload> BuildPartialPayload(const ComponentPayload& _component_payload, uint64_t _projection_mask) const;
+
+////////////////////////
+private: // VARIABLES //
+////////////////////////
+
+    const LayerConfig&             m_layer_config;
+    std::array<Shard, TotalShards> m_shards;
+    std::atomic<uint32_t>          m_total_encoded = 0;
+    std::atomic<uint32_t>          m_total_hits    = 0;
+};
+
+// Jani
+JaniNamespaceEnd(Jani)
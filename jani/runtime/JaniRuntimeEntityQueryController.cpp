@@ -0,0 +1,317 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: JaniRuntimeEntityQueryController.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "JaniRuntimeEntityQueryController.h"
+
+Jani::EntityQueryController::EntityQueryController()
+{
+    for (uint32_t i = 0; i < TotalBuckets; i++)
+    {
+        m_query_wheels[i].resize(GetBucketPeriod(i));
+    }
+}
+
+Jani::EntityQueryController::~EntityQueryController()
+{
+}
+
+void Jani::EntityQueryController::InsertQuery(EntityId _entity_id, ComponentId _component_id, QueryUpdateFrequency _update_frequency, uint32_t _query_version)
+{
+    std::lock_guard l(m_safety);
+
+    uint32_t bucket_index = GetBucketIndexForFrequency(_update_frequency);
+
+    // If this entity component is already scheduled on the same bucket, just replace it in place, keeping
+    // its phase so the load distribution doesn't change
+    auto location_iter = m_query_locations.find({ _entity_id, _component_id });
+    if (location_iter != m_query_locations.end())
+    {
+        auto& location   = location_iter->second;
+        auto& query_info = m_query_wheels[location.bucket_index][location.slot_index][location.entry_index];
+        if (query_info.requested_bucket_index == bucket_index)
+        {
+            query_info.query_version = _query_version;
+            query_info.is_outdated   = false;
+            return;
+        }
+
+        RemoveQueryAtLocation(location);
+        m_query_locations.erase(location_iter);
+    }
+
+    QueryInfo new_entry;
+    new_entry.entity_id              = _entity_id;
+    new_entry.component_id           = _component_id;
+    new_entry.query_version          = _query_version;
+    new_entry.requested_bucket_index = bucket_index;
+
+    PushQueryIntoBucket(std::move(new_entry), bucket_index);
+}
+
+void Jani::EntityQueryController::ForEach(std::function<void(QueryInfo&)> _callback)
+{
+    auto time_now         = std::chrono::steady_clock::now();
+    uint64_t elapsed_time = std::chrono::duration_cast<std::chrono::milliseconds>(time_now - m_initial_timestamp).count();
+
+    m_current_frame++;
+    m_processed_slots.clear();
+
+    auto ProcessQuery = [&](QueryInfo& _query_info)
+    {
+        if (_query_info.scheduled_frame == m_current_frame)
+        {
+            return;
+        }
+
+        _query_info.scheduled_frame          = m_current_frame;
+        _query_info.previous_evaluation_time = _query_info.evaluation_time;
+        _query_info.evaluation_time          = elapsed_time;
+        _callback(_query_info);
+    };
+
+    // Queries that couldn't be evaluated on the previous frame go first
+    for (auto& query_key : m_carried_over_queries)
+    {
+        auto location_iter = m_query_locations.find(query_key);
+        if (location_iter == m_query_locations.end())
+        {
+            continue;
+        }
+
+        auto& location = location_iter->second;
+        m_processed_slots.push_back({ location.bucket_index, location.slot_index });
+
+        ProcessQuery(m_query_wheels[location.bucket_index][location.slot_index][location.entry_index]);
+    }
+
+    m_carried_over_queries.clear();
+
+    for (uint32_t i = 0; i < TotalBuckets; i++)
+    {
+        auto&    wheel        = m_query_wheels[i];
+        uint64_t wheel_length = wheel.size();
+        uint64_t total_ticks  = std::min(elapsed_time - m_previous_elapsed_time, wheel_length);
+
+        for (uint64_t tick = elapsed_time - total_ticks + 1; tick <= elapsed_time; tick++)
+        {
+            uint32_t slot_index = static_cast<uint32_t>(tick % wheel_length);
+            if (wheel[slot_index].size() == 0)
+            {
+                continue;
+            }
+
+            m_processed_slots.push_back({ i, slot_index });
+
+            for (auto& query_info : wheel[slot_index])
+            {
+                ProcessQuery(query_info);
+            }
+        }
+    }
+
+    m_previous_elapsed_time = elapsed_time;
+}
+
+void Jani::EntityQueryController::AcknowledgeEvaluationEnd(std::chrono::microseconds _evaluation_time, std::chrono::microseconds _time_budget)
+{
+    std::lock_guard l(m_safety);
+
+    uint32_t              total_evaluated = 0;
+    uint32_t              total_deferred  = 0;
+    std::vector<QueryKey> queries_to_downgrade;
+
+    for (auto& [bucket_index, slot_index] : m_processed_slots)
+    {
+        auto& slot = m_query_wheels[bucket_index][slot_index];
+        for (int entry_index = static_cast<int>(slot.size()) - 1; entry_index >= 0; entry_index--)
+        {
+            auto& query_info = slot[entry_index];
+            if (query_info.scheduled_frame != m_current_frame)
+            {
+                continue;
+            }
+
+            // Make sure a slot processed twice doesn't account the same query again
+            query_info.scheduled_frame = std::numeric_limits<uint64_t>::max();
+
+            if (query_info.is_outdated)
+            {
+                auto location_iter = m_query_locations.find({ query_info.entity_id, query_info.component_id });
+                if (location_iter != m_query_locations.end())
+                {
+                    RemoveQueryAtLocation(location_iter->second);
+                    m_query_locations.erase(location_iter);
+                }
+
+                continue;
+            }
+
+            if (query_info.is_deferred)
+            {
+                // The evaluation didn't happen, distance bands must be computed from the last one that did
+                query_info.evaluation_time = query_info.previous_evaluation_time;
+                query_info.is_deferred     = false;
+                query_info.miss_count++;
+                total_deferred++;
+
+                if (query_info.miss_count >= DowngradeMissThreshold && bucket_index + 1 < TotalBuckets)
+                {
+                    query_info.miss_count = 0;
+                    queries_to_downgrade.push_back({ query_info.entity_id, query_info.component_id });
+                }
+                else
+                {
+                    m_carried_over_queries.push_back({ query_info.entity_id, query_info.component_id });
+                }
+
+                continue;
+            }
+
+            query_info.miss_count = 0;
+            total_evaluated++;
+        }
+    }
+
+    m_processed_slots.clear();
+
+    for (auto& query_key : queries_to_downgrade)
+    {
+        auto location_iter = m_query_locations.find(query_key);
+        if (location_iter == m_query_locations.end())
+        {
+            continue;
+        }
+
+        uint32_t bucket_index = location_iter->second.bucket_index;
+        MoveQueryToBucket(query_key, bucket_index + 1);
+
+        if (std::find(m_downgraded_queries.begin(), m_downgraded_queries.end(), query_key) == m_downgraded_queries.end())
+        {
+            m_downgraded_queries.push_back(query_key);
+        }
+
+        m_budget_counters.total_downgrades++;
+    }
+
+    // Restore a fraction of the downgraded queries, one bucket at a time, while the load is low
+    bool is_calm_frame = total_deferred == 0 && (_time_budget.count() == 0 || _evaluation_time * 2 < _time_budget);
+    m_calm_frames      = is_calm_frame ? m_calm_frames + 1 : 0;
+    if (m_calm_frames >= RestoreCalmFrames && m_downgraded_queries.size() > 0)
+    {
+        m_calm_frames = 0;
+
+        std::vector<QueryKey> still_downgraded_queries;
+        size_t                total_to_restore = std::max(size_t(1), m_downgraded_queries.size() / RestoreBatchDivisor);
+        while (m_downgraded_queries.size() > 0 && total_to_restore > 0)
+        {
+            auto query_key = m_downgraded_queries.back();
+            m_downgraded_queries.pop_back();
+
+            auto location_iter = m_query_locations.find(query_key);
+            if (location_iter == m_query_locations.end())
+            {
+                continue;
+            }
+
+            auto&    location               = location_iter->second;
+            uint32_t bucket_index           = location.bucket_index;
+            uint32_t requested_bucket_index = m_query_wheels[location.bucket_index][location.slot_index][location.entry_index].requested_bucket_index;
+            if (bucket_index <= requested_bucket_index)
+            {
+                continue;
+            }
+
+            MoveQueryToBucket(query_key, bucket_index - 1);
+            m_budget_counters.total_restores++;
+            total_to_restore--;
+
+            if (bucket_index - 1 > requested_bucket_index)
+            {
+                still_downgraded_queries.push_back(query_key);
+            }
+        }
+
+        m_downgraded_queries.insert(m_downgraded_queries.begin(), still_downgraded_queries.begin(), still_downgraded_queries.end());
+    }
+
+    m_budget_counters.total_evaluated_queries  += total_evaluated;
+    m_budget_counters.total_deferred_queries   += total_deferred;
+    m_budget_counters.last_frame_evaluated      = total_evaluated;
+    m_budget_counters.last_frame_deferred       = total_deferred;
+    m_budget_counters.last_frame_query_time_us  = _evaluation_time.count();
+    m_budget_counters.downgraded_queries        = static_cast<uint32_t>(m_downgraded_queries.size());
+}
+
+Jani::EntityQueryController::QueryBudgetCounters Jani::EntityQueryController::GetBudgetCounters() const
+{
+    return m_budget_counters;
+}
+
+uint32_t Jani::EntityQueryController::GetBucketIndexForFrequency(QueryUpdateFrequency _frequency_enum)
+{
+    switch (_frequency_enum)
+    {
+        case QueryUpdateFrequency::_50: return 0;
+        case QueryUpdateFrequency::_40: return 1;
+        case QueryUpdateFrequency::_30: return 2;
+        case QueryUpdateFrequency::_20: return 3;
+        case QueryUpdateFrequency::_10: return 4;
+        case QueryUpdateFrequency::_5:  return 5;
+        default:                        return 6;
+    }
+}
+
+uint32_t Jani::EntityQueryController::GetBucketPeriod(uint32_t _bucket_index)
+{
+    static const std::array<uint32_t, TotalBuckets> bucket_frequencies = { 50, 40, 30, 20, 10, 5, 1 };
+    return 1000 / bucket_frequencies[_bucket_index];
+}
+
+void Jani::EntityQueryController::PushQueryIntoBucket(QueryInfo _query_info, uint32_t _bucket_index)
+{
+    // Round robin over the slots so each slot ends up with the same number of queries
+    auto&    wheel      = m_query_wheels[_bucket_index];
+    uint32_t slot_index = m_next_slot_cursor[_bucket_index];
+    m_next_slot_cursor[_bucket_index] = (slot_index + 1) % static_cast<uint32_t>(wheel.size());
+
+    QueryKey query_key = { _query_info.entity_id, _query_info.component_id };
+    wheel[slot_index].push_back(std::move(_query_info));
+
+    QueryLocation location;
+    location.bucket_index = _bucket_index;
+    location.slot_index   = slot_index;
+    location.entry_index  = static_cast<uint32_t>(wheel[slot_index].size() - 1);
+    m_query_locations[query_key] = location;
+}
+
+void Jani::EntityQueryController::RemoveQueryAtLocation(const QueryLocation& _location)
+{
+    auto& slot = m_query_wheels[_location.bucket_index][_location.slot_index];
+    if (_location.entry_index != slot.size() - 1)
+    {
+        slot[_location.entry_index] = std::move(slot.back());
+
+        auto moved_location_iter = m_query_locations.find({ slot[_location.entry_index].entity_id, slot[_location.entry_index].component_id });
+        if (moved_location_iter != m_query_locations.end())
+        {
+            moved_location_iter->second.entry_index = _location.entry_index;
+        }
+    }
+
+    slot.pop_back();
+}
+
+void Jani::EntityQueryController::MoveQueryToBucket(const QueryKey& _query_key, uint32_t _bucket_index)
+{
+    auto location_iter = m_query_locations.find(_query_key);
+    if (location_iter == m_query_locations.end())
+    {
+        return;
+    }
+
+    QueryLocation location   = location_iter->second;
+    QueryInfo     query_info = m_query_wheels[location.bucket_index][location.slot_index][location.entry_index];
+
+    RemoveQueryAtLocation(location);
+    PushQueryIntoBucket(std::move(query_info), _bucket_index);
+}
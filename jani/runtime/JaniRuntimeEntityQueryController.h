@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: JaniRuntimeEntityQueryController.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include "JaniInternal.h"
+
+///////////////
+// NAMESPACE //
+///////////////
+
+// Jani
+JaniNamespaceBegin(Jani)
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: EntityQueryController
+////////////////////////////////////////////////////////////////////////////////
+class EntityQueryController
+{
+public:
+
+    static const uint32_t TotalBuckets = magic_enum::enum_integer(QueryUpdateFrequency::Count);
+
+    /*
+    * Number of consecutive frames a query can be deferred because the frame budget was exhausted
+    * before it gets moved into the next lower frequency bucket
+    */
+    static const uint32_t DowngradeMissThreshold = 3;
+
+    /*
+    * Number of consecutive frames without deferred queries and using less than half of the budget
+    * required before downgraded queries are moved one bucket back to their requested frequency, only
+    * 1/RestoreBatchDivisor of them are restored each time so the load increases gradually
+    */
+    static const uint32_t RestoreCalmFrames   = 20;
+    static const uint32_t RestoreBatchDivisor = 8;
+
+    struct QueryInfo
+    {
+        EntityId     entity_id                = std::numeric_limits<EntityId>::max();
+        ComponentId  component_id             = std::numeric_limits<ComponentId>::max();
+        uint32_t     query_version            = std::numeric_limits<uint32_t>::max();
+        uint32_t     requested_bucket_index   = 0;
+        uint32_t     miss_count               = 0;
+        uint64_t     scheduled_frame          = std::numeric_limits<uint64_t>::max();
+        uint64_t     evaluation_time          = std::numeric_limits<uint64_t>::max(); // Controller time (ms) of the current evaluation
+        uint64_t     previous_evaluation_time = std::numeric_limits<uint64_t>::max(); // Controller time (ms) of the last completed evaluation
+        mutable bool is_outdated              = false;
+        mutable bool is_deferred              = false;
+    };
+
+    struct QueryBudgetCounters
+    {
+        uint64_t total_evaluated_queries    = 0;
+        uint64_t total_deferred_queries     = 0;
+        uint64_t total_downgrades           = 0;
+        uint64_t total_restores             = 0;
+        uint32_t downgraded_queries         = 0;
+        uint32_t last_frame_evaluated       = 0;
+        uint32_t last_frame_deferred        = 0;
+        uint64_t last_frame_query_time_us   = 0;
+    };
+
+private:
+
+    /*
+    * Each frequency bucket is a timing wheel with one slot per millisecond of its period, a query
+    * lives on a single slot (its phase offset) and is evaluated whenever the wheel crosses it. This
+    * spreads the evaluation of a bucket evenly over its whole period instead of bursting it on a
+    * single frame
+    */
+    struct QueryLocation
+    {
+        uint32_t bucket_index = 0;
+        uint32_t slot_index   = 0;
+        uint32_t entry_index  = 0;
+    };
+
+    struct QueryKeyHasher
+    {
+        std::size_t operator()(const std::pair<EntityId, ComponentId>& _key) const
+        {
+            return std::hash<EntityId>()(_key.first) ^ (std::hash<ComponentId>()(_key.second) << 1);
+        }
+    };
+
+    using QueryKey = std::pair<EntityId, ComponentId>;
+
+//////////////////////////
+public: // CONSTRUCTORS //
+//////////////////////////
+
+    EntityQueryController();
+    ~EntityQueryController();
+
+//////////////////////////
+public: // MAIN METHODS //
+//////////////////////////
+
+    /*
+    * Insert or replace the query for the given entity component, if the entity component is already
+    * registered on the same frequency its entry is updated in place
+    */
+    void InsertQuery(EntityId _entity_id, ComponentId _component_id, QueryUpdateFrequency _update_frequency, uint32_t _query_version);
+
+    /*
+    * Call the given callback for each query that is due this frame, queries deferred on the previous
+    * frame are always called first
+    * The callback can set the query is_outdated flag to have it removed or the is_deferred flag to
+    * indicate that the frame budget didn't allow it to be evaluated
+    */
+    void ForEach(std::function<void(QueryInfo&)> _callback);
+
+    /*
+    * Must be called after all callbacks from the last ForEach() call are done
+    * Removes outdated queries, carries over deferred ones, applies frequency downgrades/restores
+    * and updates the budget counters
+    */
+    void AcknowledgeEvaluationEnd(std::chrono::microseconds _evaluation_time, std::chrono::microseconds _time_budget);
+
+    /*
+    * Return the query budget counters
+    */
+    QueryBudgetCounters GetBudgetCounters() const;
+
+private:
+
+    /*
+    * Return the bucket index for the given frequency and the bucket period (in milliseconds)
+    */
+    static uint32_t GetBucketIndexForFrequency(QueryUpdateFrequency _frequency_enum);
+    static uint32_t GetBucketPeriod(uint32_t _bucket_index);
+
+    /*
+    * Place the query into the given bucket using the next available phase slot
+    */
+    void PushQueryIntoBucket(QueryInfo _query_info, uint32_t _bucket_index);
+
+    /*
+    * Swap-remove the query at the given location, updating the location of the moved entry
+    */
+    void RemoveQueryAtLocation(const QueryLocation& _location);
+
+    /*
+    * Move an existing query into another bucket, keeping all its data
+    */
+    void MoveQueryToBucket(const QueryKey& _query_key, uint32_t _bucket_index);
+
+////////////////////////
+private: // VARIABLES //
+////////////////////////
+
+    std::array<std::vector<std::vector<QueryInfo>>, TotalBuckets>                 m_query_wheels;
+    std::array<uint32_t, TotalBuckets>                                            m_next_slot_cursor       = {};
+    std::unordered_map<QueryKey, QueryLocation, QueryKeyHasher>                   m_query_locations;
+    std::vector<std::pair<uint32_t, uint32_t>>                                    m_processed_slots;
+    std::vector<QueryKey>                                                         m_carried_over_queries;
+    std::vector<QueryKey>                                                         m_downgraded_queries;
+    std::chrono::time_point<std::chrono::steady_clock>                            m_initial_timestamp      = std::chrono::steady_clock::now();
+    uint64_t                                                                      m_previous_elapsed_time  = 0;
+    uint64_t                                                                      m_current_frame          = 0;
+    uint32_t                                                                      m_calm_frames            = 0;
+    QueryBudgetCounters                                                           m_budget_counters;
+    std::mutex                                                                    m_safety;
+};
+
+// Jani
+JaniNamespaceEnd(Jani)
@@ -22,28 +22,89 @@ JaniNamespaceBegin(Jani)
 template <typename mType, uint32_t mBucketDimSize>
 class EntitySparseGrid
 {
+    static_assert((mBucketDimSize & (mBucketDimSize - 1)) == 0, "The bucket dimension must be a power of 2");
+
+    /*
+    * Cells are stored flat, indexed according to the grid layout (see GetCellLocalIndex())
+    * The active cell count works as the bucket reference count, once it reaches zero the bucket is
+    * removed from the directory and returned to the pool
+    */
     struct Bucket
     {
-        std::array<std::array<std::optional<mType>, mBucketDimSize>, mBucketDimSize> cells;
+        std::array<std::optional<mType>, mBucketDimSize * mBucketDimSize> cells;
+        uint32_t                                                          active_cells = 0;
+    };
+
+    /*
+    * The bucket directory is paged by the bucket index, each page holds DirectoryPageSize consecutive indices
+    * so with the Morton layout buckets close on the curve share a page, a page only exists while it has at
+    * least one bucket
+    */
+    static const uint32_t DirectoryPageSize = 256;
+
+    struct DirectoryPage
+    {
+        std::array<std::unique_ptr<Bucket>, DirectoryPageSize> buckets;
+        uint32_t                                               active_buckets = 0;
+    };
+
+    /*
+    * Each occupancy summary level groups OccupancyFanout x OccupancyFanout nodes of the level below, the
+    * first summary level groups buckets (the bucket level itself is the directory)
+    */
+    static const uint32_t OccupancyFanout = 4;
+
+    /*
+    * Maximum number of released buckets kept around to be reused, any bucket released above this
+    * limit is deallocated
+    */
+    static const uint32_t MaximumPooledBuckets = 64;
+
+    struct OccupancyLevel
+    {
+        uint32_t              dim_size = 0;
+        std::vector<uint32_t> active_cells;
     };
 
 public:
 
-    EntitySparseGrid(uint32_t _world_dim_size) : m_world_dim_size(_world_dim_size)
+    static const uint32_t BucketDimSize = mBucketDimSize;
+
+    EntitySparseGrid(uint32_t _world_dim_size, WorldGridLayout _layout = WorldGridLayout::RowMajor) : m_world_dim_size(_world_dim_size), m_layout(_layout)
     {
         assert(m_world_dim_size % mBucketDimSize == 0);
-        m_world_dim_size     = _world_dim_size / mBucketDimSize;
-        using size_type      = typename std::allocator_traits< std::allocator<std::vector<std::unique_ptr<Bucket>>>>::size_type;
-        size_type total_size = m_world_dim_size * m_world_dim_size;
-        assert(total_size > 0 && total_size < std::numeric_limits<size_type>::max());
-        m_buckets.resize(total_size);
+        m_world_dim_size = _world_dim_size / mBucketDimSize;
+
+        // Bucket indices (the directory keys) must fit 32 bits
+        assert(m_world_dim_size > 0 && m_world_dim_size <= (1 << 16));
+
+        // The last bucket has the highest index on both layouts, only the page table is allocated upfront
+        uint64_t total_bucket_indices = static_cast<uint64_t>(GetBucketIndex(m_world_dim_size - 1, m_world_dim_size - 1)) + 1;
+        m_directory.resize(static_cast<size_t>((total_bucket_indices + DirectoryPageSize - 1) / DirectoryPageSize));
+
+        // Build the occupancy pyramid until a single node covers the whole world, the bucket level is
+        // kept by the directory so only populated buckets use memory
+        uint32_t level_dim_size = m_world_dim_size;
+        while (level_dim_size > 1)
+        {
+            level_dim_size = (level_dim_size + OccupancyFanout - 1) / OccupancyFanout;
+
+            OccupancyLevel occupancy_level;
+            occupancy_level.dim_size = level_dim_size;
+            occupancy_level.active_cells.resize(level_dim_size * level_dim_size, 0);
+            m_occupancy_levels.push_back(std::move(occupancy_level));
+        }
     }
 
     bool IsCellEmpty(WorldCellCoordinates _cell_coordinates) const
     {
+        if (!IsWorldPositionValid(_cell_coordinates.x, _cell_coordinates.y))
+        {
+            return true;
+        }
         auto [bucket_x, bucket_y, local_x, local_y] = ConvertWorldToLocalCoordinates(_cell_coordinates.x, _cell_coordinates.y);
-        uint32_t index = (bucket_y / mBucketDimSize) * m_world_dim_size + (bucket_x / mBucketDimSize);
-        return m_buckets[index] == nullptr || m_buckets[index]->cells[local_x][local_y] == std::nullopt;
+        auto* bucket = FindBucket(GetBucketIndex(bucket_x, bucket_y));
+        return bucket == nullptr || bucket->cells[GetCellLocalIndex(local_x, local_y)] == std::nullopt;
     }
 
     bool Set(WorldCellCoordinates _cell_coordinates, mType _value)
@@ -54,34 +115,59 @@ public:
         }
         auto [bucket_x, bucket_y, local_x, local_y] = ConvertWorldToLocalCoordinates(_cell_coordinates.x, _cell_coordinates.y);
         auto& bucket = GetBucketAtBucketLocalPositionOrCreate(bucket_x, bucket_y);
-        bucket.cells[local_x][local_y] = std::move(_value);
-        m_total_active_cells++;
+        auto& cell   = bucket.cells[GetCellLocalIndex(local_x, local_y)];
+        if (cell == std::nullopt)
+        {
+            bucket.active_cells++;
+            UpdateOccupancy(bucket_x, bucket_y, 1);
+            m_total_active_cells++;
+        }
+        cell = std::move(_value);
         return true;
     }
 
     void Clear(WorldCellCoordinates _cell_coordinates)
     {
-        if (!IsWorldPositionValid(_cell_coordinates.x, _cell_coordinates.y))
+        if (IsCellEmpty(_cell_coordinates))
         {
             return;
         }
         auto [bucket_x, bucket_y, local_x, local_y] = ConvertWorldToLocalCoordinates(_cell_coordinates.x, _cell_coordinates.y);
-        auto& bucket = GetBucketAtBucketLocalPositionOrCreate(bucket_x, bucket_y);
-        if (bucket != std::nullopt)
+        uint32_t bucket_index = GetBucketIndex(bucket_x, bucket_y);
+        auto&    page         = m_directory[bucket_index / DirectoryPageSize];
+        auto&    bucket       = page->buckets[bucket_index % DirectoryPageSize];
+
+        bucket->cells[GetCellLocalIndex(local_x, local_y)] = std::nullopt;
+        bucket->active_cells--;
+        UpdateOccupancy(bucket_x, bucket_y, -1);
+        m_total_active_cells--;
+
+        // Last cell gone, release the bucket (and its page if it was the last one there)
+        if (bucket->active_cells == 0)
         {
-            bucket = std::nullopt;
-            m_total_active_cells--;
+            if (m_bucket_pool.size() < MaximumPooledBuckets)
+            {
+                m_bucket_pool.push_back(std::move(bucket));
+            }
+
+            bucket = nullptr;
+            m_total_allocated_buckets--;
+
+            if (--page->active_buckets == 0)
+            {
+                page = nullptr;
+            }
         }
     }
 
     const mType* TryAt(WorldCellCoordinates _cell_coordinates) const
     {
-        return TryAtMutable(_cell_coordinates.x, _cell_coordinates.y);
+        return TryAtMutable(_cell_coordinates);
     }
 
-    const mType* TryAtMutable(WorldCellCoordinates _cell_coordinates) const
+    mType* TryAtMutable(WorldCellCoordinates _cell_coordinates) const
     {
-        if (IsCellEmpty(_cell_coordinates.x, _cell_coordinates.y))
+        if (IsCellEmpty(_cell_coordinates))
         {
             return nullptr;
         }
@@ -97,7 +183,7 @@ public:
     {
         auto [bucket_x, bucket_y, local_x, local_y] = ConvertWorldToLocalCoordinates(_cell_coordinates.x, _cell_coordinates.y);
         assert(IsBucketValid(bucket_x, bucket_y));
-        return GetBucketAtBucketLocalPosition(bucket_x, bucket_y).cells[local_x][local_y].value();
+        return GetBucketAtBucketLocalPosition(bucket_x, bucket_y).cells[GetCellLocalIndex(local_x, local_y)].value();
     }
 
     const nonstd::transient_vector<mType*> InsideRect(WorldCellCoordinates _rect_coordinates_begin, WorldCellCoordinates _rect_coordinates_end) const
@@ -105,34 +191,25 @@ public:
         return std::move(InsideRectMutable(_rect_coordinates_begin, _rect_coordinates_end));
     }
 
+    /*
+    * Return all active cells inside the given cell rect (both ends inclusive)
+    */
     nonstd::transient_vector<mType*> InsideRectMutable(WorldCellCoordinates _rect_coordinates_begin, WorldCellCoordinates _rect_coordinates_end) const
     {
         nonstd::transient_vector<mType*> out_result;
 
-        WorldCellCoordinates central_coordinates = WorldCellCoordinates({
-            (_rect_coordinates_begin.x + _rect_coordinates_end.x) / 2,
-            (_rect_coordinates_begin.y + _rect_coordinates_end.y) / 2 });
-        WorldCellCoordinates half_size = WorldCellCoordinates({
-            static_cast<int32_t>(std::ceil((_rect_coordinates_end.x - _rect_coordinates_begin.x) / 2.0f)),
-            static_cast<int32_t>(std::ceil((_rect_coordinates_end.y - _rect_coordinates_begin.y) / 2.0f)) });
-        auto [bucket_x, bucket_y, local_x, local_y] = ConvertWorldToLocalCoordinates(central_coordinates.x, central_coordinates.y);
-        int start_x = central_coordinates.x - std::max(1, half_size.x);
-        int start_y = central_coordinates.y - std::max(1, half_size.y);
-        int end_x = central_coordinates.x + std::max(1, half_size.x);
-        int end_y = central_coordinates.y + std::max(1, half_size.y);
-
-        for (int x = start_x; x <= end_x; x++)
-        {
-            for (int y = start_y; y <= end_y; y++)
+        ForEachActiveCell(
+            _rect_coordinates_begin, 
+            _rect_coordinates_end, 
+            [](glm::vec2 _region_begin, glm::vec2 _region_end) 
+            { 
+                return true; 
+            },
+            [&](mType& _cell)
             {
-                if (IsCellEmpty(WorldCellCoordinates({ x, y })))
-                {
-                    continue;
-                }
-                auto& bucket_value = AtMutable(WorldCellCoordinates({ x, y }));
-                out_result.push_back(&bucket_value);
-            }
-        }
+                out_result.push_back(&_cell);
+            });
+
         return std::move(out_result);
     }
 
@@ -141,37 +218,199 @@ public:
         return std::move(InsideRangeMutable(_cell_coordinates, _radius));
     }
 
+    /*
+    * The center is only known up to its cell, the circle is centered on the cell and grown by half its diagonal
+    * so it covers any position inside it
+    */
     nonstd::transient_vector<mType*> InsideRangeMutable(WorldCellCoordinates _cell_coordinates, float _radius) const
+    {
+        return std::move(InsideRangeMutable(glm::vec2(_cell_coordinates.x + 0.5f, _cell_coordinates.y + 0.5f), _radius + glm::root_two<float>() / 2.0f));
+    }
+
+    const nonstd::transient_vector<mType*> InsideRange(glm::vec2 _cell_space_center, float _radius) const
+    {
+        return std::move(InsideRangeMutable(_cell_space_center, _radius));
+    }
+
+    /*
+    * Return all active cells that overlap the circle, the center is in cell space (cell coordinates plus the
+    * fraction inside the cell) and the radius in cell units
+    */
+    nonstd::transient_vector<mType*> InsideRangeMutable(glm::vec2 _cell_space_center, float _radius) const
     {
         nonstd::transient_vector<mType*> out_result;
 
-        // TODO:
-        // This calculation should be improved! It will (in most cases) lead into a 3x3 grid search when
-        // it could perform the search only on the central grid
-        // I need to pass the actual position inside the cell and determine if it with the radius really imply in
-        // searching all the neighbors or just a few/none
-        auto [bucket_x, bucket_y, local_x, local_y] = ConvertWorldToLocalCoordinates(_cell_coordinates.x, _cell_coordinates.y);
-        int actual_radius      = std::ceil(_radius);
-        int actual_radius_pow2 = actual_radius * actual_radius;
-        int start_x            = _cell_coordinates.x - actual_radius;
-        int start_y            = _cell_coordinates.y - actual_radius;
-        int end_x              = _cell_coordinates.x + actual_radius;
-        int end_y              = _cell_coordinates.y + actual_radius;
-        
-        for (int x = start_x; x <= end_x; x++)
-        {
-            for (int y = start_y; y <= end_y; y++)
-            {
-                if (IsCellEmpty(WorldCellCoordinates({ x, y })) ||
-                    (x - _cell_coordinates.x + y - _cell_coordinates.y) * (x - _cell_coordinates.x + y - _cell_coordinates.y) > actual_radius_pow2)
+        float radius_pow2 = _radius * _radius;
+
+        ForEachActiveCell(
+            WorldCellCoordinates({ static_cast<int32_t>(std::floor(_cell_space_center.x - _radius)), static_cast<int32_t>(std::floor(_cell_space_center.y - _radius)) }),
+            WorldCellCoordinates({ static_cast<int32_t>(std::floor(_cell_space_center.x + _radius)), static_cast<int32_t>(std::floor(_cell_space_center.y + _radius)) }),
+            [&](glm::vec2 _region_begin, glm::vec2 _region_end)
+            {
+                // Distance from the center to the closest point of the region
+                glm::vec2 closest_point = glm::clamp(_cell_space_center, _region_begin, _region_end);
+                glm::vec2 difference    = closest_point - _cell_space_center;
+                return glm::dot(difference, difference) <= radius_pow2;
+            },
+            [&](mType& _cell)
+            {
+                out_result.push_back(&_cell);
+            });
+
+        return std::move(out_result);
+    }
+
+    /*
+    * Call the function for each active cell inside the cell rect (both ends inclusive)
+    */
+    template <typename CellFunction>
+    void ForEachActiveCellInRect(
+        WorldCellCoordinates _rect_coordinates_begin, 
+        WorldCellCoordinates _rect_coordinates_end, 
+        CellFunction&&       _cell_function) const
+    {
+        ForEachActiveCell(
+            _rect_coordinates_begin, 
+            _rect_coordinates_end, 
+            [](glm::vec2 _region_begin, glm::vec2 _region_end) 
+            { 
+                return true; 
+            },
+            std::forward<CellFunction>(_cell_function));
+    }
+
+    /*
+    * Call the function for each active cell inside the cell rect (both ends inclusive) whose region is accepted
+    * by the overlap function, the overlap function receives the region begin/end in cell space
+    * Regions (summary nodes and buckets) without active cells or rejected by the overlap function are skipped
+    * without visiting their cells
+    * Cells are visited in Z-order (Morton curve order), with the Morton layout this is also the memory order
+    */
+    template <typename OverlapFunction, typename CellFunction>
+    void ForEachActiveCell(
+        WorldCellCoordinates _rect_coordinates_begin, 
+        WorldCellCoordinates _rect_coordinates_end, 
+        OverlapFunction&&    _overlap_function, 
+        CellFunction&&       _cell_function) const
+    {
+        int32_t world_cell_dim_size = static_cast<int32_t>(m_world_dim_size * mBucketDimSize);
+        int32_t begin_x             = std::max(_rect_coordinates_begin.x, 0);
+        int32_t begin_y             = std::max(_rect_coordinates_begin.y, 0);
+        int32_t end_x               = std::min(_rect_coordinates_end.x, world_cell_dim_size - 1);
+        int32_t end_y               = std::min(_rect_coordinates_end.y, world_cell_dim_size - 1);
+        if (begin_x > end_x || begin_y > end_y || m_total_active_cells == 0)
+        {
+            return;
+        }
+
+        struct PendingNode
+        {
+            uint32_t level;
+            int32_t  x;
+            int32_t  y;
+        };
+
+        nonstd::transient_vector<PendingNode> pending_nodes;
+        pending_nodes.push_back({ static_cast<uint32_t>(m_occupancy_levels.size()), 0, 0 });
+
+        while (pending_nodes.size() > 0)
+        {
+            PendingNode node = pending_nodes.back();
+            pending_nodes.pop_back();
+
+            // Level 0 nodes are buckets, missing buckets have no active cells
+            Bucket*  node_bucket       = nullptr;
+            uint32_t node_active_cells = 0;
+            if (node.level == 0)
+            {
+                node_bucket       = FindBucket(GetBucketIndex(node.x, node.y));
+                node_active_cells = node_bucket ? node_bucket->active_cells : 0;
+            }
+            else
+            {
+                auto& occupancy_level = m_occupancy_levels[node.level - 1];
+                node_active_cells     = occupancy_level.active_cells[node.y * occupancy_level.dim_size + node.x];
+            }
+
+            if (node_active_cells == 0)
+            {
+                continue;
+            }
+
+            // Cell span of this node, clipped to the rect
+            int32_t node_cell_size = static_cast<int32_t>(GetLevelBucketSpan(node.level) * mBucketDimSize);
+            int32_t node_begin_x   = node.x * node_cell_size;
+            int32_t node_begin_y   = node.y * node_cell_size;
+            int32_t node_end_x     = node_begin_x + node_cell_size - 1;
+            int32_t node_end_y     = node_begin_y + node_cell_size - 1;
+            if (node_end_x < begin_x || node_end_y < begin_y || node_begin_x > end_x || node_begin_y > end_y)
+            {
+                continue;
+            }
+
+            if (!_overlap_function(
+                glm::vec2(node_begin_x, node_begin_y), 
+                glm::vec2(node_end_x + 1, node_end_y + 1)))
+            {
+                continue;
+            }
+
+            if (node.level > 0)
+            {
+                // Children are pushed in reverse curve order so they are popped in curve order
+                uint32_t child_dim_size = node.level > 1 ? m_occupancy_levels[node.level - 2].dim_size : m_world_dim_size;
+                for (int32_t child_code = OccupancyFanout * OccupancyFanout - 1; child_code >= 0; child_code--)
+                {
+                    auto [relative_x, relative_y] = MortonDecode(static_cast<uint32_t>(child_code));
+                    uint32_t child_x              = node.x * OccupancyFanout + relative_x;
+                    uint32_t child_y              = node.y * OccupancyFanout + relative_y;
+                    if (child_x < child_dim_size && child_y < child_dim_size)
+                    {
+                        pending_nodes.push_back({ node.level - 1, static_cast<int32_t>(child_x), static_cast<int32_t>(child_y) });
+                    }
+                }
+
+                continue;
+            }
+
+            // Bucket level, visit the active cells
+            auto& bucket    = *node_bucket;
+            auto  VisitCell = [&](int32_t _x, int32_t _y)
+            {
+                auto& cell = bucket.cells[GetCellLocalIndex(_x - node_begin_x, _y - node_begin_y)];
+                if (cell == std::nullopt || !_overlap_function(glm::vec2(_x, _y), glm::vec2(_x + 1, _y + 1)))
+                {
+                    return;
+                }
+
+                _cell_function(cell.value());
+            };
+
+            if (m_layout == WorldGridLayout::Morton)
+            {
+                // Walk the bucket sequentially, skipping the cells outside the rect
+                for (uint32_t cell_code = 0; cell_code < mBucketDimSize * mBucketDimSize; cell_code++)
+                {
+                    auto [local_x, local_y] = MortonDecode(cell_code);
+                    int32_t x               = node_begin_x + static_cast<int32_t>(local_x);
+                    int32_t y               = node_begin_y + static_cast<int32_t>(local_y);
+                    if (x >= begin_x && x <= end_x && y >= begin_y && y <= end_y)
+                    {
+                        VisitCell(x, y);
+                    }
+                }
+            }
+            else
+            {
+                for (int32_t x = std::max(node_begin_x, begin_x); x <= std::min(node_end_x, end_x); x++)
                 {
-                    continue;
+                    for (int32_t y = std::max(node_begin_y, begin_y); y <= std::min(node_end_y, end_y); y++)
+                    {
+                        VisitCell(x, y);
+                    }
                 }
-                auto& bucket_value = AtMutable(WorldCellCoordinates({ x, y }));
-                out_result.push_back(&bucket_value);
             }
         }
-        return std::move(out_result);
     }
 
     uint32_t GetTotalActiveCells() const
@@ -179,14 +418,116 @@ public:
         return m_total_active_cells;
     }
 
+    /*
+    * Return the number of buckets currently on the directory, memory used by cells is proportional to it
+    */
+    uint32_t GetTotalAllocatedBuckets() const
+    {
+        return m_total_allocated_buckets;
+    }
+
 private:
 
+    /*
+    * Interleave the bits of both coordinates (x on the even bits), each coordinate must fit 16 bits
+    */
+    static uint32_t MortonEncode(uint32_t _x, uint32_t _y)
+    {
+        auto SpreadBits = [](uint32_t _value) -> uint32_t
+        {
+            _value &= 0x0000ffff;
+            _value  = (_value | (_value << 8)) & 0x00ff00ff;
+            _value  = (_value | (_value << 4)) & 0x0f0f0f0f;
+            _value  = (_value | (_value << 2)) & 0x33333333;
+            _value  = (_value | (_value << 1)) & 0x55555555;
+            return _value;
+        };
+
+        return SpreadBits(_x) | (SpreadBits(_y) << 1);
+    }
+
+    static std::pair<uint32_t, uint32_t> MortonDecode(uint32_t _code)
+    {
+        auto CompactBits = [](uint32_t _value) -> uint32_t
+        {
+            _value &= 0x55555555;
+            _value  = (_value | (_value >> 1)) & 0x33333333;
+            _value  = (_value | (_value >> 2)) & 0x0f0f0f0f;
+            _value  = (_value | (_value >> 4)) & 0x00ff00ff;
+            _value  = (_value | (_value >> 8)) & 0x0000ffff;
+            return _value;
+        };
+
+        return { CompactBits(_code), CompactBits(_code >> 1) };
+    }
+
+    /*
+    * The given coordinates are already in bucket units
+    */
+    uint32_t GetBucketIndex(int _bucket_x, int _bucket_y) const
+    {
+        if (m_layout == WorldGridLayout::Morton)
+        {
+            return MortonEncode(static_cast<uint32_t>(_bucket_x), static_cast<uint32_t>(_bucket_y));
+        }
+
+        return static_cast<uint32_t>(_bucket_y) * m_world_dim_size + static_cast<uint32_t>(_bucket_x);
+    }
+
+    /*
+    * The given coordinates are local to the bucket
+    */
+    uint32_t GetCellLocalIndex(int _local_x, int _local_y) const
+    {
+        if (m_layout == WorldGridLayout::Morton)
+        {
+            return MortonEncode(static_cast<uint32_t>(_local_x), static_cast<uint32_t>(_local_y));
+        }
+
+        return static_cast<uint32_t>(_local_x) * mBucketDimSize + static_cast<uint32_t>(_local_y);
+    }
+
+    /*
+    * Number of buckets (per dimension) covered by a single node of the given occupancy level
+    */
+    uint32_t GetLevelBucketSpan(uint32_t _level) const
+    {
+        uint32_t bucket_span = 1;
+        for (uint32_t i = 0; i < _level; i++)
+        {
+            bucket_span *= OccupancyFanout;
+        }
+
+        return bucket_span;
+    }
+
+    /*
+    * Update the summary levels, the bucket own counter must be updated by the caller
+    */
+    void UpdateOccupancy(int _bucket_x, int _bucket_y, int32_t _delta)
+    {
+        uint32_t node_x = static_cast<uint32_t>(_bucket_x);
+        uint32_t node_y = static_cast<uint32_t>(_bucket_y);
+        for (auto& occupancy_level : m_occupancy_levels)
+        {
+            node_x /= OccupancyFanout;
+            node_y /= OccupancyFanout;
+            occupancy_level.active_cells[node_y * occupancy_level.dim_size + node_x] += _delta;
+        }
+    }
+
+    Bucket* FindBucket(uint32_t _bucket_index) const
+    {
+        auto& page = m_directory[_bucket_index / DirectoryPageSize];
+        return page ? page->buckets[_bucket_index % DirectoryPageSize].get() : nullptr;
+    }
+
     Bucket& GetBucketAtBucketLocalPosition(int _x, int _y) const
     {
-        uint32_t index = (_y / mBucketDimSize) * m_world_dim_size + (_x / mBucketDimSize);
-        if (m_buckets[index] != nullptr)
+        auto* bucket = FindBucket(GetBucketIndex(_x, _y));
+        if (bucket)
         {
-            return *m_buckets[index];
+            return *bucket;
         }
         else
         {
@@ -196,27 +537,42 @@ private:
 
     Bucket& GetBucketAtBucketLocalPositionOrCreate(int _x, int _y)
     {
-        uint32_t index = (_y / mBucketDimSize) * m_world_dim_size + (_x / mBucketDimSize);
-        if (m_buckets[index] != nullptr)
+        uint32_t bucket_index = GetBucketIndex(_x, _y);
+        auto&    page         = m_directory[bucket_index / DirectoryPageSize];
+        if (page == nullptr)
         {
-            return *m_buckets[index];
+            page = std::make_unique<DirectoryPage>();
         }
-        else
+
+        auto& bucket = page->buckets[bucket_index % DirectoryPageSize];
+        if (bucket == nullptr)
         {
-            m_buckets[index] = std::make_unique<Bucket>();
-            return *m_buckets[index];
+            page->active_buckets++;
+            m_total_allocated_buckets++;
+
+            // Reuse a released bucket if possible, all its cells are already empty
+            if (m_bucket_pool.size() > 0)
+            {
+                bucket = std::move(m_bucket_pool.back());
+                m_bucket_pool.pop_back();
+            }
+            else
+            {
+                bucket = std::make_unique<Bucket>();
+            }
         }
+
+        return *bucket;
     }
 
     bool IsWorldPositionValid(int _x, int _y) const
     {
-        return static_cast<uint32_t>(_x / mBucketDimSize) < m_world_dim_size&& static_cast<uint32_t>(_y / mBucketDimSize) < m_world_dim_size;
+        return _x >= 0 && _y >= 0 && static_cast<uint32_t>(_x / mBucketDimSize) < m_world_dim_size && static_cast<uint32_t>(_y / mBucketDimSize) < m_world_dim_size;
     }
 
     bool IsBucketValid(int _x, int _y) const
     {
-        uint32_t index = (_y / mBucketDimSize) * m_world_dim_size + (_x / mBucketDimSize);
-        return m_buckets[index] != nullptr;
+        return FindBucket(GetBucketIndex(_x, _y)) != nullptr;
     }
 
     std::tuple<int, int, int, int> ConvertWorldToLocalCoordinates(int _x, int _y) const
@@ -231,7 +587,14 @@ private:
 private:
     uint32_t							 m_total_active_cells = 0;
     uint32_t							 m_world_dim_size = 0;
-    std::vector<std::unique_ptr<Bucket>> m_buckets;
+    WorldGridLayout                      m_layout = WorldGridLayout::RowMajor;
+
+    // Sparse bucket directory paged by the bucket index (Morton code or row-major index), so buckets keep the
+    // layout order, only buckets with at least one active cell are present
+    std::vector<std::unique_ptr<DirectoryPage>> m_directory;
+    uint32_t                                    m_total_allocated_buckets = 0;
+    std::vector<std::unique_ptr<Bucket>>        m_bucket_pool;
+    std::vector<OccupancyLevel>                 m_occupancy_levels; // [0] = groups of buckets, last = whole world
 };
 
 
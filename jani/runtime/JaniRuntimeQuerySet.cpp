@@ -0,0 +1,397 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: JaniRuntimeQuerySet.cpp
+////////////////////////////////////////////////////////////////////////////////
+#include "JaniRuntimeQuerySet.h"
+
+Jani::QueryEntitySet::QueryEntitySet()
+{
+}
+
+Jani::QueryEntitySet Jani::QueryEntitySet::FromIds(nonstd::transient_vector<EntityId>&& _ids, bool _is_sorted)
+{
+    QueryEntitySet entity_set;
+
+    if (!_is_sorted)
+    {
+        std::sort(_ids.begin(), _ids.end());
+    }
+
+    entity_set.m_cardinality = _ids.size();
+    entity_set.m_sorted_ids  = std::move(_ids);
+    entity_set.Compact();
+
+    return std::move(entity_set);
+}
+
+Jani::QueryEntitySet Jani::QueryEntitySet::Intersection(const QueryEntitySet& _a, const QueryEntitySet& _b)
+{
+    QueryEntitySet result;
+
+    if (_a.m_cardinality == 0 || _b.m_cardinality == 0)
+    {
+        return std::move(result);
+    }
+
+    // Bitmap x Bitmap: and the overlapping words
+    if (_a.m_representation == Representation::Bitmap && _b.m_representation == Representation::Bitmap)
+    {
+        EntityId begin = std::max(_a.m_bitmap_base, _b.m_bitmap_base);
+        EntityId end   = std::min(_a.m_bitmap_base + _a.m_bitmap_words.size() * 64, _b.m_bitmap_base + _b.m_bitmap_words.size() * 64);
+        if (begin >= end)
+        {
+            return std::move(result);
+        }
+
+        result.m_representation = Representation::Bitmap;
+        result.m_bitmap_base    = begin;
+        result.m_bitmap_words.resize((end - begin) / 64);
+
+        uint64_t a_offset = (begin - _a.m_bitmap_base) / 64;
+        uint64_t b_offset = (begin - _b.m_bitmap_base) / 64;
+        for (uint64_t i = 0; i < result.m_bitmap_words.size(); i++)
+        {
+            uint64_t word = _a.m_bitmap_words[a_offset + i] & _b.m_bitmap_words[b_offset + i];
+            result.m_bitmap_words[i] = word;
+            result.m_cardinality    += PopCount(word);
+        }
+
+        result.Compact();
+        return std::move(result);
+    }
+
+    // Sorted x Bitmap: probe each id against the bitmap, the output keeps the sorted order
+    if (_a.m_representation != _b.m_representation)
+    {
+        const QueryEntitySet& sorted_set = _a.m_representation == Representation::SortedIds ? _a : _b;
+        const QueryEntitySet& bitmap_set = _a.m_representation == Representation::SortedIds ? _b : _a;
+
+        for (auto entity_id : sorted_set.m_sorted_ids)
+        {
+            if (bitmap_set.Contains(entity_id))
+            {
+                result.m_sorted_ids.push_back(entity_id);
+            }
+        }
+
+        result.m_cardinality = result.m_sorted_ids.size();
+        result.Compact();
+        return std::move(result);
+    }
+
+    // Sorted x Sorted
+    const auto& small_ids = _a.m_cardinality <= _b.m_cardinality ? _a.m_sorted_ids : _b.m_sorted_ids;
+    const auto& large_ids = _a.m_cardinality <= _b.m_cardinality ? _b.m_sorted_ids : _a.m_sorted_ids;
+
+    if (large_ids.size() / small_ids.size() >= GallopingRatioThreshold)
+    {
+        // Galloping: for each id on the small set, exponentially grow a window on the large set starting
+        // from the last match position and binary search inside it
+        auto search_begin = large_ids.begin();
+        for (auto entity_id : small_ids)
+        {
+            size_t step       = 1;
+            auto   search_end = search_begin;
+            while (search_end != large_ids.end() && *search_end < entity_id)
+            {
+                search_begin = search_end;
+                search_end   = static_cast<size_t>(large_ids.end() - search_end) > step ? search_end + step : large_ids.end();
+                step        *= 2;
+            }
+
+            search_begin = std::lower_bound(search_begin, search_end, entity_id);
+            if (search_begin == large_ids.end())
+            {
+                break;
+            }
+
+            if (*search_begin == entity_id)
+            {
+                result.m_sorted_ids.push_back(entity_id);
+            }
+        }
+    }
+    else
+    {
+        std::set_intersection(
+            small_ids.begin(),
+            small_ids.end(),
+            large_ids.begin(),
+            large_ids.end(),
+            std::back_inserter(result.m_sorted_ids));
+    }
+
+    result.m_cardinality = result.m_sorted_ids.size();
+    result.Compact();
+    return std::move(result);
+}
+
+Jani::QueryEntitySet Jani::QueryEntitySet::Union(const QueryEntitySet& _a, const QueryEntitySet& _b)
+{
+    if (_a.m_cardinality == 0)
+    {
+        return _b;
+    }
+    else if (_b.m_cardinality == 0)
+    {
+        return _a;
+    }
+
+    QueryEntitySet result;
+
+    // Sorted x Sorted: linear merge
+    if (_a.m_representation == Representation::SortedIds && _b.m_representation == Representation::SortedIds)
+    {
+        result.m_sorted_ids.reserve(_a.m_sorted_ids.size() + _b.m_sorted_ids.size());
+        std::set_union(
+            _a.m_sorted_ids.begin(),
+            _a.m_sorted_ids.end(),
+            _b.m_sorted_ids.begin(),
+            _b.m_sorted_ids.end(),
+            std::back_inserter(result.m_sorted_ids));
+
+        result.m_cardinality = result.m_sorted_ids.size();
+        result.Compact();
+        return std::move(result);
+    }
+
+    // At least one bitmap: build a bitmap that covers both ranges and or everything into it
+    auto GetRange = [](const QueryEntitySet& _set) -> std::pair<EntityId, EntityId>
+    {
+        if (_set.m_representation == Representation::Bitmap)
+        {
+            return { _set.m_bitmap_base, _set.m_bitmap_base + _set.m_bitmap_words.size() * 64 };
+        }
+
+        return { _set.m_sorted_ids.front() & ~static_cast<EntityId>(63), (_set.m_sorted_ids.back() & ~static_cast<EntityId>(63)) + 64 };
+    };
+
+    auto a_range = GetRange(_a);
+    auto b_range = GetRange(_b);
+
+    result.m_representation = Representation::Bitmap;
+    result.m_bitmap_base    = std::min(a_range.first, b_range.first);
+    result.m_bitmap_words.resize((std::max(a_range.second, b_range.second) - result.m_bitmap_base) / 64, 0);
+
+    for (const QueryEntitySet* entity_set : { &_a, &_b })
+    {
+        if (entity_set->m_representation == Representation::Bitmap)
+        {
+            uint64_t offset = (entity_set->m_bitmap_base - result.m_bitmap_base) / 64;
+            for (uint64_t i = 0; i < entity_set->m_bitmap_words.size(); i++)
+            {
+                result.m_bitmap_words[offset + i] |= entity_set->m_bitmap_words[i];
+            }
+        }
+        else
+        {
+            for (auto entity_id : entity_set->m_sorted_ids)
+            {
+                uint64_t relative_id = entity_id - result.m_bitmap_base;
+                result.m_bitmap_words[relative_id / 64] |= uint64_t(1) << (relative_id % 64);
+            }
+        }
+    }
+
+    for (auto word : result.m_bitmap_words)
+    {
+        result.m_cardinality += PopCount(word);
+    }
+
+    result.Compact();
+    return std::move(result);
+}
+
+Jani::QueryEntitySet Jani::QueryEntitySet::Difference(const QueryEntitySet& _a, const QueryEntitySet& _b)
+{
+    if (_a.m_cardinality == 0 || _b.m_cardinality == 0)
+    {
+        return _a;
+    }
+
+    QueryEntitySet result;
+
+    if (_a.m_representation == Representation::SortedIds)
+    {
+        if (_b.m_representation == Representation::SortedIds)
+        {
+            std::set_difference(
+                _a.m_sorted_ids.begin(),
+                _a.m_sorted_ids.end(),
+                _b.m_sorted_ids.begin(),
+                _b.m_sorted_ids.end(),
+                std::back_inserter(result.m_sorted_ids));
+        }
+        else
+        {
+            for (auto entity_id : _a.m_sorted_ids)
+            {
+                if (!_b.Contains(entity_id))
+                {
+                    result.m_sorted_ids.push_back(entity_id);
+                }
+            }
+        }
+
+        result.m_cardinality = result.m_sorted_ids.size();
+        result.Compact();
+        return std::move(result);
+    }
+
+    // Bitmap minus something: clear the bits present on the right side
+    result = _a;
+    if (_b.m_representation == Representation::Bitmap)
+    {
+        EntityId begin = std::max(_a.m_bitmap_base, _b.m_bitmap_base);
+        EntityId end   = std::min(_a.m_bitmap_base + _a.m_bitmap_words.size() * 64, _b.m_bitmap_base + _b.m_bitmap_words.size() * 64);
+        for (EntityId word_begin = begin; word_begin < end; word_begin += 64)
+        {
+            result.m_bitmap_words[(word_begin - _a.m_bitmap_base) / 64] &= ~_b.m_bitmap_words[(word_begin - _b.m_bitmap_base) / 64];
+        }
+    }
+    else
+    {
+        for (auto entity_id : _b.m_sorted_ids)
+        {
+            if (entity_id >= result.m_bitmap_base && entity_id < result.m_bitmap_base + result.m_bitmap_words.size() * 64)
+            {
+                uint64_t relative_id = entity_id - result.m_bitmap_base;
+                result.m_bitmap_words[relative_id / 64] &= ~(uint64_t(1) << (relative_id % 64));
+            }
+        }
+    }
+
+    result.m_cardinality = 0;
+    for (auto word : result.m_bitmap_words)
+    {
+        result.m_cardinality += PopCount(word);
+    }
+
+    result.Compact();
+    return std::move(result);
+}
+
+bool Jani::QueryEntitySet::Contains(EntityId _entity_id) const
+{
+    if (m_representation == Representation::SortedIds)
+    {
+        return std::binary_search(m_sorted_ids.begin(), m_sorted_ids.end(), _entity_id);
+    }
+
+    if (_entity_id < m_bitmap_base || _entity_id >= m_bitmap_base + m_bitmap_words.size() * 64)
+    {
+        return false;
+    }
+
+    uint64_t relative_id = _entity_id - m_bitmap_base;
+    return (m_bitmap_words[relative_id / 64] & (uint64_t(1) << (relative_id % 64))) != 0;
+}
+
+uint64_t Jani::QueryEntitySet::GetCardinality() const
+{
+    return m_cardinality;
+}
+
+Jani::QueryEntitySet::Representation Jani::QueryEntitySet::GetRepresentation() const
+{
+    return m_representation;
+}
+
+void Jani::QueryEntitySet::Compact()
+{
+    if (m_cardinality == 0)
+    {
+        m_representation = Representation::SortedIds;
+        m_sorted_ids.clear();
+        m_bitmap_words.clear();
+        m_bitmap_base = 0;
+        return;
+    }
+
+    // A bitmap is only worth when it requires less memory than the id vector (one word per id)
+    if (m_representation == Representation::SortedIds)
+    {
+        uint64_t total_words = ((m_sorted_ids.back() & ~static_cast<EntityId>(63)) - (m_sorted_ids.front() & ~static_cast<EntityId>(63))) / 64 + 1;
+        if (m_cardinality >= MinimumBitmapCardinality && total_words < m_cardinality)
+        {
+            ConvertToBitmap();
+        }
+    }
+    else
+    {
+        // Trim empty words from both ends before deciding
+        uint64_t first_word = 0;
+        uint64_t last_word  = m_bitmap_words.size();
+        while (first_word < last_word && m_bitmap_words[first_word] == 0)
+        {
+            first_word++;
+        }
+        while (last_word > first_word && m_bitmap_words[last_word - 1] == 0)
+        {
+            last_word--;
+        }
+
+        if (first_word != 0 || last_word != m_bitmap_words.size())
+        {
+            m_bitmap_words.erase(m_bitmap_words.begin() + last_word, m_bitmap_words.end());
+            m_bitmap_words.erase(m_bitmap_words.begin(), m_bitmap_words.begin() + first_word);
+            m_bitmap_base += first_word * 64;
+        }
+
+        if (m_cardinality < MinimumBitmapCardinality || m_bitmap_words.size() >= m_cardinality)
+        {
+            ConvertToSortedIds();
+        }
+    }
+}
+
+void Jani::QueryEntitySet::ConvertToBitmap()
+{
+    m_bitmap_base = m_sorted_ids.front() & ~static_cast<EntityId>(63);
+    m_bitmap_words.clear();
+    m_bitmap_words.resize(((m_sorted_ids.back() & ~static_cast<EntityId>(63)) - m_bitmap_base) / 64 + 1, 0);
+
+    for (auto entity_id : m_sorted_ids)
+    {
+        uint64_t relative_id = entity_id - m_bitmap_base;
+        m_bitmap_words[relative_id / 64] |= uint64_t(1) << (relative_id % 64);
+    }
+
+    m_sorted_ids.clear();
+    m_representation = Representation::Bitmap;
+}
+
+void Jani::QueryEntitySet::ConvertToSortedIds()
+{
+    nonstd::transient_vector<EntityId> sorted_ids;
+    sorted_ids.reserve(m_cardinality);
+
+    ForEach(
+        [&](EntityId _entity_id)
+        {
+            sorted_ids.push_back(_entity_id);
+        });
+
+    m_sorted_ids = std::move(sorted_ids);
+    m_bitmap_words.clear();
+    m_bitmap_base    = 0;
+    m_representation = Representation::SortedIds;
+}
+
+uint32_t Jani::QueryEntitySet::LowestBitIndex(uint64_t _isolated_bit)
+{
+    // De Bruijn multiplication, _isolated_bit must have exactly one bit set
+    static const uint32_t debruijn_table[64] =
+    {
+         0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6
+    };
+
+    return debruijn_table[(_isolated_bit * 0x03f79d71b4cb0a89ull) >> 58];
+}
+
+uint32_t Jani::QueryEntitySet::PopCount(uint64_t _value)
+{
+    return static_cast<uint32_t>(std::bitset<64>(_value).count());
+}
@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////
+// Filename: JaniRuntimeQuerySet.h
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+//////////////
+// INCLUDES //
+//////////////
+#include "JaniInternal.h"
+#include "JaniRuntimeThreadContext.h"
+
+///////////////
+// NAMESPACE //
+///////////////
+
+// Jani
+JaniNamespaceBegin(Jani)
+
+////////////////////////////////////////////////////////////////////////////////
+// Class name: QueryEntitySet
+////////////////////////////////////////////////////////////////////////////////
+class QueryEntitySet
+{
+public:
+
+    /*
+    * The internal representation used by a set, sparse sets are stored as a sorted id vector
+    * while dense ones are stored as a bitmap that starts at a 64 aligned base id
+    */
+    enum class Representation
+    {
+        SortedIds,
+        Bitmap
+    };
+
+    /*
+    * When the size ratio between two sorted sets is bigger than this value the intersection
+    * will use a galloping (exponential) search instead of a linear merge
+    */
+    static const uint32_t GallopingRatioThreshold = 32;
+
+    /*
+    * The minimum number of entries a set must have before a bitmap is considered
+    */
+    static const uint32_t MinimumBitmapCardinality = 64;
+
+//////////////////////////
+public: // CONSTRUCTORS //
+//////////////////////////
+
+    QueryEntitySet();
+
+    /*
+    * Create a set from a vector of ids, the vector doesn't need to be sorted but it
+    * must not contain duplicated entries
+    */
+    static QueryEntitySet FromIds(nonstd::transient_vector<EntityId>&& _ids, bool _is_sorted = false);
+
+//////////////////////////
+public: // MAIN METHODS //
+//////////////////////////
+
+    /*
+    * Set operations, each one selects the cheapest algorithm depending on the representation
+    * of both operands and returns a set already compacted into its best representation
+    */
+    static QueryEntitySet Intersection(const QueryEntitySet& _a, const QueryEntitySet& _b);
+    static QueryEntitySet Union(const QueryEntitySet& _a, const QueryEntitySet& _b);
+    static QueryEntitySet Difference(const QueryEntitySet& _a, const QueryEntitySet& _b);
+
+    /*
+    * Return if the given entity id is part of this set
+    */
+    bool Contains(EntityId _entity_id) const;
+
+    /*
+    * Return the total number of entities inside this set
+    */
+    uint64_t GetCardinality() const;
+
+    /*
+    * Return the current representation
+    */
+    Representation GetRepresentation() const;
+
+    /*
+    * Call the given callback for each entity id inside this set, in ascending order
+    */
+    template <typename CallbackType>
+    void ForEach(CallbackType&& _callback) const
+    {
+        if (m_representation == Representation::SortedIds)
+        {
+            for (auto entity_id : m_sorted_ids)
+            {
+                _callback(entity_id);
+            }
+        }
+        else
+        {
+            for (uint64_t word_index = 0; word_index < m_bitmap_words.size(); word_index++)
+            {
+                uint64_t word = m_bitmap_words[word_index];
+                while (word != 0)
+                {
+                    uint64_t lowest_bit = word & (~word + 1);
+                    _callback(m_bitmap_base + word_index * 64 + LowestBitIndex(lowest_bit));
+                    word ^= lowest_bit;
+                }
+            }
+        }
+    }
+
+private:
+
+    /*
+    * Select the best representation for the current content, converting if necessary
+    */
+    void Compact();
+
+    /*
+    * Convert between representations
+    */
+    void ConvertToBitmap();
+    void ConvertToSortedIds();
+
+    /*
+    * Return the index of the only bit set on the given value
+    */
+    static uint32_t LowestBitIndex(uint64_t _isolated_bit);
+
+    /*
+    * Return the number of bits set on the given value
+    */
+    static uint32_t PopCount(uint64_t _value);
+
+////////////////////////
+private: // VARIABLES //
+////////////////////////
+
+    Representation                     m_representation = Representation::SortedIds;
+    nonstd::transient_vector<EntityId> m_sorted_ids;
+    EntityId                           m_bitmap_base    = 0;
+    nonstd::transient_vector<uint64_t> m_bitmap_words;
+    uint64_t                           m_cardinality    = 0;
+};
+
+// Jani
+JaniNamespaceEnd(Jani)
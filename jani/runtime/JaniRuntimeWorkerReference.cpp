@@ -50,7 +50,39 @@ Jani::WorkerType Jani::RuntimeWorkerReference::GetType() const
 
 std::pair<uint64_t, uint64_t> Jani::RuntimeWorkerReference::GetNetworkTrafficPerSecond() const
 {
-    return { m_total_data_received_per_second, m_total_data_sent_per_second };
+    return { m_load_report.total_data_received_per_second, m_load_report.total_data_sent_per_second };
+}
+
+const Jani::RuntimeWorkerReference::LoadReport& Jani::RuntimeWorkerReference::GetLoadReport() const
+{
+    return m_load_report;
+}
+
+void Jani::RuntimeWorkerReference::SetInterests(std::vector<WorkerInterest> _interests)
+{
+    m_interests = std::move(_interests);
+    m_interests_last_evaluation.clear();
+    m_interests_last_evaluation.resize(m_interests.size(), std::chrono::time_point<std::chrono::steady_clock>());
+}
+
+const std::vector<Jani::WorkerInterest>& Jani::RuntimeWorkerReference::GetInterests() const
+{
+    return m_interests;
+}
+
+bool Jani::RuntimeWorkerReference::ConsumeInterestEvaluation(uint32_t _interest_index, std::chrono::time_point<std::chrono::steady_clock> _time_now)
+{
+    assert(_interest_index < m_interests.size());
+
+    auto update_period = std::chrono::milliseconds(1000 / std::max(1u, static_cast<uint32_t>(m_interests[_interest_index].frequency)));
+    if (_time_now - m_interests_last_evaluation[_interest_index] < update_period)
+    {
+        return false;
+    }
+
+    m_interests_last_evaluation[_interest_index] = _time_now;
+
+    return true;
 }
 
 void Jani::RuntimeWorkerReference::ProcessRequest(const RequestInfo& _request, const RequestPayload& _request_payload, ResponsePayload& _response_payload)
@@ -162,8 +194,23 @@ void Jani::RuntimeWorkerReference::ProcessRequest(const RequestInfo& _request, c
         {
             auto component_report_acknowledge_request = _request_payload.GetRequest<Message::RuntimeWorkerReportAcknowledgeRequest>();
 
-            m_total_data_received_per_second = component_report_acknowledge_request.total_data_received_per_second;
-            m_total_data_sent_per_second     = component_report_acknowledge_request.total_data_sent_per_second;
+            m_load_report.report_index++;
+            m_load_report.total_data_received_per_second = component_report_acknowledge_request.total_data_received_per_second;
+            m_load_report.total_data_sent_per_second     = component_report_acknowledge_request.total_data_sent_per_second;
+            m_load_report.average_frame_time_us          = component_report_acknowledge_request.average_frame_time_us;
+            m_load_report.maximum_frame_time_us          = component_report_acknowledge_request.maximum_frame_time_us;
+            m_load_report.cpu_usage                      = component_report_acknowledge_request.cpu_usage;
+
+            break;
+        }
+        case RequestType::RuntimeLayerAuthorityHandoffAcknowledge:
+        {
+            auto handoff_acknowledge_request = _request_payload.GetRequest<Message::RuntimeLayerAuthorityHandoffAcknowledgeRequest>();
+
+            bool result = m_bridge.OnWorkerLayerAuthorityHandoffAcknowledge(
+                *this,
+                m_client_hash,
+                handoff_acknowledge_request.entity_ids);
 
             break;
         }
@@ -180,6 +227,35 @@ void Jani::RuntimeWorkerReference::ProcessRequest(const RequestInfo& _request, c
 
             break;
         }
+        case RequestType::RuntimeWorkerInterestUpdate:
+        {
+            auto worker_interest_update_request = _request_payload.GetRequest<Message::RuntimeWorkerInterestUpdateRequest>();
+
+            bool result = m_bridge.OnWorkerInterestUpdate(
+                *this,
+                m_client_hash,
+                std::move(worker_interest_update_request.interests));
+
+            break;
+        }
+        case RequestType::RuntimeAggregateQuery:
+        {
+            auto aggregate_query_request = _request_payload.GetRequest<Message::RuntimeAggregateQueryRequest>();
+
+            auto result = m_bridge.OnWorkerAggregateQuery(
+                *this,
+                m_client_hash,
+                aggregate_query_request.query);
+
+            Message::RuntimeAggregateQueryResponse response;
+            response.succeed = result.has_value();
+            response.result  = result ? std::move(result.value()) : AggregateQueryResult();
+            {
+                _response_payload.PushResponse(std::move(response));
+            }
+
+            break;
+        }
         default:
         {
             Jani::MessageLog().Error("RuntimeWorkerReference -> Unknown request type received by worker instance");
@@ -30,6 +30,22 @@ class RuntimeWorkerReference
         std::optional<EntityId>  extreme_bottom_entity;
     };
 
+public:
+
+    /*
+    * The last load report sent by the worker, the report index is incremented each time a new one
+    * is received (0 means no report was received yet)
+    */
+    struct LoadReport
+    {
+        uint32_t report_index                   = 0;
+        uint32_t average_frame_time_us          = 0;
+        uint32_t maximum_frame_time_us          = 0;
+        float    cpu_usage                      = 0.0f;
+        uint64_t total_data_received_per_second = 0;
+        uint64_t total_data_sent_per_second     = 0;
+    };
+
 //////////////////////////
 public: // CONSTRUCTORS //
 //////////////////////////
@@ -75,6 +91,23 @@ public: // MAIN METHODS //
     */
     std::pair<uint64_t, uint64_t> GetNetworkTrafficPerSecond() const;
 
+    /*
+    * Return the last load report sent by this worker
+    */
+    const LoadReport& GetLoadReport() const;
+
+    /*
+    * Set/return the interest regions registered by this worker
+    */
+    void                               SetInterests(std::vector<WorkerInterest> _interests);
+    const std::vector<WorkerInterest>& GetInterests() const;
+
+    /*
+    * Return if the interest at the given index is due to be evaluated, marking it as evaluated
+    * when it's the case
+    */
+    bool ConsumeInterestEvaluation(uint32_t _interest_index, std::chrono::time_point<std::chrono::steady_clock> _time_now);
+
     /*
     * This function will process a request from the counterpart worker and attempt to resolve it, returning
     * a response whenever applicable
@@ -91,8 +124,10 @@ private: // VARIABLES //
     WorkerType               m_type;
     bool                     m_use_spatial_area    = false;
 
-    uint64_t m_total_data_received_per_second = 0;
-    uint64_t m_total_data_sent_per_second     = 0;
+    LoadReport m_load_report;
+
+    std::vector<WorkerInterest>                                     m_interests;
+    std::vector<std::chrono::time_point<std::chrono::steady_clock>> m_interests_last_evaluation;
 };
 
 // Jani
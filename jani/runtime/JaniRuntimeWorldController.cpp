@@ -27,6 +27,12 @@ bool Jani::RuntimeWorldController::Initialize()
         return false;
     }
 
+    // Grid 0 uses the deployment resolution, each other layer cell size adds its own grid
+    GridInfo default_grid_info;
+    default_grid_info.cell_length    = m_deployment_config.GetWorkerLength();
+    default_grid_info.grids_per_line = m_deployment_config.GetTotalGridsPerWorldLine();
+    m_grids.push_back(std::move(default_grid_info));
+
     auto& layer_collection_infos = m_layer_config.GetLayers();
     LayerId layer_id_count = 0;
     for (auto& [layer_id, layer_collection_info] : layer_collection_infos)
@@ -39,18 +45,67 @@ bool Jani::RuntimeWorldController::Initialize()
         layer_info.maximum_workers             = layer_collection_info.maximum_workers;
         layer_info.layer_id                    = layer_id_count++;
 
+        if (layer_collection_info.cell_size && layer_collection_info.cell_size.value() != m_grids[0].cell_length)
+        {
+            uint32_t cell_size = layer_collection_info.cell_size.value();
+            if (m_deployment_config.GetMaximumWorldLength() % cell_size != 0)
+            {
+                Jani::MessageLog().Error("WorldController -> Layer {} cell size {} must divide the maximum world length {}", layer_collection_info.name, cell_size, m_deployment_config.GetMaximumWorldLength());
+                return false;
+            }
+
+            auto grid_iter = std::find_if(m_grids.begin(), m_grids.end(), [&](const GridInfo& _grid_info) { return _grid_info.cell_length == cell_size; });
+            if (grid_iter == m_grids.end())
+            {
+                if (m_grids.size() >= MaximumGridResolutions)
+                {
+                    Jani::MessageLog().Error("WorldController -> Layer {} requires a new grid resolution but the maximum of {} was reached", layer_collection_info.name, MaximumGridResolutions);
+                    return false;
+                }
+
+                GridInfo grid_info;
+                grid_info.cell_length    = cell_size;
+                grid_info.grids_per_line = m_deployment_config.GetMaximumWorldLength() / cell_size;
+                m_grids.push_back(std::move(grid_info));
+
+                grid_iter = std::prev(m_grids.end());
+            }
+
+            layer_info.grid_index = static_cast<uint32_t>(std::distance(m_grids.begin(), grid_iter));
+        }
+
         m_layer_infos[layer_id] = std::move(layer_info);
     }
     
-    m_world_grid = std::make_unique<EntitySparseGrid<WorldCellInfo>>(m_deployment_config.GetMaximumWorldLength());
+    for (auto& grid_info : m_grids)
+    {
+        // Positions on the far world border map one cell past the last line, the dimension must also be a
+        // multiple of the grid bucket size
+        uint32_t bucket_dim_size = EntitySparseGrid<WorldCellInfo>::BucketDimSize;
+        uint32_t grid_dim_size   = ((grid_info.grids_per_line + 1 + bucket_dim_size - 1) / bucket_dim_size) * bucket_dim_size;
+
+        while (grid_info.curve_dim_size < grid_info.grids_per_line + 1)
+        {
+            grid_info.curve_dim_size *= 2;
+        }
+
+        grid_info.grid = std::make_unique<EntitySparseGrid<WorldCellInfo>>(grid_dim_size, m_deployment_config.GetWorldGridLayout());
+    }
 
     return true;
 }
 
 void Jani::RuntimeWorldController::Update()
 {
+    m_current_time_ms             = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_initial_timestamp).count();
+    m_update_index++;
+    m_migrated_entities_on_update = 0;
+    m_migrated_bytes_on_update    = 0;
+
     ValidateLayersWithoutWorkers();
 
+    ApplyCellMerges();
+
     ApplySpatialBalance();
 
     // Balance each layer that doesn't use spatial area
@@ -89,29 +144,37 @@ bool Jani::RuntimeWorldController::AddWorkerForLayer(std::unique_ptr<RuntimeWork
     worker_info.worker_cells_infos.worker_instance = worker_info.worker_instance.get();
 
     WorkerId worker_id = worker_info.worker_instance->GetId();
-    auto density_key = worker_info.GetDensityKey();
 
     auto insert_iter = layer_info.value().worker_instances.insert({ worker_id, std::move(worker_info) });
-    layer_info.value().ordered_worker_density_info.insert({ density_key, &insert_iter.first->second });
+    layer_info.value().worker_density_heap.Push(insert_iter.first->second);
+    layer_info.value().requires_repartition = true;
 
     // Perform dummy worker migrations, whenever required
-    if (layer_info->dummy_layer_worker_instance.worker_cells_infos.coordinates_owned.size() != 0)
+    auto& dummy_worker_cells_infos = layer_info->dummy_layer_worker_instance.worker_cells_infos;
+    if (dummy_worker_cells_infos.coordinates_owned.size() != 0 || dummy_worker_cells_infos.sub_cells_owned.size() != 0)
     {
-        for (auto& cell_coordinates : layer_info->dummy_layer_worker_instance.worker_cells_infos.coordinates_owned)
+        auto MigrateDummyCell = [&](WorldCellInfo& _cell_info)
         {
-            auto& cell_info = m_world_grid->AtMutable(cell_coordinates);
-
             MigrateEntitiesFromCellToNewWorker(
                 layer_info.value(), 
-                cell_info,
+                _cell_info,
                 layer_info->dummy_layer_worker_instance, 
-                *layer_info->ordered_worker_density_info.begin()->second, 
-                std::nullopt, 
-                layer_info->ordered_worker_density_info.begin()->first, 
+                layer_info->worker_density_heap.Top(), 
                 false); // We are iterating over the dummy layer cells, clear only after we finish
+        };
+
+        for (auto cell_coordinates : dummy_worker_cells_infos.coordinates_owned)
+        {
+            MigrateDummyCell(m_grids[layer_info->grid_index].grid->AtMutable(cell_coordinates));
+        }
+
+        for (auto* sub_cell_info : dummy_worker_cells_infos.sub_cells_owned)
+        {
+            MigrateDummyCell(*sub_cell_info);
         }
 
-        layer_info->dummy_layer_worker_instance.worker_cells_infos.coordinates_owned.clear();
+        dummy_worker_cells_infos.coordinates_owned.clear();
+        dummy_worker_cells_infos.sub_cells_owned.clear();
     }
 
     return true;
@@ -146,54 +209,89 @@ bool Jani::RuntimeWorldController::HandleWorkerDisconnection(WorkerId _worker_id
         return true;
     }
 
+    // The previous worker on the curve takes over the range until the next repartition
+    auto& curve_ranges = layer_info.curve_ranges;
+    curve_ranges.erase(
+        std::remove_if(curve_ranges.begin(), curve_ranges.end(), [&](const std::pair<uint64_t, WorkerInfo*>& _curve_range) { return _curve_range.second == &worker_iter->second; }),
+        curve_ranges.end());
+    if (curve_ranges.size() > 0)
+    {
+        curve_ranges.front().first = 0;
+    }
+
+    layer_info.requires_repartition = true;
+
+    layer_info.worker_density_heap.Erase(worker_iter->second);
+
     auto worker_info_node = layer_info.worker_instances.extract(_worker_id);
     auto& worker_info     = worker_info_node.mapped();
-    
-    layer_info.ordered_worker_density_info.erase(WorkerDensityKey(worker_info.GetDensityKey()));
 
-    WorkerInfo*                     target_worker_info = nullptr;
-    std::optional<WorkerDensityKey> target_worker_density_key;
+    WorkerInfo* target_worker_info = nullptr;
     if (layer_info.worker_instances.size() == 0)
     {
         target_worker_info = &layer_info.dummy_layer_worker_instance;
     }
     else
     {
-        target_worker_info        = layer_info.ordered_worker_density_info.begin()->second;
-        target_worker_density_key = layer_info.ordered_worker_density_info.begin()->first;
+        target_worker_info = &layer_info.worker_density_heap.Top();
     }
 
-    for (auto& cell_coordinates : worker_info.worker_cells_infos.coordinates_owned)
+    auto MigrateDisconnectedWorkerCell = [&](WorldCellInfo& _cell_info)
     {
-        auto& cell_info                             = m_world_grid->AtMutable(cell_coordinates);
-        WorkerDensityKey current_worker_density_key = WorkerDensityKey(*cell_info.worker_cells_infos[_layer_id]);
-
         MigrateEntitiesFromCellToNewWorker(
             layer_info,
-            cell_info,
+            _cell_info,
             worker_info,
             *target_worker_info,
-            std::nullopt, 
-            target_worker_density_key,
             false); // We are iterating over the disconnected worker layer cells, clear only after we finish
 
-        // Update the target worker info and density key since they probably changed after this layer migration
+        // Update the target worker info since the least dense worker probably changed after this layer migration
         if (layer_info.worker_instances.size() != 0)
         {
-            target_worker_info        = layer_info.ordered_worker_density_info.begin()->second;
-            target_worker_density_key = layer_info.ordered_worker_density_info.begin()->first;
+            target_worker_info = &layer_info.worker_density_heap.Top();
         }
+    };
+
+    for (auto cell_coordinates : worker_info.worker_cells_infos.coordinates_owned)
+    {
+        MigrateDisconnectedWorkerCell(m_grids[layer_info.grid_index].grid->AtMutable(cell_coordinates));
+    }
+
+    for (auto* sub_cell_info : worker_info.worker_cells_infos.sub_cells_owned)
+    {
+        MigrateDisconnectedWorkerCell(*sub_cell_info);
     }
 
     worker_info.worker_cells_infos.coordinates_owned.clear();
+    worker_info.worker_cells_infos.sub_cells_owned.clear();
     worker_info.worker_cells_infos.worker_instance = nullptr;
 
     return true;
 }
 
-const Jani::WorldCellInfo& Jani::RuntimeWorldController::GetWorldCellInfo(WorldCellCoordinates _coordinates) const
+const Jani::WorldCellInfo& Jani::RuntimeWorldController::GetWorldCellInfo(WorldCellCoordinates _coordinates, uint32_t _grid_index) const
+{
+    return m_grids[_grid_index].grid->At(_coordinates);
+}
+
+uint32_t Jani::RuntimeWorldController::GetGridIndexForLayer(LayerId _layer_id) const
+{
+    if (_layer_id >= MaximumLayers || !m_layer_infos[_layer_id])
+    {
+        return 0;
+    }
+
+    return m_layer_infos[_layer_id]->grid_index;
+}
+
+uint32_t Jani::RuntimeWorldController::GetGridCellLength(uint32_t _grid_index) const
+{
+    return m_grids[_grid_index].cell_length;
+}
+
+std::optional<Jani::RuntimeWorkerReference*> Jani::RuntimeWorldController::GetEntityWorkerForLayer(const ServerEntity& _entity, LayerId _layer_id) const
 {
-    return m_world_grid->At(_coordinates);
+    return _entity.GetWorldCellInfo(GetGridIndexForLayer(_layer_id)).GetWorkerForLayer(_layer_id);
 }
 
 const std::unordered_map<Jani::WorkerId, Jani::RuntimeWorldController::WorkerInfo>& Jani::RuntimeWorldController::GetWorkersInfosForLayer(LayerId _layer_id) const
@@ -233,35 +331,56 @@ void Jani::RuntimeWorldController::InsertEntity(ServerEntity& _entity, WorldPosi
 {
     JaniTrace("WorldController -> InsertEntity() with entity_id {} and position ({},{})", _entity.GetId(), _position.x, _position.y);
 
-    WorldCellCoordinates cell_coordinates = ConvertPositionIntoCellCoordinates(_position);
+    // The entity is present on every grid, each one only defines the owners for the layers using it
+    for (uint32_t grid_index = 0; grid_index < m_grids.size(); grid_index++)
+    {
+        WorldCellCoordinates cell_coordinates = ConvertPositionIntoCellCoordinates(_position, grid_index);
+
+        SetupCell(cell_coordinates, grid_index);
 
-    SetupCell(cell_coordinates);
+        auto& cell_info = m_grids[grid_index].grid->AtMutable(cell_coordinates);
 
-    auto& cell_info = m_world_grid->AtMutable(cell_coordinates);
+        assert(cell_info.entities.find(_entity.GetId()) == cell_info.entities.end());
 
-    assert(cell_info.entities.find(_entity.GetId()) == cell_info.entities.end());
+        // If the cell is split, the entity sub cell defines its owners
+        auto& ownership_cell_info = ResolveOwnershipCell(cell_info, _position);
 
-    _entity.SetWorldCellInfo(cell_info);
+        _entity.SetWorldCellInfo(ownership_cell_info, grid_index);
 
-    // Do something about each worker that owns the given cell? (for each layer)
+        // Do something about each worker that owns the given cell? (for each layer)
 
-    cell_info.entities.insert({ _entity.GetId(), &_entity });
+        cell_info.entities.insert({ _entity.GetId(), &_entity });
+        if (&ownership_cell_info != &cell_info)
+        {
+            ownership_cell_info.entities.insert({ _entity.GetId(), &_entity });
+        }
 
-    SetupWorkCellEntityInsertion(cell_info);
+        SetupWorkCellEntityInsertion(ownership_cell_info);
+    }
 }
 
 void Jani::RuntimeWorldController::RemoveEntity(ServerEntity& _entity)
 {
     JaniTrace("WorldController -> RemoveEntity() with entity_id {}", _entity.GetId());
 
-    WorldCellCoordinates cell_coordinates = _entity.GetWorldCellCoordinates();
-    auto&                cell_info        = m_world_grid->AtMutable(cell_coordinates);
+    for (uint32_t grid_index = 0; grid_index < m_grids.size(); grid_index++)
+    {
+        auto& entity_cell_info    = _entity.GetWorldCellInfo(grid_index);
+        auto& cell_info           = m_grids[grid_index].grid->AtMutable(entity_cell_info.cell_coordinates);
+        auto& ownership_cell_info = cell_info.IsSplit() ? *cell_info.sub_cells[entity_cell_info.sub_cell_index] : cell_info;
+
+        // Do something about each worker that owns the given cell? (for each layer)
 
-    // Do something about each worker that owns the given cell? (for each layer)
+        cell_info.entities.erase(_entity.GetId());
+        if (&ownership_cell_info != &cell_info)
+        {
+            ownership_cell_info.entities.erase(_entity.GetId());
+        }
 
-    cell_info.entities.erase(_entity.GetId());
+        SetupWorkCellEntityRemoval(ownership_cell_info);
 
-    SetupWorkCellEntityRemoval(cell_info);
+        ReleaseCellIfEmpty(cell_info);
+    }
 }
 
 void Jani::RuntimeWorldController::SetupWorkCellEntityInsertion(WorldCellInfo& _cell_info, std::optional<LayerId> _layer)
@@ -277,16 +396,12 @@ void Jani::RuntimeWorldController::SetupWorkCellEntityInsertion(WorldCellInfo& _
             return;
         }
 
-        assert(layer_info->ordered_worker_density_info.size() > 0);
+        assert(layer_info->worker_density_heap.size() > 0);
 
-        auto& current_worker_cells_infos = _cell_info.worker_cells_infos[layer_info->layer_id];
-        auto extracted_worker_node       = layer_info->ordered_worker_density_info.extract(WorkerDensityKey(*current_worker_cells_infos));
-        {
-            extracted_worker_node.key().global_entity_count++;
-            extracted_worker_node.mapped()->worker_cells_infos.entity_count++;
-            extracted_worker_node.mapped()->worker_cells_infos.coordinates_owned.insert(_cell_info.cell_coordinates);
-        }
-        auto insert_iter = layer_info->ordered_worker_density_info.insert(std::move(extracted_worker_node));
+        auto& current_worker_cells_infos = *_cell_info.worker_cells_infos[layer_info->layer_id];
+        current_worker_cells_infos.entity_count++;
+        SetCellOwnership(current_worker_cells_infos, _cell_info, true);
+        layer_info->worker_density_heap.Update(current_worker_cells_infos);
     }
     else
     {
@@ -297,16 +412,18 @@ void Jani::RuntimeWorldController::SetupWorkCellEntityInsertion(WorldCellInfo& _
                 break;
             }
 
-            assert(layer_info->ordered_worker_density_info.size() > 0);
-
-            auto& current_worker_cells_infos = _cell_info.worker_cells_infos[layer_info->layer_id];
-            auto extracted_worker_node       = layer_info->ordered_worker_density_info.extract(WorkerDensityKey(*current_worker_cells_infos));
+            // Layers using another grid have their own cells
+            if (layer_info->grid_index != _cell_info.grid_index)
             {
-                extracted_worker_node.key().global_entity_count++;
-                extracted_worker_node.mapped()->worker_cells_infos.entity_count++;
-                extracted_worker_node.mapped()->worker_cells_infos.coordinates_owned.insert(_cell_info.cell_coordinates);
+                continue;
             }
-            auto insert_iter = layer_info->ordered_worker_density_info.insert(std::move(extracted_worker_node));
+
+            assert(layer_info->worker_density_heap.size() > 0);
+
+            auto& current_worker_cells_infos = *_cell_info.worker_cells_infos[layer_info->layer_id];
+            current_worker_cells_infos.entity_count++;
+            SetCellOwnership(current_worker_cells_infos, _cell_info, true);
+            layer_info->worker_density_heap.Update(current_worker_cells_infos);
         }
     }
 }
@@ -324,13 +441,9 @@ void Jani::RuntimeWorldController::SetupWorkCellEntityRemoval(WorldCellInfo& _ce
             return;
         }
 
-        auto& current_worker_cells_infos = _cell_info.worker_cells_infos[layer_info->layer_id];
-        auto extracted_worker_node       = layer_info->ordered_worker_density_info.extract(WorkerDensityKey(*current_worker_cells_infos));
-        {
-            extracted_worker_node.key().global_entity_count--;
-            extracted_worker_node.mapped()->worker_cells_infos.entity_count--;
-        }
-        auto insert_iter = layer_info->ordered_worker_density_info.insert(std::move(extracted_worker_node));
+        auto& current_worker_cells_infos = *_cell_info.worker_cells_infos[layer_info->layer_id];
+        current_worker_cells_infos.entity_count--;
+        layer_info->worker_density_heap.Update(current_worker_cells_infos);
     }
     else
     {
@@ -341,52 +454,39 @@ void Jani::RuntimeWorldController::SetupWorkCellEntityRemoval(WorldCellInfo& _ce
                 break;
             }
 
-            // We don't care about layers that don't use spatial info
-            if (!layer_info->uses_spatial_area)
+            // We don't care about layers that don't use spatial info or use another grid
+            if (!layer_info->uses_spatial_area || layer_info->grid_index != _cell_info.grid_index)
             {
                 continue;
             }
 
-            auto& current_worker_cells_infos = _cell_info.worker_cells_infos[layer_info->layer_id];
-            auto extracted_worker_node       = layer_info->ordered_worker_density_info.extract(WorkerDensityKey(*current_worker_cells_infos));
-            {
-                extracted_worker_node.key().global_entity_count--;
-                extracted_worker_node.mapped()->worker_cells_infos.entity_count--;
-            }
-            auto insert_iter = layer_info->ordered_worker_density_info.insert(std::move(extracted_worker_node));
+            auto& current_worker_cells_infos = *_cell_info.worker_cells_infos[layer_info->layer_id];
+            current_worker_cells_infos.entity_count--;
+            layer_info->worker_density_heap.Update(current_worker_cells_infos);
         }
     }
 
 }
 
 void Jani::RuntimeWorldController::MigrateEntitiesFromCellToNewWorker(
-    LayerInfo&                      _layer_info, 
-    WorldCellInfo&                  _cell_info,
-    WorkerInfo&                     _current_worker_info,
-    WorkerInfo&                     _target_worker_info, 
-    std::optional<WorkerDensityKey> _current_worker_density_key,
-    std::optional<WorkerDensityKey> _target_worker_density_key, 
-    bool                            _erase_from_current_worker)
+    LayerInfo&     _layer_info, 
+    WorldCellInfo& _cell_info,
+    WorkerInfo&    _current_worker_info,
+    WorkerInfo&    _target_worker_info, 
+    bool           _erase_from_current_worker)
 {
+    m_migrated_entities_on_update     += static_cast<uint32_t>(_cell_info.entities.size());
+    m_migrated_bytes_on_update        += GetCellMigrationSize(_layer_info, _cell_info);
+    _cell_info.last_migration_time_ms  = m_current_time_ms;
+
     _target_worker_info.worker_cells_infos.entity_count  += _cell_info.entities.size();
     _current_worker_info.worker_cells_infos.entity_count -= _cell_info.entities.size();
 
-    if(_erase_from_current_worker) _current_worker_info.worker_cells_infos.coordinates_owned.erase(_cell_info.cell_coordinates);
-    _target_worker_info.worker_cells_infos.coordinates_owned.insert(_cell_info.cell_coordinates);
- 
-    if (_current_worker_density_key)
-    {
-        auto over_capacity_extracted_worker_node                      = _layer_info.ordered_worker_density_info.extract(_current_worker_density_key.value());
-        over_capacity_extracted_worker_node.key().global_entity_count = _current_worker_info.worker_cells_infos.entity_count;
-        _layer_info.ordered_worker_density_info.insert(std::move(over_capacity_extracted_worker_node));
-    }
+    if(_erase_from_current_worker) SetCellOwnership(_current_worker_info.worker_cells_infos, _cell_info, false);
+    SetCellOwnership(_target_worker_info.worker_cells_infos, _cell_info, true);
 
-    if (_target_worker_density_key)
-    {
-        auto target_extracted_worker_node                      = _layer_info.ordered_worker_density_info.extract(_target_worker_density_key.value());
-        target_extracted_worker_node.key().global_entity_count = _target_worker_info.worker_cells_infos.entity_count;
-        _layer_info.ordered_worker_density_info.insert(std::move(target_extracted_worker_node));
-    }
+    _layer_info.worker_density_heap.Update(_current_worker_info.worker_cells_infos);
+    _layer_info.worker_density_heap.Update(_target_worker_info.worker_cells_infos);
 
     _cell_info.worker_cells_infos[_layer_info.layer_id] = &_target_worker_info.worker_cells_infos;
 
@@ -401,18 +501,71 @@ void Jani::RuntimeWorldController::MigrateEntitiesFromCellToNewWorker(
 
 void Jani::RuntimeWorldController::AcknowledgeEntityPositionChange(ServerEntity& _entity, WorldPosition _new_position)
 {
-    WorldCellCoordinates current_world_cell_coordinates = _entity.GetWorldCellCoordinates();
-    WorldCellCoordinates new_world_cell_coordinates     = ConvertPositionIntoCellCoordinates(_new_position); // TODO: Fill this and remember to add a little padding so entities won't be moving between workers all the time
+    UpdateEntityMotion(_entity, _new_position);
+
+    for (uint32_t grid_index = 0; grid_index < m_grids.size(); grid_index++)
+    {
+        UpdateEntityGridCell(_entity, _new_position, grid_index);
+
+        // Done after the cell update, an entity that just changed cells is only predicted from its new one
+        PredictEntityGridCellCrossing(_entity, _new_position, grid_index);
+    }
+}
+
+void Jani::RuntimeWorldController::AcknowledgeEntityUpdate(const ServerEntity& _entity)
+{
+    for (uint32_t grid_index = 0; grid_index < m_grids.size(); grid_index++)
+    {
+        auto& entity_cell_info    = _entity.GetWorldCellInfo(grid_index);
+        auto& cell_info           = m_grids[grid_index].grid->AtMutable(entity_cell_info.cell_coordinates);
+        auto& ownership_cell_info = cell_info.IsSplit() ? *cell_info.sub_cells[entity_cell_info.sub_cell_index] : cell_info;
+
+        DecayCellActivity(ownership_cell_info);
+        ownership_cell_info.update_activity += 1.0f;
+    }
+}
+
+void Jani::RuntimeWorldController::UpdateEntityGridCell(ServerEntity& _entity, WorldPosition _new_position, uint32_t _grid_index)
+{
+    auto&                world_grid                     = *m_grids[_grid_index].grid;
+    auto&                entity_cell_info               = _entity.GetWorldCellInfo(_grid_index);
+    WorldCellCoordinates current_world_cell_coordinates = entity_cell_info.cell_coordinates;
+    WorldCellCoordinates new_world_cell_coordinates     = ConvertPositionIntoCellCoordinates(_new_position, _grid_index); // TODO: Fill this and remember to add a little padding so entities won't be moving between workers all the time
 
     if (current_world_cell_coordinates == new_world_cell_coordinates)
     {
+        // Inside a split cell the entity can still change its sub cell
+        auto& world_cell_info = world_grid.AtMutable(current_world_cell_coordinates);
+        if (!world_cell_info.IsSplit())
+        {
+            return;
+        }
+
+        auto&    current_sub_cell_info   = *world_cell_info.sub_cells[entity_cell_info.sub_cell_index];
+        auto&    new_sub_cell_info       = ResolveOwnershipCell(world_cell_info, _new_position);
+        uint32_t current_sub_cell_x      = current_sub_cell_info.sub_cell_index % SubCellDimSize;
+        uint32_t current_sub_cell_y      = current_sub_cell_info.sub_cell_index / SubCellDimSize;
+        auto     sub_cell_space_position = (ConvertPositionIntoCellSpace(_new_position, _grid_index) - glm::vec2(current_world_cell_coordinates.x, current_world_cell_coordinates.y)) * static_cast<float>(SubCellDimSize);
+
+        // Same tolerance idea used between cells, but in sub cell units
+        if (&current_sub_cell_info == &new_sub_cell_info
+            || (sub_cell_space_position.x > current_sub_cell_x - 0.2f 
+                && sub_cell_space_position.x < current_sub_cell_x + 1.2f 
+                && sub_cell_space_position.y > current_sub_cell_y - 0.2f 
+                && sub_cell_space_position.y < current_sub_cell_y + 1.2f))
+        {
+            return;
+        }
+
+        MoveEntityBetweenOwnershipCells(_entity, current_sub_cell_info, new_sub_cell_info);
+
         return;
     }
 
-    WorldPosition current_cell_world_position = ConvertCellCoordinatesIntoPosition(current_world_cell_coordinates);
-    WorldPosition new_cell_world_position     = ConvertCellCoordinatesIntoPosition(new_world_cell_coordinates);
+    WorldPosition current_cell_world_position = ConvertCellCoordinatesIntoPosition(current_world_cell_coordinates, _grid_index);
+    WorldPosition new_cell_world_position     = ConvertCellCoordinatesIntoPosition(new_world_cell_coordinates, _grid_index);
 
-    float half_cell_unit_length    = (m_deployment_config.GetMaximumWorldLength() / m_deployment_config.GetTotalGridsPerWorldLine()) / 2.0f;
+    float half_cell_unit_length    = m_grids[_grid_index].cell_length / 2.0f;
     float distance_to_current_cell = glm::distance(glm::vec2(current_cell_world_position.x + half_cell_unit_length, current_cell_world_position.y + half_cell_unit_length), glm::vec2(_new_position.x, _new_position.y));
     float distance_to_new_cell     = glm::distance(glm::vec2(new_cell_world_position.x + half_cell_unit_length, new_cell_world_position.y + half_cell_unit_length), glm::vec2(_new_position.x, _new_position.y));
 
@@ -422,20 +575,144 @@ void Jani::RuntimeWorldController::AcknowledgeEntityPositionChange(ServerEntity&
         return;
     }
 
-    JaniTrace("WorldController -> AcknowledgeEntityPositionChange() with entity_id {} from position ({},{}) to position ({},{})", _entity.GetId(), current_world_cell_coordinates.x, current_world_cell_coordinates.y, new_world_cell_coordinates.x, new_world_cell_coordinates.y);
+    JaniTrace("WorldController -> AcknowledgeEntityPositionChange() with entity_id {} on grid {} from position ({},{}) to position ({},{})", _entity.GetId(), _grid_index, current_world_cell_coordinates.x, current_world_cell_coordinates.y, new_world_cell_coordinates.x, new_world_cell_coordinates.y);
 
-    SetupCell(new_world_cell_coordinates);
+    SetupCell(new_world_cell_coordinates, _grid_index);
 
-    auto& current_world_cell_info = m_world_grid->AtMutable(current_world_cell_coordinates);
-    auto& new_world_cell_info     = m_world_grid->AtMutable(new_world_cell_coordinates);
+    auto& current_world_cell_info = world_grid.AtMutable(current_world_cell_coordinates);
+    auto& new_world_cell_info     = world_grid.AtMutable(new_world_cell_coordinates);
 
     assert(current_world_cell_info.entities.find(_entity.GetId()) != current_world_cell_info.entities.end());
     assert(new_world_cell_info.entities.find(_entity.GetId()) == new_world_cell_info.entities.end());
 
-    _entity.SetWorldCellInfo(new_world_cell_info);
+    auto& current_ownership_cell_info = current_world_cell_info.IsSplit() ? *current_world_cell_info.sub_cells[entity_cell_info.sub_cell_index] : current_world_cell_info;
+    auto& new_ownership_cell_info     = ResolveOwnershipCell(new_world_cell_info, _new_position);
+
+    MoveEntityBetweenOwnershipCells(_entity, current_ownership_cell_info, new_ownership_cell_info);
+}
+
+void Jani::RuntimeWorldController::UpdateEntityMotion(ServerEntity& _entity, WorldPosition _new_position)
+{
+    EntityMotion motion = _entity.GetMotion();
+
+    // First sample or the entity stopped moving for a while, start over without a velocity
+    if (motion.sample_time_ms == std::numeric_limits<uint64_t>::max() 
+        || m_current_time_ms - motion.sample_time_ms >= VelocityStaleInterval)
+    {
+        motion.sample_position = _new_position;
+        motion.sample_time_ms  = m_current_time_ms;
+        motion.velocity        = glm::vec2(0.0f, 0.0f);
+    }
+    // Positions received on the same controller update are accumulated into the next sample
+    else if (m_current_time_ms - motion.sample_time_ms >= VelocitySampleInterval)
+    {
+        float     elapsed_seconds = (m_current_time_ms - motion.sample_time_ms) / 1000.0f;
+        glm::vec2 displacement    = glm::vec2(_new_position.x - motion.sample_position.x, _new_position.y - motion.sample_position.y);
+
+        motion.velocity        = glm::mix(motion.velocity, displacement / elapsed_seconds, VelocitySmoothingFactor);
+        motion.sample_position = _new_position;
+        motion.sample_time_ms  = m_current_time_ms;
+    }
+    else
+    {
+        return;
+    }
+
+    _entity.SetMotion(motion);
+}
+
+void Jani::RuntimeWorldController::PredictEntityGridCellCrossing(const ServerEntity& _entity, WorldPosition _position, uint32_t _grid_index)
+{
+    auto& velocity        = _entity.GetMotion().velocity;
+    float horizon_seconds = m_deployment_config.GetMigrationPredictionHorizon() / 1000.0f;
+    if (horizon_seconds == 0.0f || (velocity.x == 0.0f && velocity.y == 0.0f))
+    {
+        return;
+    }
+
+    // Only crossings into a neighbour cell are predicted, anything further (like a teleport) would be a guess
+    float     cell_length  = static_cast<float>(m_grids[_grid_index].cell_length);
+    glm::vec2 displacement = velocity * horizon_seconds;
+    float     distance     = glm::length(displacement);
+    if (distance > cell_length)
+    {
+        displacement *= cell_length / distance;
+    }
+
+    WorldPosition predicted_position;
+    predicted_position.x = _position.x + static_cast<int32_t>(displacement.x);
+    predicted_position.y = _position.y + static_cast<int32_t>(displacement.y);
+
+    auto&                world_grid                       = *m_grids[_grid_index].grid;
+    auto&                current_ownership_cell_info      = _entity.GetWorldCellInfo(_grid_index);
+    WorldCellCoordinates predicted_world_cell_coordinates = ConvertPositionIntoCellCoordinates(predicted_position, _grid_index);
+
+    // A cell that was never set up has no owners yet, they are only assigned once an entity gets there
+    if (world_grid.IsCellEmpty(predicted_world_cell_coordinates))
+    {
+        return;
+    }
+
+    auto& predicted_ownership_cell_info = ResolveOwnershipCell(world_grid.AtMutable(predicted_world_cell_coordinates), predicted_position);
+    if (&predicted_ownership_cell_info == &current_ownership_cell_info)
+    {
+        return;
+    }
+
+    for (auto& layer_info : m_layer_infos)
+    {
+        if (!layer_info)
+        {
+            break;
+        }
+
+        // We don't care about layers that don't use spatial info or use another grid
+        if (!layer_info->uses_spatial_area || layer_info->grid_index != _grid_index)
+        {
+            continue;
+        }
+
+        auto* current_layer_worker   = current_ownership_cell_info.worker_cells_infos[layer_info->layer_id]->worker_instance;
+        auto* predicted_layer_worker = predicted_ownership_cell_info.worker_cells_infos[layer_info->layer_id]->worker_instance;
+
+        // Nothing to pre stage with the dummy worker on either side
+        if (!current_layer_worker || !predicted_layer_worker || current_layer_worker == predicted_layer_worker)
+        {
+            continue;
+        }
+
+        assert(m_entity_layer_ownership_predict_callback);
+        m_entity_layer_ownership_predict_callback(
+            _entity, 
+            layer_info->layer_id, 
+            *current_layer_worker, 
+            *predicted_layer_worker);
+    }
+}
+
+void Jani::RuntimeWorldController::MoveEntityBetweenOwnershipCells(ServerEntity& _entity, WorldCellInfo& _current_cell_info, WorldCellInfo& _new_cell_info)
+{
+    auto& current_world_cell_info = _current_cell_info.parent_cell ? *_current_cell_info.parent_cell : _current_cell_info;
+    auto& new_world_cell_info     = _new_cell_info.parent_cell ? *_new_cell_info.parent_cell : _new_cell_info;
+
+    _entity.SetWorldCellInfo(_new_cell_info, _new_cell_info.grid_index);
+
+    // Split cells keep all their entities, so only sub cells entity maps change when moving inside one
+    if (&current_world_cell_info != &new_world_cell_info)
+    {
+        current_world_cell_info.entities.erase(_entity.GetId());
+        new_world_cell_info.entities.insert({ _entity.GetId(), &_entity });
+    }
+
+    if (_current_cell_info.parent_cell)
+    {
+        _current_cell_info.entities.erase(_entity.GetId());
+    }
 
-    current_world_cell_info.entities.erase(_entity.GetId());
-    new_world_cell_info.entities.insert({ _entity.GetId(), &_entity });
+    if (_new_cell_info.parent_cell)
+    {
+        _new_cell_info.entities.insert({ _entity.GetId(), &_entity });
+    }
 
     for (auto& layer_info : m_layer_infos)
     {
@@ -444,14 +721,14 @@ void Jani::RuntimeWorldController::AcknowledgeEntityPositionChange(ServerEntity&
             break;
         }
 
-        // We don't care about layers that don't use spatial info
-        if (!layer_info->uses_spatial_area)
+        // We don't care about layers that don't use spatial info or use another grid
+        if (!layer_info->uses_spatial_area || layer_info->grid_index != _new_cell_info.grid_index)
         {
             continue;
         }
 
-        auto* current_layer_worker = current_world_cell_info.worker_cells_infos[layer_info->layer_id]->worker_instance;
-        auto* new_layer_worker     = new_world_cell_info.worker_cells_infos[layer_info->layer_id]->worker_instance;
+        auto* current_layer_worker = _current_cell_info.worker_cells_infos[layer_info->layer_id]->worker_instance;
+        auto* new_layer_worker     = _new_cell_info.worker_cells_infos[layer_info->layer_id]->worker_instance;
 
         assert(current_layer_worker);
         assert(new_layer_worker);
@@ -464,8 +741,8 @@ void Jani::RuntimeWorldController::AcknowledgeEntityPositionChange(ServerEntity&
             continue;
         }
 
-        SetupWorkCellEntityInsertion(new_world_cell_info, layer_info->layer_id);
-        SetupWorkCellEntityRemoval(current_world_cell_info, layer_info->layer_id);
+        SetupWorkCellEntityInsertion(_new_cell_info, layer_info->layer_id);
+        SetupWorkCellEntityRemoval(_current_cell_info, layer_info->layer_id);
 
         assert(m_entity_layer_ownership_change_callback);
         m_entity_layer_ownership_change_callback(
@@ -474,23 +751,51 @@ void Jani::RuntimeWorldController::AcknowledgeEntityPositionChange(ServerEntity&
             *current_layer_worker, 
             *new_layer_worker);
     }
+
+    if (&current_world_cell_info != &new_world_cell_info)
+    {
+        ReleaseCellIfEmpty(current_world_cell_info);
+    }
+}
+
+void Jani::RuntimeWorldController::ReleaseCellIfEmpty(WorldCellInfo& _cell_info)
+{
+    if (_cell_info.entities.size() > 0 || _cell_info.IsSplit() || _cell_info.parent_cell)
+    {
+        return;
+    }
+
+    JaniTrace("WorldController -> ReleaseCellIfEmpty() at position ({},{}) on grid {}", _cell_info.cell_coordinates.x, _cell_info.cell_coordinates.y, _cell_info.grid_index);
+
+    // The owners (including the dummy worker) only know the cell by its coordinates
+    for (auto* worker_cells_infos : _cell_info.worker_cells_infos)
+    {
+        if (worker_cells_infos)
+        {
+            SetCellOwnership(*worker_cells_infos, _cell_info, false);
+        }
+    }
+
+    m_grids[_cell_info.grid_index].grid->Clear(_cell_info.cell_coordinates);
 }
 
-void Jani::RuntimeWorldController::SetupCell(WorldCellCoordinates _cell_coordinates)
+void Jani::RuntimeWorldController::SetupCell(WorldCellCoordinates _cell_coordinates, uint32_t _grid_index)
 {
-    if (m_world_grid->IsCellEmpty(_cell_coordinates))
+    auto& world_grid = *m_grids[_grid_index].grid;
+    if (world_grid.IsCellEmpty(_cell_coordinates))
     {
-        m_world_grid->Set(_cell_coordinates, WorldCellInfo());
+        world_grid.Set(_cell_coordinates, WorldCellInfo());
     }
     else
     {
         return;
     }
 
-    JaniTrace("WorldController -> SetupCell() at position ({},{}) to position ({},{})", _cell_coordinates.x, _cell_coordinates.y);
+    JaniTrace("WorldController -> SetupCell() at position ({},{}) on grid {}", _cell_coordinates.x, _cell_coordinates.y, _grid_index);
 
-    auto& cell_info            = m_world_grid->AtMutable(_cell_coordinates);
+    auto& cell_info            = world_grid.AtMutable(_cell_coordinates);
     cell_info.cell_coordinates = _cell_coordinates;
+    cell_info.grid_index       = _grid_index;
 
     for (int i = 0; i < cell_info.worker_cells_infos.size(); i++)
     {
@@ -500,31 +805,39 @@ void Jani::RuntimeWorldController::SetupCell(WorldCellCoordinates _cell_coordina
             break;
         }
 
+        // Layers using another grid never own cells on this one
+        if (layer_info->grid_index != _grid_index)
+        {
+            continue;
+        }
+
         // This is a new cell, so there shouldn't be any worker that owns the cell
         assert(cell_info.worker_cells_infos[i] == nullptr);
 
         // If there are not workers available, use the dummy one
-        if (layer_info.value().ordered_worker_density_info.size() == 0)
+        if (layer_info.value().worker_density_heap.size() == 0)
         {
             layer_info->dummy_layer_worker_instance.worker_cells_infos.coordinates_owned.insert(_cell_coordinates);
 
             // Make the cell point to the right worker cells infos
             cell_info.worker_cells_infos[i] = &layer_info->dummy_layer_worker_instance.worker_cells_infos;
         }
+        // With curve partitioning the cell belongs to the worker whose range contains it
+        else if (auto* range_owner = FindCurveRangeOwner(layer_info.value(), _cell_coordinates))
+        {
+            range_owner->worker_cells_infos.coordinates_owned.insert(_cell_coordinates);
+
+            cell_info.worker_cells_infos[i] = &range_owner->worker_cells_infos;
+        }
         // Insert normally
         else
         {
-            /*
-            * Update the ordered worker density info (both the key and the entity count on the worker cells infos)
-            */
-            auto extracted_worker_node = layer_info->ordered_worker_density_info.extract(layer_info->ordered_worker_density_info.begin());
-            {
-                extracted_worker_node.mapped()->worker_cells_infos.coordinates_owned.insert(_cell_coordinates);
-            }
-            auto insert_iter = layer_info->ordered_worker_density_info.insert(std::move(extracted_worker_node));
+            // The new cell is empty so the least dense worker keeps its place on the density heap
+            auto& target_worker_info = layer_info->worker_density_heap.Top();
+            target_worker_info.worker_cells_infos.coordinates_owned.insert(_cell_coordinates);
 
             // Make the cell point to the right worker cells infos
-            cell_info.worker_cells_infos[i] = &insert_iter.position->second->worker_cells_infos;
+            cell_info.worker_cells_infos[i] = &target_worker_info.worker_cells_infos;
         }
     }
 }
@@ -539,12 +852,17 @@ void Jani::RuntimeWorldController::RegisterEntityLayerOwnershipChangeCallback(En
     m_entity_layer_ownership_change_callback = _callback;
 }
 
+void Jani::RuntimeWorldController::RegisterEntityLayerOwnershipPredictCallback(EntityLayerOwnershipPredictCallback _callback)
+{
+    m_entity_layer_ownership_predict_callback = _callback;
+}
+
 void Jani::RuntimeWorldController::RegisterWorkerLayerRequestCallback(WorkerLayerRequestCallback _callback)
 {
     m_worker_layer_request_callback = _callback;
 }
 
-Jani::WorldCellCoordinates Jani::RuntimeWorldController::ConvertPositionIntoCellCoordinates(WorldPosition _world_position) const
+Jani::WorldCellCoordinates Jani::RuntimeWorldController::ConvertPositionIntoCellCoordinates(WorldPosition _world_position, uint32_t _grid_index) const
 {
     auto maximum_world_length = m_deployment_config.GetMaximumWorldLength();
 
@@ -559,9 +877,7 @@ Jani::WorldCellCoordinates Jani::RuntimeWorldController::ConvertPositionIntoCell
     _world_position.x = std::max(_world_position.x, 0);
     _world_position.y = std::max(_world_position.y, 0);
 
-    assert(m_deployment_config.GetMaximumWorldLength() % m_deployment_config.GetTotalGridsPerWorldLine() == 0);
-
-    uint32_t cell_unit_length = m_deployment_config.GetMaximumWorldLength() / m_deployment_config.GetTotalGridsPerWorldLine();
+    uint32_t cell_unit_length = GetGridCellLength(_grid_index);
 
     _world_position.x /= cell_unit_length;
     _world_position.y /= cell_unit_length;
@@ -569,11 +885,9 @@ Jani::WorldCellCoordinates Jani::RuntimeWorldController::ConvertPositionIntoCell
     return _world_position;
 }
 
-Jani::WorldPosition Jani::RuntimeWorldController::ConvertCellCoordinatesIntoPosition(WorldPosition _cell_coordinates) const
+Jani::WorldPosition Jani::RuntimeWorldController::ConvertCellCoordinatesIntoPosition(WorldPosition _cell_coordinates, uint32_t _grid_index) const
 {
-    assert(m_deployment_config.GetMaximumWorldLength() % m_deployment_config.GetTotalGridsPerWorldLine() == 0);
-
-    uint32_t cell_unit_length = m_deployment_config.GetMaximumWorldLength() / m_deployment_config.GetTotalGridsPerWorldLine();
+    uint32_t cell_unit_length = GetGridCellLength(_grid_index);
 
     _cell_coordinates.x *= cell_unit_length;
     _cell_coordinates.y *= cell_unit_length;
@@ -589,13 +903,17 @@ Jani::WorldPosition Jani::RuntimeWorldController::ConvertCellCoordinatesIntoPosi
     return _cell_coordinates;
 }
 
-float Jani::RuntimeWorldController::ConvertWorldScalarIntoCellScalar(float _scalar) const
+glm::vec2 Jani::RuntimeWorldController::ConvertPositionIntoCellSpace(WorldPosition _world_position, uint32_t _grid_index) const
 {
-    auto maximum_world_length = m_deployment_config.GetMaximumWorldLength();
+    float cell_unit_length    = static_cast<float>(GetGridCellLength(_grid_index));
+    float world_origin_offset = m_deployment_config.UsesCentralizedWorldOrigin() ? m_deployment_config.GetMaximumWorldLength() / 2.0f : 0.0f;
 
-    assert(m_deployment_config.GetMaximumWorldLength() % m_deployment_config.GetTotalGridsPerWorldLine() == 0);
+    return (glm::vec2(_world_position) + world_origin_offset) / cell_unit_length;
+}
 
-    uint32_t cell_unit_length = m_deployment_config.GetMaximumWorldLength() / m_deployment_config.GetTotalGridsPerWorldLine();
+float Jani::RuntimeWorldController::ConvertWorldScalarIntoCellScalar(float _scalar, uint32_t _grid_index) const
+{
+    uint32_t cell_unit_length = GetGridCellLength(_grid_index);
 
     _scalar /= static_cast<float>(cell_unit_length);
 
@@ -604,10 +922,10 @@ float Jani::RuntimeWorldController::ConvertWorldScalarIntoCellScalar(float _scal
 
 void Jani::RuntimeWorldController::ForEachEntityOnRadius(WorldPosition _world_position, float _radius, std::function<void(EntityId, ServerEntity&, WorldCellCoordinates)> _callback) const
 {
-    WorldCellCoordinates cell_coordinates = ConvertPositionIntoCellCoordinates(_world_position);
-    float                cell_radius      = ConvertWorldScalarIntoCellScalar(_radius);
+    glm::vec2 cell_space_center = ConvertPositionIntoCellSpace(_world_position);
+    float     cell_radius       = ConvertWorldScalarIntoCellScalar(_radius);
 
-    auto selected_cells = m_world_grid->InsideRange(cell_coordinates, cell_radius);
+    auto selected_cells = m_grids[0].grid->InsideRange(cell_space_center, cell_radius);
     for (auto& cell : selected_cells)
     {
         for (auto& [entity_id, entity] : cell->entities)
@@ -622,157 +940,1354 @@ void Jani::RuntimeWorldController::ForEachEntityOnRadius(WorldPosition _world_po
 
 void Jani::RuntimeWorldController::ForEachEntityOnRect(WorldRect _world_rect, std::function<void(EntityId, ServerEntity&, WorldCellCoordinates)> _callback) const
 {
-    int32_t              cell_unit_length = m_deployment_config.GetMaximumWorldLength() / m_deployment_config.GetTotalGridsPerWorldLine();
-    WorldCellCoordinates rect_begin       = ConvertPositionIntoCellCoordinates(WorldPosition({ _world_rect.x, _world_rect.y }));
-    WorldCellCoordinates rect_size        = WorldCellCoordinates({ _world_rect.width / cell_unit_length, _world_rect.height / cell_unit_length });
-    WorldCellCoordinates rect_end         = WorldCellCoordinates({ rect_begin.x + rect_size.x, rect_begin.y + rect_size.y });
+    WorldCellCoordinates rect_begin = ConvertPositionIntoCellCoordinates(WorldPosition({ _world_rect.x, _world_rect.y }));
+    WorldCellCoordinates rect_end   = ConvertPositionIntoCellCoordinates(WorldPosition({ _world_rect.x + _world_rect.width, _world_rect.y + _world_rect.height }));
 
-    auto selected_cells = m_world_grid->InsideRectMutable(rect_begin, rect_end);
-    for (auto& cell : selected_cells)
-    {
-        for (auto& [entity_id, entity] : cell->entities)
+    m_grids[0].grid->ForEachActiveCellInRect(
+        rect_begin, 
+        rect_end, 
+        [&](WorldCellInfo& _cell)
         {
-            WorldPosition entity_world_pos = entity->GetWorldPosition();
-            if (entity_world_pos.x > _world_rect.x
-                && entity_world_pos.y > _world_rect.y
-                && entity_world_pos.x < _world_rect.x + _world_rect.width
-                && entity_world_pos.y < _world_rect.y + _world_rect.height)
+            for (auto& [entity_id, entity] : _cell.entities)
             {
-                _callback(entity_id, *entity, cell->cell_coordinates);
+                WorldPosition entity_world_pos = entity->GetWorldPosition();
+                if (entity_world_pos.x > _world_rect.x
+                    && entity_world_pos.y > _world_rect.y
+                    && entity_world_pos.x < _world_rect.x + _world_rect.width
+                    && entity_world_pos.y < _world_rect.y + _world_rect.height)
+                {
+                    _callback(entity_id, *entity, _cell.cell_coordinates);
+                }
             }
-        }
-    }
+        });
 }
 
-void Jani::RuntimeWorldController::ApplySpatialBalance()
+void Jani::RuntimeWorldController::ForEachEntityOnSegment(
+    WorldPosition                                                      _segment_begin,
+    WorldPosition                                                      _segment_end,
+    float                                                              _thickness,
+    uint32_t                                                           _max_hits,
+    std::function<void(EntityId, ServerEntity&, WorldCellCoordinates)> _callback) const
 {
-    for (auto& layer_info : m_layer_infos)
+    struct SegmentHit
     {
-        if (!layer_info)
-        {
-            break;
-        }
+        float                projection = 0.0f; // Distance from the segment begin to the entity projection on it
+        EntityId             entity_id  = InvalidEntityId;
+        ServerEntity*        entity     = nullptr;
+        WorldCellCoordinates cell_coordinates;
+    };
 
-        if (!layer_info->uses_spatial_area 
-            || layer_info->worker_instances.size() == 0
-            || (layer_info->worker_instances.size() == 1 && layer_info->maximum_workers == 1)) // If there is one instance and the limit is
-            // one, no balance is required/possible
+    auto CompareHits = [](const SegmentHit& _first, const SegmentHit& _second)
+    {
+        return _first.projection < _second.projection;
+    };
+
+    float     cell_unit_length     = static_cast<float>(m_grids[0].cell_length);
+    int32_t   total_grids_per_line = static_cast<int32_t>(m_grids[0].grids_per_line);
+    int32_t   cells_margin         = static_cast<int32_t>(std::ceil(_thickness / cell_unit_length));
+    glm::vec2 segment_begin        = glm::vec2(_segment_begin);
+    glm::vec2 segment_vector       = glm::vec2(_segment_end) - segment_begin;
+    float     segment_length       = glm::length(segment_vector);
+
+    // When limited, hits are kept on a max heap (by projection) holding the best max hits found so far
+    nonstd::transient_vector<SegmentHit>                                                                         hits;
+    nonstd::transient_unordered_set<WorldCellCoordinates, WorldCellCoordinatesHasher, WorldCellCoordinatesComparator> visited_cells;
+
+    auto VisitCell = [&](WorldCellCoordinates _cell_coordinates)
+    {
+        if (_cell_coordinates.x < 0 
+            || _cell_coordinates.y < 0 
+            || _cell_coordinates.x >= total_grids_per_line 
+            || _cell_coordinates.y >= total_grids_per_line
+            || m_grids[0].grid->IsCellEmpty(_cell_coordinates) 
+            || !visited_cells.insert(_cell_coordinates).second)
         {
-            continue;
+            return;
         }
 
-        // Determine if there is a worker instance that needs its excess to be distributed over other
-        // workers
-        WorkerInfo* worker_instance_over_limit = nullptr;
-        for (auto& [worker_id, worker_instance] : layer_info->worker_instances)
+        auto& cell = m_grids[0].grid->AtMutable(_cell_coordinates);
+        for (auto& [entity_id, entity] : cell.entities)
         {
-            if (worker_instance.worker_cells_infos.entity_count >= layer_info->maximum_entities_per_worker)
+            glm::vec2 entity_position = glm::vec2(entity->GetWorldPosition());
+            float     projection      = segment_length > 0.0f ? glm::clamp(glm::dot(entity_position - segment_begin, segment_vector) / segment_length, 0.0f, segment_length) : 0.0f;
+            glm::vec2 closest_point   = segment_length > 0.0f ? segment_begin + segment_vector * (projection / segment_length) : segment_begin;
+
+            if (glm::distance(entity_position, closest_point) > _thickness)
+            {
+                continue;
+            }
+
+            hits.push_back({ projection, entity_id, entity, cell.cell_coordinates });
+
+            if (_max_hits > 0)
             {
-                // Add a chance to not detect the current worker and move to another that is also over its capacity
-                // TODO: Add a better system to perform this
-                if (rand() % 2 == 0)
+                std::push_heap(hits.begin(), hits.end(), CompareHits);
+                if (hits.size() > _max_hits)
                 {
-                    continue;
+                    std::pop_heap(hits.begin(), hits.end(), CompareHits);
+                    hits.pop_back();
                 }
-
-                worker_instance_over_limit = &worker_instance;
-                break;
+            }
+        }
+    };
+
+    // Amanatides & Woo traversal in cell space, the parametric t goes from 0 (segment begin) to 1 (segment end)
+    glm::vec2            cell_space_begin = ConvertPositionIntoCellSpace(_segment_begin);
+    glm::vec2            cell_space_delta = segment_vector / cell_unit_length;
+    WorldCellCoordinates current_cell     = ConvertPositionIntoCellCoordinates(_segment_begin);
+    WorldCellCoordinates last_cell        = ConvertPositionIntoCellCoordinates(_segment_end);
+    int32_t              step_x           = cell_space_delta.x > 0.0f ? 1 : (cell_space_delta.x < 0.0f ? -1 : 0);
+    int32_t              step_y           = cell_space_delta.y > 0.0f ? 1 : (cell_space_delta.y < 0.0f ? -1 : 0);
+    float                t_delta_x        = step_x != 0 ? std::abs(1.0f / cell_space_delta.x) : std::numeric_limits<float>::max();
+    float                t_delta_y        = step_y != 0 ? std::abs(1.0f / cell_space_delta.y) : std::numeric_limits<float>::max();
+    float                t_max_x          = step_x > 0 ? (std::floor(cell_space_begin.x) + 1.0f - cell_space_begin.x) * t_delta_x 
+                                          : step_x < 0 ? (cell_space_begin.x - std::floor(cell_space_begin.x)) * t_delta_x 
+                                          : std::numeric_limits<float>::max();
+    float                t_max_y          = step_y > 0 ? (std::floor(cell_space_begin.y) + 1.0f - cell_space_begin.y) * t_delta_y 
+                                          : step_y < 0 ? (cell_space_begin.y - std::floor(cell_space_begin.y)) * t_delta_y 
+                                          : std::numeric_limits<float>::max();
+    int32_t              total_steps      = std::abs(last_cell.x - current_cell.x) + std::abs(last_cell.y - current_cell.y);
+
+    // Any entity on a cell not visited yet projects at least this far behind the next crossed cell entry
+    float unvisited_projection_slack = (cells_margin + 1) * cell_unit_length * glm::root_two<float>();
+
+    for (int32_t step = 0; step <= total_steps; step++)
+    {
+        for (int32_t x = current_cell.x - cells_margin; x <= current_cell.x + cells_margin; x++)
+        {
+            for (int32_t y = current_cell.y - cells_margin; y <= current_cell.y + cells_margin; y++)
+            {
+                VisitCell(WorldCellCoordinates({ x, y }));
             }
         }
 
-        if (worker_instance_over_limit == nullptr)
+        if (current_cell.x == last_cell.x && current_cell.y == last_cell.y)
         {
-            continue;
+            break;
         }
 
-        auto& worker_cells_infos = worker_instance_over_limit->worker_cells_infos;
+        float t_next = std::min(t_max_x, t_max_y);
 
-        bool too_many_entities_on_same_cell    = false;
-        bool not_enough_space_on_other_workers = false;
-        for (auto coordinates_iter = worker_cells_infos.coordinates_owned.begin(); coordinates_iter != worker_cells_infos.coordinates_owned.end(); )
+        // Early termination, no remaining cell can hold a hit closer than the ones already found
+        if (_max_hits > 0 
+            && hits.size() == _max_hits 
+            && hits.front().projection < t_next * segment_length - unvisited_projection_slack)
         {
-            auto  cell_coordinates = *coordinates_iter;
-            auto& cell_info        = m_world_grid->AtMutable(cell_coordinates);
-
-            assert(cell_info.worker_cells_infos[layer_info->layer_id]->worker_instance == worker_instance_over_limit->worker_instance.get());
+            break;
+        }
 
-            // Check if we reached our objective
-            if (worker_cells_infos.entity_count < layer_info->maximum_entities_per_worker)
-            {
-                break;
-            }
+        if (t_max_x < t_max_y)
+        {
+            current_cell.x += step_x;
+            t_max_x        += t_delta_x;
+        }
+        else
+        {
+            current_cell.y += step_y;
+            t_max_y        += t_delta_y;
+        }
+    }
+
+    if (_max_hits > 0)
+    {
+        std::sort_heap(hits.begin(), hits.end(), CompareHits);
+    }
+    else
+    {
+        std::sort(hits.begin(), hits.end(), CompareHits);
+    }
+
+    for (auto& hit : hits)
+    {
+        _callback(hit.entity_id, *hit.entity, hit.cell_coordinates);
+    }
+}
+
+void Jani::RuntimeWorldController::ForEachEntityOnWorkerCells(
+    const RuntimeWorkerReference&                                      _worker,
+    uint32_t                                                           _cells_margin,
+    std::function<void(EntityId, ServerEntity&, WorldCellCoordinates)> _callback) const
+{
+    LayerId layer_id = _worker.GetLayerId();
+    if (layer_id >= MaximumLayers || !m_layer_infos[layer_id])
+    {
+        return;
+    }
+
+    auto worker_info_iter = m_layer_infos[layer_id]->worker_instances.find(_worker.GetId());
+    if (worker_info_iter == m_layer_infos[layer_id]->worker_instances.end())
+    {
+        return;
+    }
+
+    // Owned coordinates are on the layer grid, so the margin and the visited cells are too
+    auto&   grid_info            = m_grids[m_layer_infos[layer_id]->grid_index];
+    int32_t total_grids_per_line = static_cast<int32_t>(grid_info.grids_per_line);
+    int32_t cells_margin         = static_cast<int32_t>(_cells_margin);
+
+    auto& worker_cells_infos = worker_info_iter->second.worker_cells_infos;
+
+    nonstd::transient_unordered_set<WorldCellCoordinates, WorldCellCoordinatesHasher, WorldCellCoordinatesComparator> visited_cells;
+    auto VisitCellsAround = [&](WorldCellCoordinates _owned_cell_coordinates)
+    {
+        for (int32_t x = _owned_cell_coordinates.x - cells_margin; x <= _owned_cell_coordinates.x + cells_margin; x++)
+        {
+            for (int32_t y = _owned_cell_coordinates.y - cells_margin; y <= _owned_cell_coordinates.y + cells_margin; y++)
+            {
+                if (x < 0 || y < 0 || x >= total_grids_per_line || y >= total_grids_per_line)
+                {
+                    continue;
+                }
+
+                WorldCellCoordinates cell_coordinates = WorldCellCoordinates({ x, y });
+                if (grid_info.grid->IsCellEmpty(cell_coordinates) || !visited_cells.insert(cell_coordinates).second)
+                {
+                    continue;
+                }
+
+                auto& cell = grid_info.grid->AtMutable(cell_coordinates);
+                for (auto& [entity_id, entity] : cell.entities)
+                {
+                    _callback(entity_id, *entity, cell.cell_coordinates);
+                }
+            }
+        }
+    };
+
+    for (auto owned_cell_coordinates : worker_cells_infos.coordinates_owned)
+    {
+        VisitCellsAround(owned_cell_coordinates);
+    }
+
+    // Without a margin only the entities inside the owned sub cells are selected, with one the margin already
+    // covers the whole split cell
+    for (auto* sub_cell_info : worker_cells_infos.sub_cells_owned)
+    {
+        if (cells_margin > 0)
+        {
+            VisitCellsAround(sub_cell_info->cell_coordinates);
+            continue;
+        }
+
+        for (auto& [entity_id, entity] : sub_cell_info->entities)
+        {
+            _callback(entity_id, *entity, sub_cell_info->cell_coordinates);
+        }
+    }
+}
+
+std::optional<Jani::AggregateQueryResult> Jani::RuntimeWorldController::PerformAggregateQuery(const AggregateQuery& _query) const
+{
+    AggregateQueryResult query_result;
+
+    // Resolve the attribute against the component schema, only attributes with a fixed offset can be read (never
+    // the case for serializable components, their payload doesn't follow the schema layout)
+    const LayerConfig::ComponentAttributeInfo* attribute_info = nullptr;
+    if (_query.type == AggregateQueryType::AttributeBounds)
+    {
+        attribute_info = m_layer_config.GetComponentAttribute(_query.attribute_component_id, _query.attribute_name);
+        if (!attribute_info || !attribute_info->offset || LayerConfig::GetAttributeTypeSize(attribute_info->type) == 0)
+        {
+            return std::nullopt;
+        }
+    }
+
+    WorldRect query_rect = _query.world_rect 
+        ? _query.world_rect.value() 
+        : WorldRect({
+            _query.center->x - static_cast<int32_t>(_query.radius),
+            _query.center->y - static_cast<int32_t>(_query.radius),
+            static_cast<int32_t>(_query.radius * 2),
+            static_cast<int32_t>(_query.radius * 2) });
+
+    auto IsInsideArea = [&](WorldPosition _position) -> bool
+    {
+        if (_query.world_rect)
+        {
+            return _position.x >= query_rect.x
+                && _position.y >= query_rect.y
+                && _position.x <= query_rect.x + query_rect.width
+                && _position.y <= query_rect.y + query_rect.height;
+        }
+
+        return glm::distance(glm::vec2(_query.center->x, _query.center->y), glm::vec2(_position)) <= static_cast<float>(_query.radius);
+    };
+
+    auto ReadAttributeValue = [&](const ServerEntity& _entity) -> std::optional<double>
+    {
+        if (!_entity.HasComponent(_query.attribute_component_id))
+        {
+            return std::nullopt;
+        }
+
+        auto&    component_data = _entity.GetComponentPayload(_query.attribute_component_id).component_data;
+        uint32_t offset         = attribute_info->offset.value();
+        if (component_data.size() < offset + LayerConfig::GetAttributeTypeSize(attribute_info->type))
+        {
+            return std::nullopt;
+        }
+
+        auto ReadValue = [&](auto _value) -> double
+        {
+            std::memcpy(&_value, component_data.data() + offset, sizeof(_value));
+            return static_cast<double>(_value);
+        };
+
+        switch (attribute_info->type)
+        {
+            case ComponentAttributeType::boolean: return ReadValue(uint8_t()) != 0.0 ? 1.0 : 0.0; // Any byte other than 0/1 isn't a valid bool
+            case ComponentAttributeType::int32:   return ReadValue(int32_t());
+            case ComponentAttributeType::int64:   return ReadValue(int64_t());
+            case ComponentAttributeType::int32u:  return ReadValue(uint32_t());
+            case ComponentAttributeType::int64u:  return ReadValue(uint64_t());
+            case ComponentAttributeType::float32: return ReadValue(float());
+            case ComponentAttributeType::float64: return ReadValue(double());
+            default:                              return std::nullopt;
+        }
+    };
+
+    // Only counting queries without component filters can use the cell entity count directly
+    bool    can_use_cell_count   = _query.type != AggregateQueryType::AttributeBounds && _query.required_component_mask.none();
+    int32_t cell_unit_length     = static_cast<int32_t>(m_grids[0].cell_length);
+    int32_t total_grids_per_line = static_cast<int32_t>(m_grids[0].grids_per_line);
+
+    WorldCellCoordinates rect_begin = ConvertPositionIntoCellCoordinates(WorldPosition({ query_rect.x, query_rect.y }));
+    WorldCellCoordinates rect_end   = ConvertPositionIntoCellCoordinates(WorldPosition({ query_rect.x + query_rect.width, query_rect.y + query_rect.height }));
+
+    // Empty regions of the grid are skipped by its occupancy summaries
+    auto selected_cells = m_grids[0].grid->InsideRect(rect_begin, rect_end);
+    for (auto selected_cell : selected_cells)
+    {
+        auto&                cell             = *selected_cell;
+        WorldCellCoordinates cell_coordinates = cell.cell_coordinates;
+        uint32_t             cell_count       = 0;
+
+        // A cell is fully covered when all its corners are inside the area, cells on the world border are
+        // never considered covered since they also hold entities clamped from outside the world
+        WorldPosition cell_position   = ConvertCellCoordinatesIntoPosition(cell_coordinates);
+        bool          is_border_cell  = cell_coordinates.x == 0 
+            || cell_coordinates.y == 0 
+            || cell_coordinates.x == total_grids_per_line - 1 
+            || cell_coordinates.y == total_grids_per_line - 1;
+        bool          is_cell_covered = !is_border_cell
+            && IsInsideArea(cell_position)
+            && IsInsideArea(WorldPosition({ cell_position.x + cell_unit_length, cell_position.y }))
+            && IsInsideArea(WorldPosition({ cell_position.x, cell_position.y + cell_unit_length }))
+            && IsInsideArea(WorldPosition({ cell_position.x + cell_unit_length, cell_position.y + cell_unit_length }));
+
+        if (can_use_cell_count && is_cell_covered)
+        {
+            cell_count = static_cast<uint32_t>(cell.entities.size());
+        }
+        else
+        {
+            for (auto& [entity_id, entity] : cell.entities)
+            {
+                if (!is_cell_covered && !IsInsideArea(entity->GetWorldPosition()))
+                {
+                    continue;
+                }
+
+                if ((entity->GetComponentMask() & _query.required_component_mask) != _query.required_component_mask)
+                {
+                    continue;
+                }
+
+                if (_query.type == AggregateQueryType::AttributeBounds)
+                {
+                    auto attribute_value = ReadAttributeValue(*entity);
+                    if (!attribute_value)
+                    {
+                        continue;
+                    }
+
+                    query_result.minimum_value = query_result.entity_count + cell_count == 0 ? attribute_value.value() : std::min(query_result.minimum_value, attribute_value.value());
+                    query_result.maximum_value = query_result.entity_count + cell_count == 0 ? attribute_value.value() : std::max(query_result.maximum_value, attribute_value.value());
+                }
+
+                cell_count++;
+            }
+        }
+
+        query_result.entity_count += cell_count;
+
+        if (_query.type == AggregateQueryType::CellHistogram && cell_count > 0)
+        {
+            if (query_result.cell_histogram.size() >= AggregateQueryResult::MaximumHistogramCells)
+            {
+                query_result.is_truncated = true;
+                continue;
+            }
+
+            query_result.cell_histogram.push_back({ cell_coordinates, cell_count });
+        }
+    }
+
+    return std::move(query_result);
+}
+
+void Jani::RuntimeWorldController::ApplySpatialBalance()
+{
+    struct WorkerLoadInfo
+    {
+        WorkerInfo* worker_info = nullptr;
+        float       cost        = 0.0f;
+        float       load        = 0.0f;
+    };
+
+    struct CellCostInfo
+    {
+        WorldCellInfo* cell_info = nullptr;
+        float          cost      = 0.0f;
+    };
+
+    // Most loaded first, ties are broken by the worker id so the same loads always select the same workers
+    auto CompareWorkerLoads = [](const WorkerLoadInfo& _first, const WorkerLoadInfo& _second)
+    {
+        if (_first.load != _second.load) return _first.load > _second.load;
+        return _first.worker_info->worker_instance->GetId() < _second.worker_info->worker_instance->GetId();
+    };
+
+    // Most expensive first, ties are broken by the cell coordinates and sub cell index
+    auto CompareCellCosts = [](const CellCostInfo& _first, const CellCostInfo& _second)
+    {
+        if (_first.cost != _second.cost)                                                           return _first.cost > _second.cost;
+        if (_first.cell_info->cell_coordinates.x != _second.cell_info->cell_coordinates.x)         return _first.cell_info->cell_coordinates.x < _second.cell_info->cell_coordinates.x;
+        if (_first.cell_info->cell_coordinates.y != _second.cell_info->cell_coordinates.y)         return _first.cell_info->cell_coordinates.y < _second.cell_info->cell_coordinates.y;
+        return _first.cell_info->sub_cell_index < _second.cell_info->sub_cell_index;
+    };
+
+    for (auto& layer_info : m_layer_infos)
+    {
+        if (!layer_info)
+        {
+            break;
+        }
+
+        if (!layer_info->uses_spatial_area 
+            || layer_info->worker_instances.size() == 0
+            || (layer_info->worker_instances.size() == 1 && layer_info->maximum_workers == 1)) // If there is one instance and the limit is
+            // one, no balance is required/possible
+        {
+            continue;
+        }
+
+        if (m_deployment_config.GetSpatialPartitioning() == SpatialPartitioning::HilbertCurve)
+        {
+            ApplyCurvePartitioning(layer_info.value());
+            continue;
+        }
+
+        auto& world_grid = *m_grids[layer_info->grid_index].grid;
+
+        // Estimate the cost and load of each worker on this layer
+        std::vector<WorkerLoadInfo> worker_loads;
+        for (auto& [worker_id, worker_instance] : layer_info->worker_instances)
+        {
+            WorkerLoadInfo worker_load;
+            worker_load.worker_info = &worker_instance;
+            worker_load.cost        = GetWorkerCost(world_grid, worker_instance.worker_cells_infos);
+            worker_load.load        = GetWorkerLoad(layer_info.value(), worker_instance, worker_load.cost);
+
+            worker_loads.push_back(worker_load);
+        }
+
+        std::sort(worker_loads.begin(), worker_loads.end(), CompareWorkerLoads);
+
+        float high_watermark = m_deployment_config.GetBalanceHighWatermark();
+        float low_watermark  = m_deployment_config.GetBalanceLowWatermark();
+
+        // Determine if the most loaded worker needs its excess to be distributed over other workers
+        WorkerLoadInfo donor_load = worker_loads.front();
+        if (donor_load.load < high_watermark)
+        {
+            continue;
+        }
+
+        worker_loads.erase(worker_loads.begin());
+
+        auto* worker_instance_over_limit = donor_load.worker_info;
+        auto& worker_cells_infos         = worker_instance_over_limit->worker_cells_infos;
+        float donor_load_per_cost        = donor_load.cost > 0.0f ? donor_load.load / donor_load.cost : 0.0f;
+
+        std::vector<CellCostInfo> donor_cells;
+        for (auto cell_coordinates : worker_cells_infos.coordinates_owned)
+        {
+            auto& cell_info = world_grid.AtMutable(cell_coordinates);
+            donor_cells.push_back({ &cell_info, GetCellCost(cell_info) });
+        }
+
+        for (auto* sub_cell_info : worker_cells_infos.sub_cells_owned)
+        {
+            donor_cells.push_back({ sub_cell_info, GetCellCost(*sub_cell_info) });
+        }
+
+        std::sort(donor_cells.begin(), donor_cells.end(), CompareCellCosts);
+
+        bool                              too_many_entities_on_same_sub_cell = false;
+        bool                              not_enough_space_on_other_workers  = false;
+        std::vector<WorldCellCoordinates> cells_to_split;
+
+        for (auto& donor_cell : donor_cells)
+        {
+            // Check if we reached our objective, the donor is left at the low watermark so it doesn't go over the
+            // high one again as soon as its load fluctuates
+            if (donor_load.load < low_watermark)
+            {
+                break;
+            }
+
+            auto& cell_info = *donor_cell.cell_info;
+            assert(cell_info.worker_cells_infos[layer_info->layer_id]->worker_instance == worker_instance_over_limit->worker_instance.get());
 
             // Is there at least one entity on this cell to give away?
             if (cell_info.entities.size() == 0)
             {
-                ++coordinates_iter;
                 continue;
             }
 
-            // Check if this cell is over it's capacity, making impossible to move its entities to another
-            // This basically means that this worker is unable to give away entities to lower the current 
-            // usage
-            // We will still continue to try to give away other cells from this worker
-            if (cell_info.entities.size() >= layer_info->maximum_entities_per_worker)
+            // Cells that migrated recently or that don't fit the remaining budget wait for a later update
+            if (!CanBalanceMigrateCell(layer_info.value(), cell_info))
             {
-                too_many_entities_on_same_cell = true;
-                ++coordinates_iter;
                 continue;
             }
 
-            /*
-            * Go through each other worker and check if someone can assume the entities from this cell
-            */
-            bool did_give_away_cell = false;
-            for (auto& [target_worker_density_key, target_worker_info] : layer_info->ordered_worker_density_info)
+            // Check if this cell alone overloads a worker, making impossible to move its entities to another
+            // worker as a whole, in this case it's split and its sub cells can be given away on the next
+            // balance, a sub cell over the capacity can't be split further
+            float cell_load = donor_cell.cost * donor_load_per_cost;
+            if (cell_info.entities.size() >= layer_info->maximum_entities_per_worker || cell_load >= low_watermark)
             {
-                // Ignore self
-                if (target_worker_info->worker_instance == worker_instance_over_limit->worker_instance)
+                if (cell_info.parent_cell == nullptr)
                 {
-                    continue;
+                    cells_to_split.push_back(cell_info.cell_coordinates);
+                }
+                else
+                {
+                    too_many_entities_on_same_sub_cell = true;
                 }
 
-                // Do not make the selected worker go over 70% of its capacity
-                if (target_worker_info->worker_cells_infos.entity_count + cell_info.entities.size() >= static_cast<uint32_t>(layer_info->maximum_entities_per_worker * 0.7))
+                continue;
+            }
+
+            /*
+            * Go through each other worker, least loaded first, and check if someone can assume this cell
+            */
+            bool was_given_away = false;
+            for (auto target_load_iter = worker_loads.rbegin(); target_load_iter != worker_loads.rend(); ++target_load_iter)
+            {
+                auto& target_load        = *target_load_iter;
+                auto* target_worker_info = target_load.worker_info;
+
+                // Workers that never reported their load are estimated with the donor load per cost
+                float target_load_per_cost = target_worker_info->load_per_cost > 0.0f ? target_worker_info->load_per_cost : donor_load_per_cost;
+
+                // Do not make the selected worker go over the low watermark, in entities or in load, so it won't
+                // need to give the cell back
+                if (target_worker_info->worker_cells_infos.entity_count + cell_info.entities.size() >= static_cast<uint32_t>(layer_info->maximum_entities_per_worker * low_watermark)
+                    || target_load.load + donor_cell.cost * target_load_per_cost >= low_watermark)
                 {
                     continue;
                 }
 
-                WorkerDensityKey over_capacity_worker_density_key = WorkerDensityKey(*cell_info.worker_cells_infos[layer_info.value().layer_id]);
-
                 MigrateEntitiesFromCellToNewWorker(
                     layer_info.value(),
                     cell_info,
                     *worker_instance_over_limit,
                     *target_worker_info,
-                    over_capacity_worker_density_key,
-                    target_worker_density_key,
-                    false);
+                    true);
 
-                did_give_away_cell = true;
+                target_load.cost += donor_cell.cost;
+                target_load.load += donor_cell.cost * target_load_per_cost;
+                donor_load.cost  -= donor_cell.cost;
+                donor_load.load  -= cell_load;
+
+                std::sort(worker_loads.begin(), worker_loads.end(), CompareWorkerLoads);
+
+                was_given_away = true;
                 break;
             }
 
-            not_enough_space_on_other_workers |= !did_give_away_cell;
-            
-            if (did_give_away_cell)
-            {
-                coordinates_iter = worker_cells_infos.coordinates_owned.erase(coordinates_iter);
-            }
-            else 
-            {
-                ++coordinates_iter;
-            }
+            not_enough_space_on_other_workers |= !was_given_away;
+        }
+
+        // Hotspot cells are split only after iterating, since splitting changes the owned coordinates
+        for (auto& cell_coordinates : cells_to_split)
+        {
+            SplitCell(world_grid.AtMutable(cell_coordinates));
+        }
+
+        if (too_many_entities_on_same_sub_cell)
+        {
+            JaniTrace("WorldController -> A sub cell alone overloads a worker on layer {}, its entities can't be balanced", layer_info->layer_id);
         }
 
-        // If the current worker is still over its capacity 
-        if (worker_cells_infos.entity_count >= layer_info->maximum_entities_per_worker
+        // If the current worker is still overloaded
+        if (donor_load.load >= high_watermark
             && not_enough_space_on_other_workers)
         {
-            JaniTrace("WorldController -> Requesting worker for layer {} because a worker is over capacity", layer_info->layer_id);
+            JaniTrace("WorldController -> Requesting worker for layer {} because a worker is overloaded", layer_info->layer_id);
 
             assert(m_worker_layer_request_callback);
             m_worker_layer_request_callback(layer_info->layer_id);
         }
     }
-}
\ No newline at end of file
+}
+
+void Jani::RuntimeWorldController::ApplyCurvePartitioning(LayerInfo& _layer_info)
+{
+    struct CurveUnit
+    {
+        uint64_t       curve_index  = 0;
+        WorldCellInfo* cell_info    = nullptr;
+        WorkerInfo*    owner        = nullptr;
+        WorkerInfo*    target_owner = nullptr;
+        float          cost         = 0.0f;
+    };
+
+    auto& grid_info  = m_grids[_layer_info.grid_index];
+    auto& world_grid = *grid_info.grid;
+
+    // Cells alone over a worker capacity are split first, so the curve boundaries can cut through them
+    std::vector<WorldCellCoordinates> cells_to_split;
+    for (auto& [worker_id, worker_info] : _layer_info.worker_instances)
+    {
+        for (auto cell_coordinates : worker_info.worker_cells_infos.coordinates_owned)
+        {
+            if (world_grid.At(cell_coordinates).entities.size() >= _layer_info.maximum_entities_per_worker)
+            {
+                cells_to_split.push_back(cell_coordinates);
+            }
+        }
+    }
+
+    for (auto& cell_coordinates : cells_to_split)
+    {
+        SplitCell(world_grid.AtMutable(cell_coordinates));
+    }
+
+    float                                  maximum_load = 0.0f;
+    std::unordered_map<WorkerInfo*, float> worker_costs;
+    for (auto& [worker_id, worker_info] : _layer_info.worker_instances)
+    {
+        float worker_cost          = GetWorkerCost(world_grid, worker_info.worker_cells_infos);
+        worker_costs[&worker_info] = worker_cost;
+        maximum_load               = std::max(maximum_load, GetWorkerLoad(_layer_info, worker_info, worker_cost));
+    }
+
+    if (!_layer_info.requires_repartition && maximum_load < m_deployment_config.GetBalanceHighWatermark())
+    {
+        return;
+    }
+
+    _layer_info.requires_repartition = false;
+
+    // Workers keep their order along the curve, the ones without a range (that just joined) are placed right
+    // after the most loaded worker so they take part of its range
+    std::vector<WorkerInfo*> ordered_workers;
+    for (auto& [curve_index, worker_info] : _layer_info.curve_ranges)
+    {
+        ordered_workers.push_back(worker_info);
+    }
+
+    std::vector<WorkerInfo*> new_workers;
+    for (auto& [worker_id, worker_info] : _layer_info.worker_instances)
+    {
+        if (std::find(ordered_workers.begin(), ordered_workers.end(), &worker_info) == ordered_workers.end())
+        {
+            new_workers.push_back(&worker_info);
+        }
+    }
+
+    std::sort(new_workers.begin(), new_workers.end(), [](const WorkerInfo* _first, const WorkerInfo* _second)
+    {
+        return _first->worker_instance->GetId() < _second->worker_instance->GetId();
+    });
+
+    auto most_loaded_worker_iter = std::max_element(ordered_workers.begin(), ordered_workers.end(), [&](WorkerInfo* _first, WorkerInfo* _second)
+    {
+        return worker_costs[_first] < worker_costs[_second];
+    });
+
+    ordered_workers.insert(most_loaded_worker_iter == ordered_workers.end() ? ordered_workers.end() : std::next(most_loaded_worker_iter), new_workers.begin(), new_workers.end());
+
+    // Gather every owned cell (or sub cell) ordered along the curve
+    std::vector<CurveUnit> curve_units;
+    float                  total_cost = 0.0f;
+    for (auto* worker_info : ordered_workers)
+    {
+        auto AddCurveUnit = [&](WorldCellInfo& _cell_info)
+        {
+            CurveUnit curve_unit;
+            curve_unit.curve_index = HilbertEncode(_cell_info.cell_coordinates.x, _cell_info.cell_coordinates.y, grid_info.curve_dim_size);
+            curve_unit.cell_info   = &_cell_info;
+            curve_unit.owner       = worker_info;
+            curve_unit.cost        = GetCellCost(_cell_info);
+            total_cost            += curve_unit.cost;
+
+            curve_units.push_back(curve_unit);
+        };
+
+        for (auto cell_coordinates : worker_info->worker_cells_infos.coordinates_owned)
+        {
+            AddCurveUnit(world_grid.AtMutable(cell_coordinates));
+        }
+
+        for (auto* sub_cell_info : worker_info->worker_cells_infos.sub_cells_owned)
+        {
+            AddCurveUnit(*sub_cell_info);
+        }
+    }
+
+    std::sort(curve_units.begin(), curve_units.end(), [](const CurveUnit& _first, const CurveUnit& _second)
+    {
+        if (_first.curve_index != _second.curve_index) return _first.curve_index < _second.curve_index;
+        return _first.cell_info->sub_cell_index < _second.cell_info->sub_cell_index;
+    });
+
+    // Each worker takes the next contiguous chunk of the curve with about the same share of the total cost, a
+    // boundary is placed before a cell whenever most of the cell would be over the current worker share
+    std::vector<std::pair<uint64_t, WorkerInfo*>> curve_ranges;
+    std::unordered_map<WorkerInfo*, float>        new_worker_costs;
+    float                                         target_cost      = total_cost / ordered_workers.size();
+    float                                         accumulated_cost = 0.0f;
+    uint32_t                                      worker_index     = 0;
+
+    curve_ranges.push_back({ 0, ordered_workers[0] });
+    for (auto& curve_unit : curve_units)
+    {
+        while (worker_index + 1 < ordered_workers.size() && accumulated_cost + curve_unit.cost / 2.0f > target_cost * (worker_index + 1))
+        {
+            worker_index++;
+            curve_ranges.push_back({ curve_unit.curve_index, ordered_workers[worker_index] });
+        }
+
+        accumulated_cost                                += curve_unit.cost;
+        curve_unit.target_owner                          = ordered_workers[worker_index];
+        new_worker_costs[ordered_workers[worker_index]] += curve_unit.cost;
+    }
+
+    // Workers left without cells keep an empty range at the end of the curve, so their order is preserved
+    for (worker_index++; worker_index < ordered_workers.size(); worker_index++)
+    {
+        curve_ranges.push_back({ std::numeric_limits<uint64_t>::max(), ordered_workers[worker_index] });
+    }
+
+    uint32_t total_migrations = 0;
+    uint32_t total_deferred   = 0;
+    for (auto& curve_unit : curve_units)
+    {
+        if (curve_unit.owner == curve_unit.target_owner)
+        {
+            continue;
+        }
+
+        // Cells that can't migrate now keep their owner, the partition is applied again on the next update
+        if (!CanBalanceMigrateCell(_layer_info, *curve_unit.cell_info))
+        {
+            total_deferred++;
+            continue;
+        }
+
+        MigrateEntitiesFromCellToNewWorker(
+            _layer_info,
+            *curve_unit.cell_info,
+            *curve_unit.owner,
+            *curve_unit.target_owner,
+            true);
+
+        total_migrations++;
+    }
+
+    _layer_info.curve_ranges         = std::move(curve_ranges);
+    _layer_info.requires_repartition = total_deferred > 0;
+
+    JaniTrace("WorldController -> Curve partitioning on layer {} migrated {} cells between {} workers ({} deferred)", _layer_info.layer_id, total_migrations, ordered_workers.size(), total_deferred);
+
+    // Even balanced, a worker can still be overloaded if there are not enough workers
+    for (auto* worker_info : ordered_workers)
+    {
+        if (GetWorkerLoad(_layer_info, *worker_info, new_worker_costs[worker_info]) >= m_deployment_config.GetBalanceHighWatermark())
+        {
+            JaniTrace("WorldController -> Requesting worker for layer {} because a worker is overloaded", _layer_info.layer_id);
+
+            assert(m_worker_layer_request_callback);
+            m_worker_layer_request_callback(_layer_info.layer_id);
+
+            break;
+        }
+    }
+}
+
+Jani::RuntimeWorldController::WorkerInfo* Jani::RuntimeWorldController::FindCurveRangeOwner(const LayerInfo& _layer_info, WorldCellCoordinates _cell_coordinates) const
+{
+    if (_layer_info.curve_ranges.size() == 0)
+    {
+        return nullptr;
+    }
+
+    uint64_t curve_index = HilbertEncode(_cell_coordinates.x, _cell_coordinates.y, m_grids[_layer_info.grid_index].curve_dim_size);
+    auto     range_iter  = std::upper_bound(
+        _layer_info.curve_ranges.begin(), 
+        _layer_info.curve_ranges.end(), 
+        curve_index, 
+        [](uint64_t _curve_index, const std::pair<uint64_t, WorkerInfo*>& _curve_range)
+        {
+            return _curve_index < _curve_range.first;
+        });
+
+    assert(range_iter != _layer_info.curve_ranges.begin());
+
+    return std::prev(range_iter)->second;
+}
+
+uint64_t Jani::RuntimeWorldController::HilbertEncode(uint32_t _x, uint32_t _y, uint32_t _dim_size)
+{
+    uint64_t curve_index = 0;
+    for (uint32_t s = _dim_size / 2; s > 0; s /= 2)
+    {
+        uint32_t rx = (_x & s) > 0 ? 1 : 0;
+        uint32_t ry = (_y & s) > 0 ? 1 : 0;
+
+        curve_index += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+        // Rotate the quadrant so the curve keeps its orientation on the next level
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                _x = _dim_size - 1 - _x;
+                _y = _dim_size - 1 - _y;
+            }
+
+            std::swap(_x, _y);
+        }
+    }
+
+    return curve_index;
+}
+
+float Jani::RuntimeWorldController::GetWorkerCost(EntitySparseGrid<WorldCellInfo>& _world_grid, const WorkerCellsInfos& _worker_cells_infos) const
+{
+    float worker_cost = 0.0f;
+    for (auto cell_coordinates : _worker_cells_infos.coordinates_owned)
+    {
+        worker_cost += GetCellCost(_world_grid.AtMutable(cell_coordinates));
+    }
+
+    for (auto* sub_cell_info : _worker_cells_infos.sub_cells_owned)
+    {
+        worker_cost += GetCellCost(*sub_cell_info);
+    }
+
+    return worker_cost;
+}
+
+bool Jani::RuntimeWorldController::CanBalanceMigrateCell(const LayerInfo& _layer_info, const WorldCellInfo& _cell_info) const
+{
+    if (_cell_info.last_migration_time_ms != std::numeric_limits<uint64_t>::max()
+        && m_current_time_ms - _cell_info.last_migration_time_ms < m_deployment_config.GetCellMigrationCooldown())
+    {
+        return false;
+    }
+
+    uint32_t entity_budget = m_deployment_config.GetMigrationEntityBudget();
+    uint64_t byte_budget   = m_deployment_config.GetMigrationByteBudget();
+
+    if (entity_budget > 0
+        && m_migrated_entities_on_update > 0
+        && m_migrated_entities_on_update + _cell_info.entities.size() > entity_budget)
+    {
+        return false;
+    }
+
+    if (byte_budget > 0
+        && m_migrated_bytes_on_update > 0
+        && m_migrated_bytes_on_update + GetCellMigrationSize(_layer_info, _cell_info) > byte_budget)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+uint64_t Jani::RuntimeWorldController::GetCellMigrationSize(const LayerInfo& _layer_info, const WorldCellInfo& _cell_info) const
+{
+    auto&    layer_components = m_layer_config.GetLayerInfo(_layer_info.layer_id).components;
+    uint64_t migration_size   = 0;
+
+    for (auto& [entity_id, entity] : _cell_info.entities)
+    {
+        migration_size += MigrationEntityOverhead;
+
+        for (auto component_id : layer_components)
+        {
+            if (entity->HasComponent(component_id))
+            {
+                migration_size += entity->GetComponentPayload(component_id).component_data.size();
+            }
+        }
+    }
+
+    return migration_size;
+}
+
+void Jani::RuntimeWorldController::DecayCellActivity(WorldCellInfo& _cell_info) const
+{
+    if (_cell_info.update_activity_time_ms == m_current_time_ms)
+    {
+        return;
+    }
+
+    float elapsed_half_lives           = static_cast<float>(m_current_time_ms - _cell_info.update_activity_time_ms) / CellActivityHalfLife;
+    _cell_info.update_activity        *= std::exp2(-elapsed_half_lives);
+    _cell_info.update_activity_time_ms = m_current_time_ms;
+}
+
+float Jani::RuntimeWorldController::GetCellCost(WorldCellInfo& _cell_info) const
+{
+    DecayCellActivity(_cell_info);
+
+    return _cell_info.entities.size() * CellEntityBaseCost + _cell_info.update_activity * CellUpdateCost;
+}
+
+float Jani::RuntimeWorldController::GetWorkerLoad(const LayerInfo& _layer_info, WorkerInfo& _worker_info, float _worker_cost) const
+{
+    auto& load_report = _worker_info.worker_instance->GetLoadReport();
+    if (load_report.report_index != _worker_info.load_report_index && _worker_cost > 0.0f)
+    {
+        _worker_info.load_report_index = load_report.report_index;
+        _worker_info.load_per_cost     = GetWorkerMeasuredLoad(*_worker_info.worker_instance) / _worker_cost;
+    }
+
+    float entity_load = static_cast<float>(_worker_info.worker_cells_infos.entity_count) / _layer_info.maximum_entities_per_worker;
+
+    return std::max(_worker_info.load_per_cost * _worker_cost, entity_load);
+}
+
+float Jani::RuntimeWorldController::GetWorkerMeasuredLoad(const RuntimeWorkerReference& _worker_instance) const
+{
+    auto& load_report = _worker_instance.GetLoadReport();
+    if (load_report.report_index == 0)
+    {
+        return 0.0f;
+    }
+
+    float frame_time_load = static_cast<float>(load_report.average_frame_time_us) / (m_deployment_config.GetWorkerTargetFrameTime() * 1000.0f);
+    float bandwidth_load  = m_deployment_config.GetWorkerBandwidthBudget() > 0 ? static_cast<float>(load_report.total_data_sent_per_second) / m_deployment_config.GetWorkerBandwidthBudget() : 0.0f;
+
+    return std::max({ frame_time_load, load_report.cpu_usage, bandwidth_load });
+}
+
+Jani::WorldCellInfo& Jani::RuntimeWorldController::ResolveOwnershipCell(WorldCellInfo& _cell_info, WorldPosition _world_position)
+{
+    if (!_cell_info.IsSplit())
+    {
+        return _cell_info;
+    }
+
+    return *_cell_info.sub_cells[GetSubCellIndex(_cell_info.cell_coordinates, _world_position, _cell_info.grid_index)];
+}
+
+uint32_t Jani::RuntimeWorldController::GetSubCellIndex(WorldCellCoordinates _cell_coordinates, WorldPosition _world_position, uint32_t _grid_index) const
+{
+    glm::vec2 sub_cell_space_position = (ConvertPositionIntoCellSpace(_world_position, _grid_index) - glm::vec2(_cell_coordinates.x, _cell_coordinates.y)) * static_cast<float>(SubCellDimSize);
+    int32_t   sub_cell_x              = std::clamp(static_cast<int32_t>(std::floor(sub_cell_space_position.x)), 0, static_cast<int32_t>(SubCellDimSize) - 1);
+    int32_t   sub_cell_y              = std::clamp(static_cast<int32_t>(std::floor(sub_cell_space_position.y)), 0, static_cast<int32_t>(SubCellDimSize) - 1);
+
+    return static_cast<uint32_t>(sub_cell_y) * SubCellDimSize + static_cast<uint32_t>(sub_cell_x);
+}
+
+void Jani::RuntimeWorldController::SplitCell(WorldCellInfo& _cell_info)
+{
+    assert(!_cell_info.IsSplit() && _cell_info.parent_cell == nullptr);
+
+    JaniTrace("WorldController -> SplitCell() at ({},{}) with {} entities", _cell_info.cell_coordinates.x, _cell_info.cell_coordinates.y, _cell_info.entities.size());
+
+    for (uint32_t i = 0; i < SubCellDimSize * SubCellDimSize; i++)
+    {
+        auto sub_cell_info                = std::make_unique<WorldCellInfo>();
+        sub_cell_info->worker_cells_infos = _cell_info.worker_cells_infos;
+        sub_cell_info->cell_coordinates   = _cell_info.cell_coordinates;
+        sub_cell_info->parent_cell        = &_cell_info;
+        sub_cell_info->sub_cell_index     = i;
+        sub_cell_info->grid_index         = _cell_info.grid_index;
+
+        _cell_info.sub_cells.push_back(std::move(sub_cell_info));
+    }
+
+    for (auto& [entity_id, entity] : _cell_info.entities)
+    {
+        auto& sub_cell_info = *_cell_info.sub_cells[GetSubCellIndex(_cell_info.cell_coordinates, entity->GetWorldPosition(), _cell_info.grid_index)];
+        sub_cell_info.entities.insert({ entity_id, entity });
+        entity->SetWorldCellInfo(sub_cell_info, _cell_info.grid_index);
+    }
+
+    // The cell activity is distributed over its sub cells according to their entities
+    DecayCellActivity(_cell_info);
+    for (auto& sub_cell_info : _cell_info.sub_cells)
+    {
+        sub_cell_info->update_activity         = _cell_info.update_activity * sub_cell_info->entities.size() / _cell_info.entities.size();
+        sub_cell_info->update_activity_time_ms = _cell_info.update_activity_time_ms;
+    }
+
+    // Sub cells start with the cell owners, no entity changes its owner here
+    for (auto& worker_cells_infos : _cell_info.worker_cells_infos)
+    {
+        if (!worker_cells_infos)
+        {
+            continue;
+        }
+
+        SetCellOwnership(*worker_cells_infos, _cell_info, false);
+        for (auto& sub_cell_info : _cell_info.sub_cells)
+        {
+            SetCellOwnership(*worker_cells_infos, *sub_cell_info, true);
+        }
+
+        worker_cells_infos = nullptr;
+    }
+
+    _cell_info.split_update_index = m_update_index;
+
+    m_grids[_cell_info.grid_index].split_cells.insert(_cell_info.cell_coordinates);
+}
+
+void Jani::RuntimeWorldController::MergeCell(WorldCellInfo& _cell_info)
+{
+    assert(_cell_info.IsSplit());
+
+    JaniTrace("WorldController -> MergeCell() at ({},{}) with {} entities", _cell_info.cell_coordinates.x, _cell_info.cell_coordinates.y, _cell_info.entities.size());
+
+    for (auto& layer_info : m_layer_infos)
+    {
+        if (!layer_info)
+        {
+            break;
+        }
+
+        LayerId layer_id = layer_info->layer_id;
+        if (layer_info->grid_index != _cell_info.grid_index)
+        {
+            continue;
+        }
+
+        // The worker owning most of the cell entities keeps it, so the least amount of entities migrate
+        std::unordered_map<WorkerCellsInfos*, uint32_t> entities_per_owner;
+        WorkerCellsInfos*                               target_worker_cells_infos = nullptr;
+        for (auto& sub_cell_info : _cell_info.sub_cells)
+        {
+            auto* owner_worker_cells_infos = sub_cell_info->worker_cells_infos[layer_id];
+            if (!owner_worker_cells_infos)
+            {
+                continue;
+            }
+
+            uint32_t& owner_total_entities = entities_per_owner[owner_worker_cells_infos];
+            owner_total_entities          += static_cast<uint32_t>(sub_cell_info->entities.size());
+
+            if (!target_worker_cells_infos || owner_total_entities > entities_per_owner[target_worker_cells_infos])
+            {
+                target_worker_cells_infos = owner_worker_cells_infos;
+            }
+        }
+
+        if (!target_worker_cells_infos)
+        {
+            continue;
+        }
+
+        auto& target_worker_info = GetWorkerInfoForCellsInfos(layer_info.value(), *target_worker_cells_infos);
+
+        for (auto& sub_cell_info : _cell_info.sub_cells)
+        {
+            auto* current_worker_cells_infos = sub_cell_info->worker_cells_infos[layer_id];
+            if (!current_worker_cells_infos || current_worker_cells_infos == target_worker_cells_infos)
+            {
+                continue;
+            }
+
+            auto& current_worker_info = GetWorkerInfoForCellsInfos(layer_info.value(), *current_worker_cells_infos);
+
+            MigrateEntitiesFromCellToNewWorker(
+                layer_info.value(),
+                *sub_cell_info,
+                current_worker_info,
+                target_worker_info,
+                true);
+        }
+
+        // Every sub cell is owned by the target now, it can own the whole cell
+        for (auto& sub_cell_info : _cell_info.sub_cells)
+        {
+            SetCellOwnership(*target_worker_cells_infos, *sub_cell_info, false);
+        }
+
+        SetCellOwnership(*target_worker_cells_infos, _cell_info, true);
+        _cell_info.worker_cells_infos[layer_id] = target_worker_cells_infos;
+    }
+
+    for (auto& [entity_id, entity] : _cell_info.entities)
+    {
+        entity->SetWorldCellInfo(_cell_info, _cell_info.grid_index);
+    }
+
+    DecayCellActivity(_cell_info);
+    _cell_info.update_activity = 0.0f;
+    for (auto& sub_cell_info : _cell_info.sub_cells)
+    {
+        DecayCellActivity(*sub_cell_info);
+        _cell_info.update_activity += sub_cell_info->update_activity;
+    }
+
+    _cell_info.sub_cells.clear();
+}
+
+void Jani::RuntimeWorldController::ApplyCellMerges()
+{
+    for (uint32_t grid_index = 0; grid_index < m_grids.size(); grid_index++)
+    {
+        auto& grid_info = m_grids[grid_index];
+        if (grid_info.split_cells.size() == 0)
+        {
+            continue;
+        }
+
+        uint32_t                minimum_worker_capacity = std::numeric_limits<uint32_t>::max();
+        std::vector<LayerInfo*> grid_layers;
+        for (auto& layer_info : m_layer_infos)
+        {
+            if (!layer_info)
+            {
+                break;
+            }
+
+            if (layer_info->uses_spatial_area && !layer_info->user_layer && layer_info->grid_index == grid_index)
+            {
+                minimum_worker_capacity = std::min(minimum_worker_capacity, layer_info->maximum_entities_per_worker);
+                grid_layers.push_back(&layer_info.value());
+            }
+        }
+
+        // Merging only below a fraction of what splits a cell, in entities and in load, avoids splitting and merging
+        // the same cell every update
+        uint32_t merge_threshold      = static_cast<uint32_t>(minimum_worker_capacity * MergeCapacityFactor);
+        float    merge_load_threshold = m_deployment_config.GetBalanceLowWatermark() * MergeCapacityFactor;
+
+        // The same load estimate the balance uses to split a cell, each sub cell cost scaled by its owner load per cost
+        auto IsCellLoadBelowMergeThreshold = [&](WorldCellInfo& _cell_info) -> bool
+        {
+            for (auto* layer_info : grid_layers)
+            {
+                float cell_load = 0.0f;
+                for (auto& sub_cell_info : _cell_info.sub_cells)
+                {
+                    auto* owner_worker_cells_infos = sub_cell_info->worker_cells_infos[layer_info->layer_id];
+                    if (!owner_worker_cells_infos)
+                    {
+                        continue;
+                    }
+
+                    auto& owner_worker_info = GetWorkerInfoForCellsInfos(*layer_info, *owner_worker_cells_infos);
+                    cell_load              += GetCellCost(*sub_cell_info) * owner_worker_info.load_per_cost;
+                }
+
+                if (cell_load >= merge_load_threshold)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        };
+
+        // Merging migrates sub cells like the balance does, so it waits for their cooldown and for a budget that
+        // fits the whole cell, otherwise sub cells just given away would be pulled right back
+        auto CanMigrateSubCells = [&](WorldCellInfo& _cell_info) -> bool
+        {
+            for (auto* layer_info : grid_layers)
+            {
+                if (!CanBalanceMigrateCell(*layer_info, _cell_info))
+                {
+                    return false;
+                }
+
+                for (auto& sub_cell_info : _cell_info.sub_cells)
+                {
+                    if (!CanBalanceMigrateCell(*layer_info, *sub_cell_info))
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        };
+
+        for (auto split_cell_iter = grid_info.split_cells.begin(); split_cell_iter != grid_info.split_cells.end(); )
+        {
+            auto& cell_info = grid_info.grid->AtMutable(*split_cell_iter);
+
+            // The sub cells of a cell split on the last update didn't go through a balance yet
+            if (m_update_index - cell_info.split_update_index <= 1
+                || cell_info.entities.size() >= merge_threshold
+                || !IsCellLoadBelowMergeThreshold(cell_info)
+                || !CanMigrateSubCells(cell_info))
+            {
+                ++split_cell_iter;
+                continue;
+            }
+
+            MergeCell(cell_info);
+
+            split_cell_iter = grid_info.split_cells.erase(split_cell_iter);
+        }
+    }
+}
+
+Jani::RuntimeWorldController::WorkerInfo& Jani::RuntimeWorldController::GetWorkerInfoForCellsInfos(LayerInfo& _layer_info, WorkerCellsInfos& _worker_cells_infos)
+{
+    if (&_worker_cells_infos == &_layer_info.dummy_layer_worker_instance.worker_cells_infos || _worker_cells_infos.worker_instance == nullptr)
+    {
+        return _layer_info.dummy_layer_worker_instance;
+    }
+
+    auto worker_iter = _layer_info.worker_instances.find(_worker_cells_infos.worker_instance->GetId());
+    assert(worker_iter != _layer_info.worker_instances.end());
+
+    return worker_iter->second;
+}
+
+void Jani::RuntimeWorldController::SetCellOwnership(WorkerCellsInfos& _worker_cells_infos, WorldCellInfo& _cell_info, bool _is_owned)
+{
+    if (_cell_info.parent_cell)
+    {
+        if (_is_owned) _worker_cells_infos.sub_cells_owned.insert(&_cell_info);
+        else           _worker_cells_infos.sub_cells_owned.erase(&_cell_info);
+    }
+    else
+    {
+        if (_is_owned) _worker_cells_infos.coordinates_owned.insert(_cell_info.cell_coordinates);
+        else           _worker_cells_infos.coordinates_owned.erase(_cell_info.cell_coordinates);
+    }
+}
+
+void Jani::RuntimeWorldController::WorkerDensityHeap::Push(WorkerInfo& _worker_info)
+{
+    assert(_worker_info.worker_cells_infos.density_heap_index == std::numeric_limits<uint32_t>::max());
+
+    _worker_info.worker_cells_infos.density_heap_index = static_cast<uint32_t>(m_workers.size());
+    m_workers.push_back(&_worker_info);
+
+    SiftUp(_worker_info.worker_cells_infos.density_heap_index);
+}
+
+void Jani::RuntimeWorldController::WorkerDensityHeap::Erase(WorkerInfo& _worker_info)
+{
+    uint32_t index = _worker_info.worker_cells_infos.density_heap_index;
+    if (index == std::numeric_limits<uint32_t>::max())
+    {
+        return;
+    }
+
+    assert(index < m_workers.size() && m_workers[index] == &_worker_info);
+
+    uint32_t last_index = static_cast<uint32_t>(m_workers.size()) - 1;
+    if (index != last_index)
+    {
+        Swap(index, last_index);
+    }
+
+    m_workers.pop_back();
+    _worker_info.worker_cells_infos.density_heap_index = std::numeric_limits<uint32_t>::max();
+
+    // The worker moved into the erased position can be either smaller or bigger than its new parent
+    if (index < m_workers.size())
+    {
+        SiftUp(index);
+        SiftDown(m_workers[index]->worker_cells_infos.density_heap_index);
+    }
+}
+
+void Jani::RuntimeWorldController::WorkerDensityHeap::Update(WorkerCellsInfos& _worker_cells_infos)
+{
+    uint32_t index = _worker_cells_infos.density_heap_index;
+    if (index == std::numeric_limits<uint32_t>::max())
+    {
+        return;
+    }
+
+    assert(index < m_workers.size() && &m_workers[index]->worker_cells_infos == &_worker_cells_infos);
+
+    SiftUp(index);
+    SiftDown(_worker_cells_infos.density_heap_index);
+}
+
+Jani::RuntimeWorldController::WorkerInfo& Jani::RuntimeWorldController::WorkerDensityHeap::Top() const
+{
+    assert(m_workers.size() > 0);
+
+    return *m_workers.front();
+}
+
+size_t Jani::RuntimeWorldController::WorkerDensityHeap::size() const
+{
+    return m_workers.size();
+}
+
+bool Jani::RuntimeWorldController::WorkerDensityHeap::IsLess(uint32_t _lhs_index, uint32_t _rhs_index) const
+{
+    auto& lhs_cells_infos = m_workers[_lhs_index]->worker_cells_infos;
+    auto& rhs_cells_infos = m_workers[_rhs_index]->worker_cells_infos;
+
+    if (lhs_cells_infos.entity_count != rhs_cells_infos.entity_count)
+    {
+        return lhs_cells_infos.entity_count < rhs_cells_infos.entity_count;
+    }
+
+    return lhs_cells_infos.worker_instance->GetId() < rhs_cells_infos.worker_instance->GetId();
+}
+
+void Jani::RuntimeWorldController::WorkerDensityHeap::Swap(uint32_t _lhs_index, uint32_t _rhs_index)
+{
+    std::swap(m_workers[_lhs_index], m_workers[_rhs_index]);
+    m_workers[_lhs_index]->worker_cells_infos.density_heap_index = _lhs_index;
+    m_workers[_rhs_index]->worker_cells_infos.density_heap_index = _rhs_index;
+}
+
+void Jani::RuntimeWorldController::WorkerDensityHeap::SiftUp(uint32_t _index)
+{
+    while (_index > 0)
+    {
+        uint32_t parent_index = (_index - 1) / 2;
+        if (!IsLess(_index, parent_index))
+        {
+            break;
+        }
+
+        Swap(_index, parent_index);
+        _index = parent_index;
+    }
+}
+
+void Jani::RuntimeWorldController::WorkerDensityHeap::SiftDown(uint32_t _index)
+{
+    uint32_t total_workers = static_cast<uint32_t>(m_workers.size());
+    while (true)
+    {
+        uint32_t smallest_index = _index;
+        uint32_t left_index     = _index * 2 + 1;
+        uint32_t right_index    = _index * 2 + 2;
+
+        if (left_index < total_workers && IsLess(left_index, smallest_index))   smallest_index = left_index;
+        if (right_index < total_workers && IsLess(right_index, smallest_index)) smallest_index = right_index;
+
+        if (smallest_index == _index)
+        {
+            break;
+        }
+
+        Swap(_index, smallest_index);
+        _index = smallest_index;
+    }
+}
@@ -35,54 +35,45 @@ class EntitySparseGrid;
 ////////////////////////////////////////////////////////////////////////////////
 class RuntimeWorldController
 {
-    using CellOwnershipChangeCallback        = std::function<void(const std::map<EntityId, ServerEntity*>&, WorldCellCoordinates, LayerId, const RuntimeWorkerReference*, const RuntimeWorkerReference*)>;
-    using EntityLayerOwnershipChangeCallback = std::function<void(const ServerEntity&, LayerId, const RuntimeWorkerReference&, const RuntimeWorkerReference&)>;
-    using WorkerLayerRequestCallback         = std::function<void(LayerId)>;
-
-    struct WorkerDensityKey
-    {
-        WorkerDensityKey() {}
-        WorkerDensityKey(const WorkerCellsInfos& _worker_cells_infos) : global_entity_count(_worker_cells_infos.entity_count), worker_id(_worker_cells_infos.worker_instance->GetId()) {}
-        bool operator() (const WorkerDensityKey& rhs) const
-        {
-            if (global_entity_count < rhs.global_entity_count) return true;
-            if (global_entity_count > rhs.global_entity_count) return false;
-            if (worker_id < rhs.worker_id) return true;
-
-            return false;
-        }
-
-        bool operator()(WorkerDensityKey const& lhs, WorkerDensityKey const& rhs) const
-        {
-            if (lhs.global_entity_count < rhs.global_entity_count) return true;
-            if (lhs.global_entity_count > rhs.global_entity_count) return false;
-            if (lhs.worker_id < rhs.worker_id) return true;
-
-            return false;
-        }
-
-        friend bool operator <(const WorkerDensityKey& lhs, const WorkerDensityKey& rhs) //friend claim has to be here
-        {
-            if (lhs.global_entity_count < rhs.global_entity_count) return true;
-            if (lhs.global_entity_count > rhs.global_entity_count) return false;
-            if (lhs.worker_id < rhs.worker_id) return true;
-
-            return false;
-        }
-
-        uint32_t global_entity_count = 0;
-        WorkerId worker_id           = std::numeric_limits<WorkerId>::max();
-    };
+    using CellOwnershipChangeCallback         = std::function<void(const std::map<EntityId, ServerEntity*>&, WorldCellCoordinates, LayerId, const RuntimeWorkerReference*, const RuntimeWorkerReference*)>;
+    using EntityLayerOwnershipChangeCallback  = std::function<void(const ServerEntity&, LayerId, const RuntimeWorkerReference&, const RuntimeWorkerReference&)>;
+    using EntityLayerOwnershipPredictCallback = std::function<void(const ServerEntity&, LayerId, const RuntimeWorkerReference&, const RuntimeWorkerReference&)>;
+    using WorkerLayerRequestCallback          = std::function<void(LayerId)>;
 
     struct WorkerInfo
     {
         WorkerCellsInfos                        worker_cells_infos;
         std::unique_ptr<RuntimeWorkerReference> worker_instance;
 
-        WorkerDensityKey GetDensityKey() const
-        {
-            return WorkerDensityKey(worker_cells_infos);
-        }
+        // How much of the worker measured load each unit of cell cost represents, calibrated whenever a new
+        // load report arrives so the load estimate reacts to migrations before the next report
+        float                                   load_per_cost       = 0.0f;
+        uint32_t                                load_report_index   = 0;
+    };
+
+    /*
+    * Indexed binary min heap of the layer workers ordered by their global entity count (ties broken by the
+    * worker id), each worker cells infos stores its own heap position so a count change only sifts that worker
+    * The dummy worker is never pushed, updating a worker that isn't on the heap does nothing
+    */
+    class WorkerDensityHeap
+    {
+    public:
+
+        void        Push(WorkerInfo& _worker_info);
+        void        Erase(WorkerInfo& _worker_info);
+        void        Update(WorkerCellsInfos& _worker_cells_infos);
+        WorkerInfo& Top() const;
+        size_t      size() const;
+
+    private:
+
+        bool IsLess(uint32_t _lhs_index, uint32_t _rhs_index) const;
+        void Swap(uint32_t _lhs_index, uint32_t _rhs_index);
+        void SiftUp(uint32_t _index);
+        void SiftDown(uint32_t _index);
+
+        std::vector<WorkerInfo*> m_workers;
     };
 
     struct LayerInfo
@@ -94,9 +85,63 @@ class RuntimeWorldController
         std::unordered_map<WorkerId, WorkerInfo>                      worker_instances;
         WorkerInfo                                                    dummy_layer_worker_instance;
         LayerId                                                       layer_id                     = std::numeric_limits<LayerId>::max();
-        std::map<WorkerDensityKey, WorkerInfo*>                       ordered_worker_density_info;
+        uint32_t                                                      grid_index                   = 0;
+        WorkerDensityHeap                                             worker_density_heap;
+
+        // Hilbert curve partitioning, each worker owns the curve range starting at its index up to the next entry index,
+        // a repartition is required whenever a worker joins or leaves the layer
+        std::vector<std::pair<uint64_t, WorkerInfo*>>                 curve_ranges;
+        bool                                                          requires_repartition         = false;
     };
 
+    /*
+    * Each distinct layer cell size has its own grid, entities are present on all of them but each grid cell only
+    * has owners for the layers using its resolution
+    * Grid 0 always uses the deployment worker length and is the one used by spatial queries
+    */
+    struct GridInfo
+    {
+        uint32_t                                                                                             cell_length    = 0;
+        uint32_t                                                                                             grids_per_line = 0;
+        uint32_t                                                                                             curve_dim_size = 1; // Power of two that covers all cells on a line
+        std::unique_ptr<EntitySparseGrid<WorldCellInfo>>                                                     grid;
+        std::unordered_set<WorldCellCoordinates, WorldCellCoordinatesHasher, WorldCellCoordinatesComparator> split_cells;
+    };
+
+public:
+
+    /*
+    * A cell holding at least a worker capacity worth of entities, or at least the low watermark worth of load, is
+    * split into SubCellDimSize x SubCellDimSize sub cells, so parts of it can be given to other workers
+    * It's merged back once both its entity count and its load fall below MergeCapacityFactor of what caused the
+    * split, never before its sub cells went through a balance
+    */
+    static const uint32_t  SubCellDimSize      = 4;
+    static constexpr float MergeCapacityFactor = 0.5f;
+
+    /*
+    * Cell cost model used by the spatial balance, each entity adds a base cost and each component update
+    * received for it adds to the cell activity, which halves every CellActivityHalfLife milliseconds
+    * A worker load is 1.0 when at its frame time/cpu/bandwidth budget or at its entity limit, the balance
+    * is triggered at the deployment high watermark and works with the low watermark as its target
+    */
+    static constexpr float    CellEntityBaseCost   = 1.0f;
+    static constexpr float    CellUpdateCost       = 0.1f;
+    static const uint32_t     CellActivityHalfLife = 2000;
+
+    /*
+    * Estimated bytes sent for each migrated entity besides its component payloads (authority messages)
+    */
+    static const uint32_t     MigrationEntityOverhead = 64;
+
+    /*
+    * Entity velocities are sampled at most once every VelocitySampleInterval milliseconds and smoothed with the
+    * previous estimate, an entity without position updates for VelocityStaleInterval milliseconds starts over
+    */
+    static const uint32_t     VelocitySampleInterval  = 100;
+    static const uint32_t     VelocityStaleInterval   = 1000;
+    static constexpr float    VelocitySmoothingFactor = 0.5f;
+
 //////////////////////////
 public: // CONSTRUCTORS //
 //////////////////////////
@@ -131,9 +176,20 @@ public: // MAIN METHODS //
     bool HandleWorkerDisconnection(WorkerId _worker_id, LayerId _layer_id);
 
     /*
-    
+    * Return the cell info at the given coordinates of the given grid
+    */
+    const WorldCellInfo& GetWorldCellInfo(WorldCellCoordinates _coordinates, uint32_t _grid_index = 0) const;
+
+    /*
+    * Return the grid index used by the given layer and the cell length (in world units) of the given grid
     */
-    const WorldCellInfo& GetWorldCellInfo(WorldCellCoordinates _coordinates) const;
+    uint32_t GetGridIndexForLayer(LayerId _layer_id) const;
+    uint32_t GetGridCellLength(uint32_t _grid_index) const;
+
+    /*
+    * Return the worker that owns the given entity on the given layer, resolved on the layer grid
+    */
+    std::optional<RuntimeWorkerReference*> GetEntityWorkerForLayer(const ServerEntity& _entity, LayerId _layer_id) const;
 
     const std::unordered_map<WorkerId, WorkerInfo>& GetWorkersInfosForLayer(LayerId _layer_id) const;
 
@@ -161,15 +217,25 @@ public: // MAIN METHODS //
     void AcknowledgeEntityPositionChange(ServerEntity& _entity, WorldPosition _new_position);
 
     /*
-    
+    * Register a component update for the given entity, increasing the activity of the cells it's in
     */
-    WorldCellCoordinates ConvertPositionIntoCellCoordinates(WorldPosition _world_position) const;
-    WorldPosition ConvertCellCoordinatesIntoPosition(WorldPosition _cell_coordinates) const;
+    void AcknowledgeEntityUpdate(const ServerEntity& _entity);
+
+    /*
+    * Conversions between world and cell coordinates of the given grid
+    */
+    WorldCellCoordinates ConvertPositionIntoCellCoordinates(WorldPosition _world_position, uint32_t _grid_index = 0) const;
+    WorldPosition ConvertCellCoordinatesIntoPosition(WorldPosition _cell_coordinates, uint32_t _grid_index = 0) const;
+
+    /*
+    * Return the position in cell space (cell coordinates plus the fraction inside the cell), without clamping
+    */
+    glm::vec2 ConvertPositionIntoCellSpace(WorldPosition _world_position, uint32_t _grid_index = 0) const;
 
     /*
     
     */
-    float ConvertWorldScalarIntoCellScalar(float _scalar) const;
+    float ConvertWorldScalarIntoCellScalar(float _scalar, uint32_t _grid_index = 0) const;
 
     /*
     * Perform a query around a position with a radius, calling the callback for each selected entity 
@@ -181,13 +247,61 @@ public: // MAIN METHODS //
     */
     void ForEachEntityOnRect(WorldRect _world_rect, std::function<void(EntityId, ServerEntity&, WorldCellCoordinates)> _callback) const;
 
+    /*
+    * Perform a query along a segment, calling the callback for each entity closer than the thickness to it, in
+    * order of their projection on the segment
+    * Only the cells crossed by the segment (plus the ones covered by its thickness) are visited, if max hits
+    * is set the traversal stops as soon as no further cell can contain a closer hit
+    */
+    void ForEachEntityOnSegment(
+        WorldPosition                                                      _segment_begin, 
+        WorldPosition                                                      _segment_end, 
+        float                                                              _thickness, 
+        uint32_t                                                           _max_hits, 
+        std::function<void(EntityId, ServerEntity&, WorldCellCoordinates)> _callback) const;
+
+    /*
+    * Call the callback for each entity inside the cells owned by the given worker (on its layer), optionally
+    * including all cells inside a margin (in cells) around each owned cell
+    * Each cell is visited only once even if it's covered by the margin of multiple owned cells
+    * Owned sub cells of split cells only contribute their own entities when no margin is used
+    */
+    void ForEachEntityOnWorkerCells(
+        const RuntimeWorkerReference&                                      _worker, 
+        uint32_t                                                           _cells_margin, 
+        std::function<void(EntityId, ServerEntity&, WorldCellCoordinates)> _callback) const;
+
+    /*
+    * Perform an aggregate query directly over the cell data, cells fully covered by the query area are
+    * accounted by their entity count without visiting each entity whenever the query type allows it
+    * Returns nothing if the query attribute can't be resolved from the component schema, attributes are read
+    * from the raw payload so serializable components are always rejected
+    */
+    std::optional<AggregateQueryResult> PerformAggregateQuery(const AggregateQuery& _query) const;
+
 private:
 
     /*
-    * Make sure there is an allocated cell for the given coordinates
+    * Make sure there is an allocated cell for the given coordinates on the given grid
     * Also ensure there is a worker for each layer (whenever applicable) on the given cell
     */
-    void SetupCell(WorldCellCoordinates _cell_coordinates);
+    void SetupCell(WorldCellCoordinates _cell_coordinates, uint32_t _grid_index);
+
+    /*
+    * Update the entity cell on a single grid, changing its owners on the grid layers whenever required
+    */
+    void UpdateEntityGridCell(ServerEntity& _entity, WorldPosition _new_position, uint32_t _grid_index);
+
+    /*
+    * Update the entity velocity estimate with a new position sample
+    */
+    void UpdateEntityMotion(ServerEntity& _entity, WorldPosition _new_position);
+
+    /*
+    * Extrapolate the entity position by the deployment prediction horizon (at most one cell away) and, if it
+    * falls on a cell owned by another worker, notify the predicted owner change on each layer of the grid
+    */
+    void PredictEntityGridCellCrossing(const ServerEntity& _entity, WorldPosition _position, uint32_t _grid_index);
 
     /*
     
@@ -195,17 +309,66 @@ private:
     void SetupWorkCellEntityInsertion(WorldCellInfo& _cell_info, std::optional<LayerId> _layer = std::nullopt);
     void SetupWorkCellEntityRemoval(WorldCellInfo& _cell_info, std::optional<LayerId> _layer = std::nullopt);
 
+    /*
+    * Return the cell (or sub cell) that defines the owners of an entity located at the given position inside the cell
+    */
+    WorldCellInfo& ResolveOwnershipCell(WorldCellInfo& _cell_info, WorldPosition _world_position);
+
+    /*
+    * Return the index of the sub cell that contains the given position, positions outside the cell are clamped
+    */
+    uint32_t GetSubCellIndex(WorldCellCoordinates _cell_coordinates, WorldPosition _world_position, uint32_t _grid_index) const;
+
+    /*
+    * Move an entity between two cells (or sub cells) of the same or different coordinates, updating the entity
+    * maps and triggering layer ownership changes whenever the owners differ
+    */
+    void MoveEntityBetweenOwnershipCells(ServerEntity& _entity, WorldCellInfo& _current_cell_info, WorldCellInfo& _new_cell_info);
+
+    /*
+    * Remove the given cell from the grid and from its owners if it has no entities, so only the populated area
+    * keeps cells allocated, split cells and sub cells are never released
+    * The cell reference is invalid after this call if it was released
+    */
+    void ReleaseCellIfEmpty(WorldCellInfo& _cell_info);
+
+    /*
+    * Split a cell into sub cells, initially owned by the same workers as the cell itself
+    */
+    void SplitCell(WorldCellInfo& _cell_info);
+
+    /*
+    * Merge all sub cells back into their cell, on each layer the sub cells are first migrated to the worker that
+    * owns most of their entities
+    */
+    void MergeCell(WorldCellInfo& _cell_info);
+
+    /*
+    * Merge split cells whose entity count and load fell below the merge thresholds on every spatial layer
+    * A merge is deferred while any of its sub cells is on its migration cooldown or the cell doesn't fit the
+    * remaining migration budget
+    */
+    void ApplyCellMerges();
+
+    /*
+    * Return the worker info that holds the given worker cells infos, that can be the layer dummy worker
+    */
+    WorkerInfo& GetWorkerInfoForCellsInfos(LayerInfo& _layer_info, WorkerCellsInfos& _worker_cells_infos);
+
+    /*
+    * Register or unregister a cell (or sub cell) as owned by the given worker cells infos
+    */
+    static void SetCellOwnership(WorkerCellsInfos& _worker_cells_infos, WorldCellInfo& _cell_info, bool _is_owned);
+
     /*
     
     */
     void MigrateEntitiesFromCellToNewWorker(
-        LayerInfo&                      _layer_info, 
-        WorldCellInfo&                  _cell_info,
-        WorkerInfo&                     _current_worker_info,
-        WorkerInfo&                     _target_worker_info, 
-        std::optional<WorkerDensityKey> _current_worker_density_key, 
-        std::optional<WorkerDensityKey> _target_worker_density_key, 
-        bool                            _erase_from_current_worker);
+        LayerInfo&     _layer_info, 
+        WorldCellInfo& _cell_info,
+        WorkerInfo&    _current_worker_info,
+        WorkerInfo&    _target_worker_info, 
+        bool           _erase_from_current_worker);
 
 ///////////////////////
 public: // CALLBACKS //
@@ -216,16 +379,74 @@ public: // CALLBACKS //
     */
     void RegisterCellOwnershipChangeCallback(CellOwnershipChangeCallback _callback);
     void RegisterEntityLayerOwnershipChangeCallback(EntityLayerOwnershipChangeCallback _callback);
+    void RegisterEntityLayerOwnershipPredictCallback(EntityLayerOwnershipPredictCallback _callback);
     void RegisterWorkerLayerRequestCallback(WorkerLayerRequestCallback _callback);
 
 private:
 
 
     /*
-    
+    * Balance each spatial layer using the cells cost, the most loaded worker (ties broken by the worker
+    * id) gives away its most expensive cells to the least loaded workers that can take them
     */
     void ApplySpatialBalance();
 
+    /*
+    * Partition the layer cells into contiguous Hilbert curve ranges with about the same cost each, workers keep
+    * their order along the curve so only cells around the range boundaries migrate
+    * Only performed when a worker is overloaded or when workers joined/left the layer
+    */
+    void ApplyCurvePartitioning(LayerInfo& _layer_info);
+
+    /*
+    * Return the worker whose curve range contains the given cell, if the layer has curve ranges
+    */
+    WorkerInfo* FindCurveRangeOwner(const LayerInfo& _layer_info, WorldCellCoordinates _cell_coordinates) const;
+
+    /*
+    * Return the index of the given cell along the Hilbert curve that covers a grid with the given (power of two)
+    * dimension
+    */
+    static uint64_t HilbertEncode(uint32_t _x, uint32_t _y, uint32_t _dim_size);
+
+    /*
+    * Return the sum of the cost of all cells (and sub cells) owned by the given worker
+    */
+    float GetWorkerCost(EntitySparseGrid<WorldCellInfo>& _world_grid, const WorkerCellsInfos& _worker_cells_infos) const;
+
+    /*
+    * Return if the balance can migrate the given cell now, the cell must be out of its migration cooldown
+    * and fit the remaining migration budget for this update (a cell bigger than the whole budget can still
+    * migrate alone on an update with the budget untouched)
+    */
+    bool CanBalanceMigrateCell(const LayerInfo& _layer_info, const WorldCellInfo& _cell_info) const;
+
+    /*
+    * Return the estimated number of bytes sent when migrating the given cell on the given layer
+    */
+    uint64_t GetCellMigrationSize(const LayerInfo& _layer_info, const WorldCellInfo& _cell_info) const;
+
+    /*
+    * Apply the activity decay pending since the cell activity was last touched
+    */
+    void DecayCellActivity(WorldCellInfo& _cell_info) const;
+
+    /*
+    * Return the cost of the given cell (or sub cell), applying its pending activity decay
+    */
+    float GetCellCost(WorldCellInfo& _cell_info) const;
+
+    /*
+    * Return the load of the given worker, calibrating its load per cost when it sent a new load report,
+    * the entity limit is also accounted so entity count is still a hard limit
+    */
+    float GetWorkerLoad(const LayerInfo& _layer_info, WorkerInfo& _worker_info, float _worker_cost) const;
+
+    /*
+    * Return the load measured by the worker itself on its last report, 0 if it never sent one
+    */
+    float GetWorkerMeasuredLoad(const RuntimeWorkerReference& _worker_instance) const;
+
 private:
 
     const DeploymentConfig& m_deployment_config;
@@ -233,11 +454,20 @@ private:
 
     std::array<std::optional<LayerInfo>, MaximumLayers> m_layer_infos;
 
-    std::unique_ptr<EntitySparseGrid<WorldCellInfo>> m_world_grid;
+    std::vector<GridInfo> m_grids;
+
+    std::chrono::time_point<std::chrono::steady_clock> m_initial_timestamp = std::chrono::steady_clock::now();
+    uint64_t                                           m_current_time_ms   = 0;
+    uint64_t                                           m_update_index      = 0;
+
+    // Migration budget used on the current update
+    uint32_t m_migrated_entities_on_update = 0;
+    uint64_t m_migrated_bytes_on_update    = 0;
 
-    CellOwnershipChangeCallback        m_cell_ownership_change_callback;
-    EntityLayerOwnershipChangeCallback m_entity_layer_ownership_change_callback;
-    WorkerLayerRequestCallback         m_worker_layer_request_callback;
+    CellOwnershipChangeCallback         m_cell_ownership_change_callback;
+    EntityLayerOwnershipChangeCallback  m_entity_layer_ownership_change_callback;
+    EntityLayerOwnershipPredictCallback m_entity_layer_ownership_predict_callback;
+    WorkerLayerRequestCallback          m_worker_layer_request_callback;
 };
 
 // Jani
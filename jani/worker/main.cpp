@@ -119,6 +119,8 @@ int main(int _argc, char* _argv[])
 
         std::this_thread::sleep_for(std::chrono::milliseconds(wait_time_ms));
 
+        worker->BeginFrame();
+
         if (is_brain)
         {
             if (total_npcs_alive < maximum_npcs && rand() % 2 == 1)